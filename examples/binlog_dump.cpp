@@ -0,0 +1,35 @@
+#include <iostream>
+
+#include <core/io/file.hpp>
+#include <core/io/mmap.hpp>
+#include <util/arg_parse.hpp>
+#include <util/log/binlog.hpp>
+#include <util/time.hpp>
+
+using namespace core;
+
+tbc_cmd(main) {
+    tbc_arg(file, std::string, "binary log written by util::binlog"_ctstr);
+};
+
+void tbc_main(main_cmd<> args) {
+    static constexpr std::string_view level_str[] = {
+        ": [debug] ",
+        ": ",
+        ": [info] ",
+        ": [warn] ",
+        ": [error] ",
+    };
+
+    io::mmap            file{io::file::open(*args.file, sys::openflag::read_only), io::map_flags::priv, io::map_prots::read};
+    util::binlog_reader reader{std::span{file.data<char>(), file.size()}};
+
+    std::string line;
+    reader.foreach([&](const util::binlog_record& record) {
+        line = util::format_datetime("[hh:mm:ss.xxx]", record.time);
+        line += level_str[size_t(record.level)];
+        line += record.msg;
+        line += '\n';
+        std::cout << line;
+    });
+}
@@ -0,0 +1,70 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <core/io/file.hpp>
+#include <core/io/lz4.hpp>
+#include <core/io/out.hpp>
+#include <sys/event.hpp>
+#include <sys/statx.hpp>
+#include <util/arg_parse.hpp>
+
+using namespace core;
+
+tbc_cmd(main) {
+    tbc_arg(events, opt<u64>, "number of generated mouse events"_ctstr) = 10'000'000;
+    tbc_arg(file, opt<std::string>, "output file, memfd if not set"_ctstr);
+};
+
+/* Mouse moves with a sync event after every x/y pair, as recorded by mouse_streamer */
+std::vector<sys::event> generate_events(size_t count) {
+    std::mt19937            rng{42};
+    std::vector<sys::event> events(count);
+    sys::event_time         time{.sec = 1700000000, .usec = 0};
+
+    for (size_t i = 0; i < count; ++i) {
+        auto& e = events[i];
+        if (i % 3 == 2) {
+            time.usec = (time.usec + 1000 + rng() % 64) % 1000000;
+            e.type    = sys::event_type::synchronize;
+            e.value   = 0;
+        }
+        else {
+            e.type     = sys::event_type::relative;
+            e.code.rel = i % 3 ? sys::event_relative_code::y : sys::event_relative_code::x;
+            e.value    = i32(rng() % 7) - 3;
+        }
+        e.time = time;
+    }
+    return events;
+}
+
+io::file open_output(const main_cmd<>& args) {
+    if (args.file.get())
+        return io::file::open(*args.file.get(), sys::openflag::write_only | sys::openflag::trunc | sys::openflag::create);
+    return io::file::memfd("lz4_bench");
+}
+
+void report(std::string_view name, auto&& write, size_t raw_size, const main_cmd<>& args) {
+    auto f     = open_output(args);
+    auto start = std::chrono::steady_clock::now();
+    write(f.fd());
+    auto end   = std::chrono::steady_clock::now();
+    auto size  = sys::statx(f.fd(), sys::statx_mask::size).get().size;
+    auto secs  = std::chrono::duration<double>(end - start).count();
+
+    std::cout << name << ": " << size << " bytes, ratio " << double(raw_size) / double(size) << ", " << double(raw_size) / secs / 1e6
+              << " MB/s" << std::endl;
+}
+
+void tbc_main(main_cmd<> args) {
+    auto events   = generate_events(*args.events.get());
+    auto raw_size = events.size() * sizeof(sys::event);
+    auto span     = std::span<const sys::event>{events};
+
+    report("raw", [&](sys::fd_t fd) { io::out<sys::fd_t, 65536>{fd}.write(span); }, raw_size, args);
+    report("lz4", [&](sys::fd_t fd) { io::out{io::lz4_frame{fd}, size_c<65536>}.write(span); }, raw_size, args);
+}
+
+#include <util/tbc_main.hpp>
@@ -4,6 +4,7 @@
 #include <core/poller.hpp>
 #include <net/udp_socket.hpp>
 #include <sys/event.hpp>
+#include <inp/event_codec.hpp>
 #include <inp/mouse.hpp>
 #include <core/io/mmap.hpp>
 #include <thread>
@@ -141,20 +142,20 @@ public:
         flush();
     }
 
+    /* Plays the events with their recorded timing, the timing continues from the previous call */
     void play(std::span<const sys::event> events) {
         if (events.empty())
             return;
 
-        auto start_time = events[0].time.value();
-        auto start = std::chrono::high_resolution_clock::now();
-        auto next = start;
+        if (!start_time) {
+            start_time = events[0].time.value();
+            start      = std::chrono::high_resolution_clock::now();
+        }
 
-        auto dist = std::chrono::duration_cast<std::chrono::microseconds>(next - start);
         for (auto&& event : events) {
-            while (dist < event.time.value() - start_time) {
-                next = std::chrono::high_resolution_clock::now();
-                dist = std::chrono::duration_cast<std::chrono::microseconds>(next - start);
-            }
+            auto dist = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start);
+            while (dist < event.time.value() - *start_time)
+                dist = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start);
             immediate(std::span{&event, 1});
             //util::glog().warn("events: {}\n", std::span{&event, 1});
         }
@@ -213,8 +214,10 @@ private:
     }
 
 private:
-    Display*   dpy;
-    inp::mouse mouse;
+    Display*                                       dpy;
+    inp::mouse                                     mouse;
+    opt<std::chrono::microseconds>                 start_time;
+    std::chrono::high_resolution_clock::time_point start;
 };
 
 
@@ -222,24 +225,53 @@ tbc_cmd(main) {
     tbc_arg(port, opt<net::port_t>, "listen port"_ctstr) = 6997;
     tbc_arg(from, opt<std::string>, "files with recorded events"_ctstr);
     tbc_arg(display, std::string, "x11 display to provide play events"_ctstr);
+    tbc_arg(packed, bool, "events are received and recorded in the compact format"_ctstr);
 };
 
+/* A compact event takes 3 bytes at least, so a datagram of the streamer has less than 512 */
+constexpr size_t max_decoded_events = 512;
+
 void tbc_main(main_cmd<> args) {
     x11_event_player player{*args.display};
 
     if (args.from.get()) {
         io::mmap file{io::file::open(*args.from.get(), sys::openflag::read_only), io::map_flags::priv, io::map_prots::read};
-        std::span events{reinterpret_cast<const sys::event*>(file.data()), file.size() / sizeof(sys::event)};
-        player.play(events);
+        if (!*args.packed) {
+            std::span events{reinterpret_cast<const sys::event*>(file.data()), file.size() / sizeof(sys::event)};
+            player.play(events);
+            return;
+        }
+
+        std::span          data{reinterpret_cast<const u8*>(file.data()), file.size()};
+        inp::event_decoder decoder;
+        sys::event         buff[max_decoded_events];
+        while (auto frame = inp::event_codec::next_frame(data)) {
+            if (auto batch = decoder.decode(*frame, buff))
+                player.play(batch->events);
+        }
     }
     else {
-        net::udp_socket sock{net::full_addr_v4{net::ip_addr_v4::any(), *args.port.get()}, true};
-        sys::event      buff[32];
+        net::udp_socket    sock{net::full_addr_v4{net::ip_addr_v4::any(), *args.port.get()}, true};
+        sys::event         buff[16][64]; /* Fits a batch of the streamer */
+        net::udp_batch<16> batch;
+        inp::event_decoder decoder;
+        sys::event         decoded[max_decoded_events];
+        for (auto& b : buff)
+            batch.push(b, sizeof(b));
 
         while (true) {
-            auto result = sock.recv(buff, sizeof(buff));
-            auto count  = size_t(result.size) / sizeof(sys::event);
-            player.immediate(std::span{buff, count});
+            auto received = sock.recv_batch(batch);
+            for (int i = 0; i < received; ++i) {
+                if (!*args.packed) {
+                    auto count = batch.received(size_t(i)) / sizeof(sys::event);
+                    player.immediate(std::span{buff[i], count});
+                }
+                else {
+                    auto data = batch.data(size_t(i));
+                    if (auto res = decoder.decode(std::span{reinterpret_cast<const u8*>(data.data()), data.size()}, decoded))
+                        player.immediate(res->events);
+                }
+            }
         }
     }
 }
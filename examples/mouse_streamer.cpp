@@ -2,6 +2,8 @@
 #include <core/io/file.hpp>
 #include <core/io/out.hpp>
 #include <core/poller.hpp>
+#include <inp/event_batcher.hpp>
+#include <inp/event_codec.hpp>
 #include <net/full_addr.hpp>
 #include <net/udp_socket.hpp>
 #include <sys/event.hpp>
@@ -21,6 +23,7 @@ tbc_cmd(main) {
     tbc_arg(mouse, std::string, "path to mouse input device"_ctstr);
     tbc_arg(kbd, opt<std::string>, "path to keyboard input device"_ctstr);
     tbc_arg(dst, std::string, "destination address or file"_ctstr);
+    tbc_arg(packed, bool, "send and write events in the compact format"_ctstr);
 };
 
 auto handle_keyboard(sys::fd_t fd, auto&& events_handler) {
@@ -53,22 +56,22 @@ auto handle_mouse(sys::fd_t fd, auto&& events_handler) {
         fd,
         sys::poll_event::in,
         [fd, &events_handler](auto&&) {
-            array<sys::event, 8>                  buff;
+            array<sys::event, 64>                 buff;
             fixed_vector<sys::event, buff.size()> filtered;
 
             if (auto count = sys::read(fd, buff)) {
                 for (auto&& event : std::span{buff}.subspan(0, *count)) {
-                    event.dispatch([&](keycodes, i32) {
+                    /* SYN_REPORT is kept for the batcher to merge reports */
+                    if (event.type == sys::event_type::synchronize)
                         filtered.emplace_back(event);
-                    });
+                    else
+                        event.dispatch([&](keycodes, i32) {
+                            filtered.emplace_back(event);
+                        });
                 }
                 if (!filtered.empty())
                     events_handler(filtered);
             }
-
-
-            if (auto count = sys::read(fd, buff))
-                events_handler(std::span{buff}.subspan(0, *count));
         },
     };
 }
@@ -76,10 +79,18 @@ auto handle_mouse(sys::fd_t fd, auto&& events_handler) {
 class event_streamer {
 public:
     event_streamer(const main_cmd<>& args):
-        src{net::ip_addr_v4::any(), *args.src_port.get()}, dst(udp_addr_helper(*args.dst)), sock{src, false} {}
-
-    void operator()(std::span<const sys::event> events) const {
-        sock.send(dst, events);
+        src{net::ip_addr_v4::any(), *args.src_port.get()}, dst(udp_addr_helper(*args.dst)), sock{src, false}, packed(*args.packed) {}
+
+    /* Only the compact format carries the sequence number */
+    void operator()(std::span<const sys::event> events, u32 seq) {
+        if (!packed) {
+            sock.send(dst, events);
+            return;
+        }
+
+        buff.resize(inp::event_codec::encoded_bound(events.size()));
+        auto size = inp::event_codec::encode(events, seq, buff.data());
+        sock.send(dst, buff.data(), size);
     }
 
 private:
@@ -93,18 +104,32 @@ private:
     net::full_addr_v4 src;
     net::full_addr_v4 dst;
     net::udp_socket   sock;
+    bool              packed;
+    std::vector<u8>   buff;
 };
 
 class event_writter {
 public:
-    event_writter(const std::string& out_file): o{io::file::open(out_file, io::openflags::write_only | io::openflags::trunc | io::openflags::create, io::file_perms::o644)} {}
+    event_writter(const std::string& out_file, bool ipacked):
+        o{io::file::open(out_file, io::openflags::write_only | io::openflags::trunc | io::openflags::create, io::file_perms::o644)},
+        packed(ipacked) {}
 
     void operator()(std::span<const sys::event> events) {
-        o.write(events);
+        if (!packed) {
+            o.write(events);
+            return;
+        }
+
+        buff.resize(inp::event_codec::framed_bound(events.size()));
+        auto size = inp::event_codec::encode_framed(events, seq++, buff.data());
+        o.write(std::span{buff.data(), size});
     }
 
 private:
     io::out<io::file, 0> o;
+    bool                 packed;
+    u32                  seq = 0;
+    std::vector<u8>      buff;
 };
 
 void run(const main_cmd<>& args, auto&& streamer) {
@@ -118,13 +143,34 @@ void run(const main_cmd<>& args, auto&& streamer) {
     }
 }
 
+/* Sends a datagram per batch instead of per wakeup */
+void run_batched(const main_cmd<>& args, event_streamer streamer) {
+    inp::event_batcher batcher{mov(streamer)};
+    auto               handler = [&](std::span<const sys::event> events) {
+        batcher.push(events);
+    };
+
+    auto mouse = io::file::open(*args.mouse, sys::openflags::read_only | sys::openflags::nonblock);
+    auto loop  = [&](auto&& p) {
+        while (p.poll_once(batcher.timeout()))
+            batcher.expire();
+    };
+
+    if (!args.kbd.get())
+        loop(poller{handle_mouse(mouse, handler)});
+    else {
+        auto kbd = io::file::open(*args.kbd.get(), sys::openflags::read_only | sys::openflags::nonblock);
+        loop(poller{handle_mouse(mouse, handler), handle_keyboard(kbd, handler)});
+    }
+}
+
 void tbc_main(main_cmd<> args) {
     auto dest = *args.dst;
 
     if (dest.starts_with("file://"))
-        run(args, event_writter(dest.substr(7)));
+        run(args, event_writter(dest.substr(7), *args.packed));
     else
-        run(args, event_streamer(args));
+        run_batched(args, event_streamer(args));
 }
 
 #include <util/tbc_main.hpp>
@@ -0,0 +1,129 @@
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <net/udp_socket.hpp>
+#include <sys/event.hpp>
+#include <util/arg_parse.hpp>
+
+using namespace core;
+
+tbc_cmd(main) {
+    tbc_arg(datagrams, opt<u64>, "number of sent datagrams"_ctstr) = 1'000'000;
+    tbc_arg(events, opt<u64>, "events per datagram"_ctstr)          = 32;
+    tbc_arg(port, opt<net::port_t>, "loopback port"_ctstr)         = 6998;
+};
+
+enum class mode { single, batch, gso };
+
+constexpr size_t batch_size    = 32;
+constexpr size_t gro_buff_size = 65536;
+
+struct stats {
+    size_t                                datagrams = 0;
+    size_t                                syscalls  = 0;
+    std::chrono::steady_clock::time_point last;
+};
+
+/* Receives until all datagrams arrived or nothing comes for 200 ms, lost ones are not retransmitted */
+stats receive(const net::udp_socket& sock, mode m, size_t datagram_size, size_t count) {
+    stats                          st;
+    std::vector<std::vector<char>> buffs(batch_size, std::vector<char>(m == mode::gso ? gro_buff_size : datagram_size));
+    net::udp_batch<batch_size>     batch;
+    for (auto& b : buffs)
+        batch.push(b.data(), b.size());
+
+    while (st.datagrams < count) {
+        ++st.syscalls;
+        if (m == mode::single) {
+            if (sock.recv(buffs[0].data(), datagram_size).size <= 0)
+                break;
+            ++st.datagrams;
+        }
+        else {
+            auto n = sock.recv_batch(batch);
+            if (n <= 0)
+                break;
+            for (size_t i = 0; i < size_t(n); ++i)
+                st.datagrams += batch.received(i) / datagram_size;
+        }
+        st.last = std::chrono::steady_clock::now();
+    }
+    return st;
+}
+
+stats send(const net::udp_socket& sock, const net::full_addr_any& dst, mode m, std::span<const sys::event> datagram, size_t segments,
+           size_t count) {
+    stats                      st;
+    net::udp_batch<batch_size> batch;
+    auto                       per_msg = m == mode::gso ? segments : 1;
+    std::vector<sys::event>    data(datagram.size() * per_msg);
+
+    while (st.datagrams < count) {
+        ++st.syscalls;
+        if (m == mode::single) {
+            if (sock.send(dst, datagram) <= 0)
+                break;
+            ++st.datagrams;
+            continue;
+        }
+
+        batch.clear();
+        for (auto sent = st.datagrams; !batch.full() && sent < count; sent += per_msg) {
+            auto n = sent + per_msg <= count ? per_msg : count - sent;
+            batch.push(dst, std::span{data}.subspan(0, datagram.size() * n));
+        }
+
+        auto n = sock.send_batch(batch);
+        if (n <= 0)
+            break;
+        for (size_t i = 0; i < size_t(n); ++i)
+            st.datagrams += batch.headers()[i].msg_hdr.msg_iov->iov_len / datagram.size_bytes();
+    }
+    return st;
+}
+
+void run(std::string_view name, mode m, const main_cmd<>& args) {
+    auto count         = *args.datagrams.get();
+    auto datagram      = std::vector<sys::event>(*args.events.get());
+    auto datagram_size = datagram.size() * sizeof(sys::event);
+    auto addr          = net::full_addr_v4{net::ip_addr_v4{"127.0.0.1"}, *args.port.get()};
+
+    /* The kernel accepts up to 64 segments and 64 KiB per GSO send */
+    auto segments = std::min<size_t>(64, 65000 / datagram_size);
+
+    net::udp_socket receiver{addr, true};
+    net::udp_socket sender{net::full_addr_v4{net::ip_addr_v4{"127.0.0.1"}, 0}, true};
+    receiver.set_option(SOL_SOCKET, SO_RCVBUF, 32 << 20);
+
+    timeval timeout{.tv_sec = 0, .tv_usec = 200'000};
+    ::setsockopt(receiver.native(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    if (m == mode::gso) {
+        sender.set_gso_segment(uint16_t(datagram_size));
+        receiver.set_gro(true);
+    }
+
+    stats recv_st;
+    stats send_st;
+    auto  start = std::chrono::steady_clock::now();
+    {
+        std::jthread thread{[&] {
+            recv_st = receive(receiver, m, datagram_size, count);
+        }};
+        send_st = send(sender, addr, m, datagram, segments, count);
+    }
+    auto secs = std::chrono::duration<double>(recv_st.last - start).count();
+
+    std::cout << name << ": sent " << send_st.datagrams << " in " << send_st.syscalls << " syscalls, received " << recv_st.datagrams
+              << " in " << recv_st.syscalls << " syscalls, " << double(recv_st.datagrams) / secs / 1e3 << "k datagrams/s" << std::endl;
+}
+
+void tbc_main(main_cmd<> args) {
+    run("sendto/recvfrom", mode::single, args);
+    run("sendmmsg/recvmmsg", mode::batch, args);
+    run("gso/gro", mode::gso, args);
+}
+
+#include <util/tbc_main.hpp>
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+#include <core/basic_types.hpp>
+
+#define fwd(...) static_cast<decltype(__VA_ARGS__)>(__VA_ARGS__)
+
+namespace core {
+/* Allocation counters for diagnostics */
+struct alloc_stats {
+    size_t allocations     = 0; /* Number of allocate() calls */
+    size_t deallocations   = 0; /* Number of deallocate() calls */
+    size_t bytes_requested = 0; /* Sum of requested sizes */
+    size_t bytes_reserved  = 0; /* Memory currently obtained from the upstream allocator */
+    size_t chunks          = 0; /* Chunks currently obtained from the upstream allocator */
+};
+
+/* Monotonic bump allocator
+ * Memory is taken from chained chunks and released only by reset() or destruction.
+ * Requests larger than the chunk size get a dedicated chunk.
+ * Not thread-safe.
+ */
+class arena {
+public:
+    static inline constexpr size_t default_chunk_size = 16384;
+
+    arena(size_t chunk_size = default_chunk_size): _chunk_size(chunk_size) {}
+
+    ~arena() {
+        release();
+    }
+
+    arena(const arena&)            = delete;
+    arena& operator=(const arena&) = delete;
+
+    arena(arena&& a) noexcept: _head(a._head), _cur(a._cur), _end(a._end), _chunk_size(a._chunk_size), _stats(a._stats) {
+        a._head  = nullptr;
+        a._cur   = nullptr;
+        a._end   = nullptr;
+        a._stats = {};
+    }
+
+    arena& operator=(arena&& a) noexcept {
+        if (this == &a)
+            return *this;
+
+        release();
+        _head       = a._head;
+        _cur        = a._cur;
+        _end        = a._end;
+        _chunk_size = a._chunk_size;
+        _stats      = a._stats;
+        a._head     = nullptr;
+        a._cur      = nullptr;
+        a._end      = nullptr;
+        a._stats    = {};
+        return *this;
+    }
+
+    [[nodiscard]]
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        auto p = align_up(_cur, align);
+        if (!_cur || p + size > _end) {
+            add_chunk(size + align);
+            p = align_up(_cur, align);
+        }
+
+        _cur = p + size;
+        ++_stats.allocations;
+        _stats.bytes_requested += size;
+        return p;
+    }
+
+    /* Memory is reclaimed only if p is the last allocation */
+    void deallocate(void* p, size_t size, [[maybe_unused]] size_t align = alignof(std::max_align_t)) noexcept {
+        ++_stats.deallocations;
+        if (static_cast<char*>(p) + size == _cur)
+            _cur = static_cast<char*>(p);
+    }
+
+    template <typename T>
+    [[nodiscard]]
+    T* allocate_n(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    /* Destructor of created object is never called by the arena */
+    template <typename T>
+    T* create(auto&&... args) {
+        return ::new (allocate(sizeof(T), alignof(T))) T(fwd(args)...);
+    }
+
+    /* Rewinds the arena keeping only the most recent chunk */
+    void reset() noexcept {
+        if (!_head)
+            return;
+
+        free_chunks(_head->next);
+        _head->next            = nullptr;
+        _cur                   = _head->begin();
+        _stats.allocations     = 0;
+        _stats.deallocations   = 0;
+        _stats.bytes_requested = 0;
+        _stats.bytes_reserved  = _head->size;
+        _stats.chunks          = 1;
+    }
+
+    /* Returns all memory to the upstream allocator */
+    void release() noexcept {
+        free_chunks(_head);
+        _head  = nullptr;
+        _cur   = nullptr;
+        _end   = nullptr;
+        _stats = {};
+    }
+
+    [[nodiscard]]
+    const alloc_stats& stats() const noexcept {
+        return _stats;
+    }
+
+    [[nodiscard]]
+    size_t chunk_size() const noexcept {
+        return _chunk_size;
+    }
+
+    /* Bytes left in the current chunk */
+    [[nodiscard]]
+    size_t available() const noexcept {
+        return size_t(_end - _cur);
+    }
+
+private:
+    struct chunk {
+        chunk* next;
+        size_t size;
+
+        char* begin() noexcept {
+            return reinterpret_cast<char*>(this + 1);
+        }
+    };
+
+    static char* align_up(char* p, size_t align) noexcept {
+        return reinterpret_cast<char*>((reinterpret_cast<uptr>(p) + (align - 1)) & ~(uptr(align) - 1));
+    }
+
+    void add_chunk(size_t min_size) {
+        auto size = sizeof(chunk) + (min_size > _chunk_size ? min_size : _chunk_size);
+        auto c    = static_cast<chunk*>(::operator new(size));
+        c->next   = _head;
+        c->size   = size;
+        _head     = c;
+        _cur      = c->begin();
+        _end      = reinterpret_cast<char*>(c) + size;
+
+        _stats.bytes_reserved += size;
+        ++_stats.chunks;
+    }
+
+    static void free_chunks(chunk* c) noexcept {
+        while (c) {
+            auto next = c->next;
+            ::operator delete(c, c->size);
+            c = next;
+        }
+    }
+
+    chunk*      _head = nullptr;
+    char*       _cur  = nullptr;
+    char*       _end  = nullptr;
+    size_t      _chunk_size;
+    alloc_stats _stats;
+};
+} // namespace core
+
+#undef fwd
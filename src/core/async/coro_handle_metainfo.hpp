@@ -17,11 +17,12 @@ enum class async_task_type : u8 {
     inotify_watch_wait,
     statx,
     spawn_child,
+    splice,
 };
 
 inline constexpr std::string_view to_string(async_task_type value) {
     constexpr auto map = [] {
-        core::static_int_map<u8, std::string_view, 12> m;
+        core::static_int_map<u8, std::string_view, 13> m;
         m.emplace(u8(async_task_type::unknown), "");
         m.emplace(u8(async_task_type::read), "read");
         m.emplace(u8(async_task_type::write), "write");
@@ -34,6 +35,7 @@ inline constexpr std::string_view to_string(async_task_type value) {
         m.emplace(u8(async_task_type::inotify_watch_wait), "inotify_watch::wait");
         m.emplace(u8(async_task_type::statx), "statx");
         m.emplace(u8(async_task_type::spawn_child), "spawn_child");
+        m.emplace(u8(async_task_type::splice), "splice");
         return m;
     }();
     return map.at(u8(value));
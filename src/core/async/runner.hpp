@@ -117,8 +117,8 @@ namespace details {
 
         while (auto siginfo = co_await async::read<sys::siginfo_t>(sigfd)) {
             if (siginfo->signo == SIGINT || siginfo->signo == SIGTERM) {
-                for (auto sigpipe : io::uring::current_ctx->child_signalfd_pipes()) {
-                    sys::write(sigpipe.out, *siginfo);
+                for (auto& child : io::uring::current_ctx->child_signalfd_pipes()) {
+                    sys::write(child.pipe.out, *siginfo);
                 }
 
                 io::uring::current_ctx->send_kill_event(siginfo->signo);
@@ -142,8 +142,8 @@ namespace details {
             // XXX: siginfo does not contain full info, only signo
             sys::siginfo_t siginfo{};
             siginfo.signo = int(signo.get());
-            for (auto sigpipe : io::uring::current_ctx->child_signalfd_pipes()) {
-                sys::write(sigpipe.out, siginfo);
+            for (auto& child : io::uring::current_ctx->child_signalfd_pipes()) {
+                sys::write(child.pipe.out, siginfo);
             }
 
             io::uring::current_ctx->send_kill_event(int(*signo));
@@ -238,8 +238,13 @@ auto async_run_io_ctx(auto&& start_coro) -> task<typename decay<decltype(start_c
 
     auto sigpipe = io::file::pipe();
 
+    io::uring::ctx::child_signalfd_pipe child_pipe{sigpipe};
+    io::uring::ctx::thread_task         thread_task;
+
     co_await make_awaitable<long>(
-        [&res, coro = fwd(start_coro), &sigpipe]<typename Promise>(io::uring::uring_awaitable& awaitable, std::coroutine_handle<Promise>& caller) mutable {
+        [&res, coro = fwd(start_coro), &sigpipe, &child_pipe, &thread_task]<typename Promise>(
+            io::uring::uring_awaitable& awaitable, std::coroutine_handle<Promise>& caller
+        ) mutable {
             if (io::uring::current_ctx->is_tasks_blocked()) {
                 throw errc_exception{errc::ecanceled};
             }
@@ -247,8 +252,8 @@ auto async_run_io_ctx(auto&& start_coro) -> task<typename decay<decltype(start_c
             caller.promise()._cancelation_point.set((u64)&awaitable, awaitable_type::uring_threaded);
             caller.promise().set_metainfo({awaitable_type::uring_threaded, async_task_type::spawn_child});
 
-            io::uring::current_ctx->add_child_signalfd_pipe(sigpipe);
-            io::uring::current_ctx->schedule_thread_task(awaitable, [&res, coro = mov(coro), sigfd = &sigpipe.in](sys::fd_t efd) mutable {
+            io::uring::current_ctx->add_child_signalfd_pipe(child_pipe);
+            io::uring::current_ctx->schedule_thread_task(thread_task, awaitable, [&res, coro = mov(coro), sigfd = &sigpipe.in](sys::fd_t efd) mutable {
                 res = std::async(std::launch::async, [coro = mov(coro), efd, sigfd] mutable {
                     finalizer f{[efd] { sys::write(efd, u64(1)); }};
                     current_signalfd = sigfd;
@@ -257,7 +262,7 @@ auto async_run_io_ctx(auto&& start_coro) -> task<typename decay<decltype(start_c
             });
         }
     );
-    io::uring::current_ctx->remove_child_signalfd_pipe(sigpipe);
+    io::uring::current_ctx->remove_child_signalfd_pipe(child_pipe);
 
     co_return res.get();
 }
@@ -11,16 +11,18 @@
 #include <core/fixed_vector.hpp>
 #include <core/ranges/range.hpp>
 #include <core/ring_buffer.hpp>
+#include <core/small_string.hpp>
 
 #define fwd(...) static_cast<decltype(__VA_ARGS__)>(__VA_ARGS__)
 
 namespace core::async {
 static inline constexpr size_t inotify_event_buff_size     = (sizeof(sys::inotify_event) + constants::name_max) * 2;
 static inline constexpr size_t inotify_max_events_per_read = inotify_event_buff_size / sizeof(sys::inotify_event);
+static inline constexpr size_t inotify_inline_name_size    = 32;
 
 struct wd_event {
-    sys::inotify_watch_flags flags;
-    std::string              name;
+    sys::inotify_watch_flags                  flags;
+    small_string<inotify_inline_name_size> name;
 };
 
 using wd_events = fixed_vector<wd_event, inotify_max_events_per_read>;
@@ -104,7 +106,7 @@ public:
                     consumer_it->second.buff->push(
                         wd_event{
                             .flags = event->mask,
-                            .name  = std::string(event->name()),
+                            .name  = event->name(),
                         }
                     );
                     resume_wds.push_back(consumer_it->first);
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <span>
+#include <sys/uio.h>
+
+#include <core/async/sys/rw_offset.hpp>
 #include <core/async/task.hpp>
 #include <core/concepts/trivial.hpp>
 #include <core/concepts/trivial_span_like.hpp>
@@ -10,15 +14,38 @@
 namespace core::async {
 template <typename Lazy>
 struct read_provider {
+    /* Reads from the file position and advances it, offset is ignored by pipes and sockets */
     task<sys::syscall_result<size_t>> read(sys::fd_t fd, void* output, size_t size) {
+        return pread(fd, output, size, current_pos);
+    }
+
+    task<sys::syscall_result<size_t>> pread(sys::fd_t fd, void* output, size_t size, u64 offset) {
+        if (io::uring::current_ctx->is_tasks_blocked()) {
+            co_return {errc::ecanceled};
+        }
+
+        auto res = co_await io::uring::make_uring_awaitable(
+            [&fd, &output, &size, &offset](io::uring::uring_awaitable& awaitable) {
+                auto& sqe = io::uring::current_ctx->get_sqe();
+                io_uring_prep_read(&sqe, int(fd), output, unsigned(size), offset);
+                io_uring_sqe_set_data(&sqe, &awaitable);
+                io_uring_submit(io::uring::current_ctx->get_ring());
+            },
+            async_task_type::read
+        );
+        co_return sys::syscall_result<size_t>{res};
+    }
+
+    /* iov must stay valid until the task completes */
+    task<sys::syscall_result<size_t>> preadv(sys::fd_t fd, std::span<const iovec> iov, u64 offset) {
         if (io::uring::current_ctx->is_tasks_blocked()) {
             co_return {errc::ecanceled};
         }
 
         auto res = co_await io::uring::make_uring_awaitable(
-            [&fd, &output, &size](io::uring::uring_awaitable& awaitable) {
+            [&fd, &iov, &offset](io::uring::uring_awaitable& awaitable) {
                 auto& sqe = io::uring::current_ctx->get_sqe();
-                io_uring_prep_read(&sqe, int(fd), output, unsigned(size), 0);
+                io_uring_prep_readv(&sqe, int(fd), iov.data(), unsigned(iov.size()), offset);
                 io_uring_sqe_set_data(&sqe, &awaitable);
                 io_uring_submit(io::uring::current_ctx->get_ring());
             },
@@ -76,6 +103,16 @@ auto read(sys::fd_t fd, T* output, size_t size) {
     return read_provider<void>{}.read(fd, output, size);
 }
 
+/* offset == current_pos reads from the file position and advances it */
+template <typename T>
+auto pread(sys::fd_t fd, T* output, size_t size, u64 offset) {
+    return read_provider<void>{}.pread(fd, output, size, offset);
+}
+
+inline auto preadv(sys::fd_t fd, std::span<const iovec> iov, u64 offset) {
+    return read_provider<void>{}.preadv(fd, iov, offset);
+}
+
 /* Return ENAVAIL if read() returns less than sizeof(T) */
 template <typename T> requires core::trivial<T>
 auto read(sys::fd_t fd) {
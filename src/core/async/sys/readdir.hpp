@@ -19,12 +19,13 @@ task<sys::syscall_result<sys::dirent_result<u8[BuffSize]>>> getdents(sys::fd_t f
     }
 
     std::future<sys::syscall_result<sys::dirent_result<u8[BuffSize]>>> res;
+    io::uring::ctx::thread_task                                        thread_task;
 
-    co_await make_awaitable<long>([&res, fd]<typename Promise>(io::uring::uring_awaitable& awaitable, std::coroutine_handle<Promise>& caller) mutable {
+    co_await make_awaitable<long>([&res, &thread_task, fd]<typename Promise>(io::uring::uring_awaitable& awaitable, std::coroutine_handle<Promise>& caller) mutable {
         caller.promise()._cancelation_point.set((u64)&awaitable, awaitable_type::uring_threaded);
         caller.promise().set_metainfo({awaitable_type::uring_threaded, async_task_type::getdents});
         // TODO: thread tasks cancelation
-        io::uring::current_ctx->schedule_thread_task(awaitable, [&res, fd](sys::fd_t efd) mutable {
+        io::uring::current_ctx->schedule_thread_task(thread_task, awaitable, [&res, fd](sys::fd_t efd) mutable {
             res = std::async(std::launch::async, [fd] { return sys::getdents<BuffSize>(fd); });
             res.wait();
             sys::write(efd, u64(1));
@@ -40,12 +41,13 @@ task<sys::syscall_result<sys::dirent_result<u8*>>> getdents(sys::fd_t fd, std::s
     }
 
     std::future<sys::syscall_result<sys::dirent_result<u8*>>> res;
+    io::uring::ctx::thread_task                               thread_task;
 
-    co_await make_awaitable<long>([&res, fd, buff]<typename Promise>(io::uring::uring_awaitable& awaitable, std::coroutine_handle<Promise>& caller) mutable {
+    co_await make_awaitable<long>([&res, &thread_task, fd, buff]<typename Promise>(io::uring::uring_awaitable& awaitable, std::coroutine_handle<Promise>& caller) mutable {
         caller.promise()._cancelation_point.set((u64)&awaitable, awaitable_type::uring_threaded);
         caller.promise().set_metainfo({awaitable_type::uring_threaded, async_task_type::getdents});
         // TODO: thread tasks cancelation
-        io::uring::current_ctx->schedule_thread_task(awaitable, [&res, fd, buff](sys::fd_t efd) mutable {
+        io::uring::current_ctx->schedule_thread_task(thread_task, awaitable, [&res, fd, buff](sys::fd_t efd) mutable {
             res = std::async(std::launch::async, [fd, buff, efd] {
                 auto res = sys::getdents(fd, buff);
                 sys::write(efd, u64(1));
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <core/basic_types.hpp>
+
+namespace core::async {
+/* Offset of positional reads/writes which uses and advances the file position, as read(2)/write(2) do */
+inline constexpr u64 current_pos = ~u64(0);
+} // namespace core::async
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <core/async/sys/rw_offset.hpp>
+#include <core/async/task.hpp>
+#include <core/io/uring/ctx.hpp>
+
+#include <sys/splice_flags.hpp>
+#include <sys/syscall.hpp>
+
+namespace core::async {
+/* One of fds must be a pipe, current_pos for pipes and to use the file position */
+template <typename Lazy = void>
+task<sys::syscall_result<size_t>> splice(sys::fd_t fd_in, u64 off_in, sys::fd_t fd_out, u64 off_out, size_t len, sys::splice_flags flags = {}) {
+    if (io::uring::current_ctx->is_tasks_blocked()) {
+        co_return {errc::ecanceled};
+    }
+
+    auto res = co_await io::uring::make_uring_awaitable(
+        [&](io::uring::uring_awaitable& awaitable) {
+            auto& sqe = io::uring::current_ctx->get_sqe();
+            io_uring_prep_splice(&sqe, int(fd_in), i64(off_in), int(fd_out), i64(off_out), unsigned(len), flags.value);
+            io_uring_sqe_set_data(&sqe, &awaitable);
+            io_uring_submit(io::uring::current_ctx->get_ring());
+        },
+        async_task_type::splice
+    );
+    co_return sys::syscall_result<size_t>{res};
+}
+} // namespace core::async
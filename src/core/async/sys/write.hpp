@@ -1,5 +1,9 @@
 #pragma once
 
+#include <span>
+#include <sys/uio.h>
+
+#include <core/async/sys/rw_offset.hpp>
 #include <core/async/task.hpp>
 #include <core/concepts/trivial_span_like.hpp>
 #include <core/io/uring/ctx.hpp>
@@ -9,15 +13,38 @@
 namespace core::async {
 template <typename Lazy>
 struct write_provider {
+    /* Writes at the file position and advances it, offset is ignored by pipes and sockets */
     task<sys::syscall_result<size_t>> write(sys::fd_t fd, const void* data, size_t size) {
+        return pwrite(fd, data, size, current_pos);
+    }
+
+    task<sys::syscall_result<size_t>> pwrite(sys::fd_t fd, const void* data, size_t size, u64 offset) {
+        if (io::uring::current_ctx->is_tasks_blocked()) {
+            co_return {errc::ecanceled};
+        }
+
+        auto res = co_await io::uring::make_uring_awaitable(
+            [&fd, &data, &size, &offset](io::uring::uring_awaitable& awaitable) {
+                auto& sqe = io::uring::current_ctx->get_sqe();
+                io_uring_prep_write(&sqe, int(fd), data, unsigned(size), offset);
+                io_uring_sqe_set_data(&sqe, &awaitable);
+                io_uring_submit(io::uring::current_ctx->get_ring());
+            },
+            async_task_type::write
+        );
+        co_return sys::syscall_result<size_t>{res};
+    }
+
+    /* iov must stay valid until the task completes */
+    task<sys::syscall_result<size_t>> pwritev(sys::fd_t fd, std::span<const iovec> iov, u64 offset) {
         if (io::uring::current_ctx->is_tasks_blocked()) {
             co_return {errc::ecanceled};
         }
 
         auto res = co_await io::uring::make_uring_awaitable(
-            [&fd, &data, &size](io::uring::uring_awaitable& awaitable) {
+            [&fd, &iov, &offset](io::uring::uring_awaitable& awaitable) {
                 auto& sqe = io::uring::current_ctx->get_sqe();
-                io_uring_prep_write(&sqe, int(fd), data, unsigned(size), 0);
+                io_uring_prep_writev(&sqe, int(fd), iov.data(), unsigned(iov.size()), offset);
                 io_uring_sqe_set_data(&sqe, &awaitable);
                 io_uring_submit(io::uring::current_ctx->get_ring());
             },
@@ -52,6 +79,21 @@ auto write(sys::fd_t fd, const T* data, size_t size) {
     return write_provider<void>{}.write(fd, data, size);
 }
 
+/* offset == current_pos writes at the file position and advances it */
+template <typename T>
+auto pwrite(sys::fd_t fd, const T* data, size_t size, u64 offset) {
+    return write_provider<void>{}.pwrite(fd, data, size, offset);
+}
+
+/* iov must stay valid until the task completes */
+inline auto writev(sys::fd_t fd, std::span<const iovec> iov) {
+    return write_provider<void>{}.pwritev(fd, iov, current_pos);
+}
+
+inline auto pwritev(sys::fd_t fd, std::span<const iovec> iov, u64 offset) {
+    return write_provider<void>{}.pwritev(fd, iov, offset);
+}
+
 auto write(sys::fd_t fd, const core::trivial auto& data) {
     return write_provider<void>{}.write(fd, data);
 }
@@ -2,13 +2,13 @@
 
 #include <coroutine>
 #include <exception>
-#include <list>
 
 #include <core/async/cancelation_point.hpp>
 #include <core/async/coro_handle_metainfo.hpp>
 #include <core/basic_types.hpp>
-#include <core/function.hpp>
+#include <core/intrusive_list.hpp>
 #include <core/opt.hpp>
+#include <core/pmr.hpp>
 #include <core/traits/is_same.hpp>
 
 #include <util/log.hpp>
@@ -31,12 +31,14 @@ struct task_awaitable_final {
     void await_resume() const noexcept {}
 };
 
-template <typename Task, typename ResultT>
-struct task_promise_type {
+/* Part of the task promise which does not depend on the result type
+ * The hook links a lost task into final_task_waiter
+ */
+struct task_promise_base : pmr::frame_allocated, intrusive_list_hook<> {
     std::coroutine_handle<>    _continuation;
     async::cancelation_point_t _cancelation_point;
-    opt<ResultT>               _result;
     std::exception_ptr         _exception;
+    std::coroutine_handle<>    _lost_handle;
 
 #ifdef CORO_METAINFO
     coro_handle_metainfo _metainfo;
@@ -48,22 +50,10 @@ struct task_promise_type {
 #endif
     }
 
-    Task get_return_object() {
-        return Task{std::coroutine_handle<task_promise_type>::from_promise(*this)};
-    }
-
     void unhandled_exception() noexcept {
         _exception = std::current_exception();
     }
 
-    void return_value(ResultT value) noexcept {
-        _result = mov(value);
-    }
-
-    bool ready() const noexcept {
-        return _result.has_value() || _exception;
-    }
-
     std::suspend_never initial_suspend() noexcept {
         return {};
     }
@@ -73,29 +63,29 @@ struct task_promise_type {
     }
 };
 
-template <typename Task>
-struct task_promise_type<Task, void> {
-    std::coroutine_handle<>    _continuation;
-    async::cancelation_point_t _cancelation_point;
-    bool                       returned = false;
-    std::exception_ptr         _exception;
+template <typename Task, typename ResultT>
+struct task_promise_type : task_promise_base {
+    opt<ResultT> _result;
 
-#ifdef CORO_METAINFO
-    coro_handle_metainfo _metainfo;
-#endif
+    Task get_return_object() {
+        return Task{std::coroutine_handle<task_promise_type>::from_promise(*this)};
+    }
 
-    void set_metainfo([[maybe_unused]] coro_handle_metainfo metainfo) {
-#ifdef CORO_METAINFO
-        _metainfo = metainfo;
-#endif
+    void return_value(ResultT value) noexcept {
+        _result = mov(value);
     }
 
-    Task get_return_object() {
-        return Task{std::coroutine_handle<task_promise_type>::from_promise(*this)};
+    bool ready() const noexcept {
+        return _result.has_value() || _exception;
     }
+};
 
-    void unhandled_exception() noexcept {
-        _exception = std::current_exception();
+template <typename Task>
+struct task_promise_type<Task, void> : task_promise_base {
+    bool returned = false;
+
+    Task get_return_object() {
+        return Task{std::coroutine_handle<task_promise_type>::from_promise(*this)};
     }
 
     void return_void() noexcept {
@@ -105,14 +95,6 @@ struct task_promise_type<Task, void> {
     bool ready() const noexcept {
         return returned || _exception;
     }
-
-    std::suspend_never initial_suspend() noexcept {
-        return {};
-    }
-
-    task_awaitable_final final_suspend() noexcept {
-        return {};
-    }
 };
 
 template <typename ResultT = void>
@@ -131,15 +113,30 @@ public:
     task<void> wait_all();
 
 private:
-    struct func_awaitable {
-        function<task<void>(), 16> awaitable;
-        async::cancelation_point_t cancelation_point;
+    struct lost_task_awaitable {
+        bool await_ready() const noexcept {
+            return promise._lost_handle.done();
+        }
+
+        template <typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> calling) noexcept {
+            promise._continuation                = calling;
+            calling.promise()._cancelation_point = promise._cancelation_point;
 #ifdef CORO_METAINFO
-        coro_handle_metainfo metainfo;
+            calling.promise()._metainfo = promise._metainfo;
 #endif
+        }
+
+        void await_resume() const {
+            if (promise._exception)
+                std::rethrow_exception(promise._exception);
+        }
+
+        task_promise_base& promise;
     };
 
-    std::list<func_awaitable> _awaitables;
+    /* Promises of lost tasks, the waiter owns their coroutine frames */
+    intrusive_list<task_promise_base> _lost;
 };
 
 inline thread_local final_task_waiter* current_final_task_waiter = nullptr;
@@ -247,35 +244,38 @@ struct [[nodiscard]] task {
 
 template <typename T>
 inline void final_task_waiter::push(task<T>&& task) {
-    auto                  cancelation_point = task.cancelation_point();
-    [[maybe_unused]] auto metainfo          = task.metainfo();
-    _awaitables.push_back({
-        [t = mov(task)] mutable -> core::task<void> { co_await t; },
-        cancelation_point,
-#ifdef CORO_METAINFO
-        metainfo,
-#endif
-    });
+    auto& promise        = task._handle.promise();
+    promise._lost_handle = task._handle;
+    _lost.push_back(promise);
+    task._handle = {};
 }
 
 inline task<void> final_task_waiter::wait_all() {
-    while (!_awaitables.empty()) {
-        auto w = mov(_awaitables.front());
-        _awaitables.pop_front();
+    while (!_lost.empty()) {
+        auto& promise = _lost.front();
+        auto  handle  = promise._lost_handle;
+        _lost.pop_front();
         try {
 #ifdef CORO_METAINFO
-            glog().warn("co_await lost task{} {}", w.metainfo.to_string(), (void*)w.cancelation_point.get());
+            glog().warn("co_await lost task{} {}", promise._metainfo.to_string(), (void*)promise._cancelation_point.get());
 #else
-            glog().warn("co_await lost task {}", (void*)w.cancelation_point.get());
+            glog().warn("co_await lost task {}", (void*)promise._cancelation_point.get());
 #endif
-            co_await w.awaitable();
+            co_await lost_task_awaitable{promise};
         } catch (const std::exception& e) {
-            glog().error("exception while co_await lost task {}: {}", (void*)w.cancelation_point.get(), e.what());
+            glog().error("exception while co_await lost task {}: {}", (void*)promise._cancelation_point.get(), e.what());
         }
+        handle.destroy();
     }
-    _awaitables.clear();
 }
 
-inline final_task_waiter::final_task_waiter()  = default;
-inline final_task_waiter::~final_task_waiter() = default;
+inline final_task_waiter::final_task_waiter() = default;
+
+inline final_task_waiter::~final_task_waiter() {
+    while (!_lost.empty()) {
+        auto handle = _lost.front()._lost_handle;
+        _lost.pop_front();
+        handle.destroy();
+    }
+}
 } // namespace core
@@ -7,6 +7,7 @@
 
 #include <core/async/concurrent.hpp>
 #include <core/async/util/dir_watch.hpp>
+#include <core/function.hpp>
 #include <core/ranges/zip.hpp>
 #include <sys/inotify_watch_flags.hpp>
 #include <sys/readdir.hpp>
@@ -231,7 +232,7 @@ private:
                         if (file.type == sys::file_type_dt::dir) {
                             flags |= sys::inotify_watch_flag::isdir;
                         }
-                        result_events.push_back(wd_event{.flags = flags, .name = std::string(file.name)});
+                        result_events.push_back(wd_event{.flags = flags, .name = file.name});
                     }
                 } catch (const std::exception& e) {
                     glog().warn(
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+
+#include <core/basic_types.hpp>
+#include <core/limits.hpp>
+
+#include <sys/futex.hpp>
+
+namespace core {
+static inline constexpr size_t cache_line_size = 64;
+
+/* Futex-based event count
+ * Waiter protocol:
+ *     auto key = ec.prepare_wait();
+ *     if (condition()) ec.cancel_wait(); else ec.wait(key);
+ * Notifier changes the condition then calls notify_*(), which costs no syscall if nobody waits.
+ */
+class event_count {
+public:
+    u32 prepare_wait() noexcept {
+        _waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return _epoch.load(std::memory_order_relaxed);
+    }
+
+    void cancel_wait() noexcept {
+        _waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void wait(u32 key) noexcept {
+        while (_epoch.load(std::memory_order_acquire) == key)
+            sys::futex_wait(reinterpret_cast<const u32*>(&_epoch), key);
+        _waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void notify_one() noexcept {
+        notify(1);
+    }
+
+    void notify_all() noexcept {
+        notify(u32(limits<i32>::max()));
+    }
+
+private:
+    void notify(u32 count) noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_waiters.load(std::memory_order_relaxed)) {
+            _epoch.fetch_add(1, std::memory_order_release);
+            sys::futex_wake(reinterpret_cast<const u32*>(&_epoch), count);
+        }
+    }
+
+    std::atomic<u32> _epoch   = 0;
+    std::atomic<u32> _waiters = 0;
+};
+} // namespace core
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstring>
+
+#include <core/array.hpp>
+#include <core/basic_types.hpp>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace core {
+namespace dtls {
+    template <size_t N>
+    const char* find_delim_scalar(const char* b, const char* e, const array<char, N>& delims) {
+        if constexpr (N > 8) {
+            u64 table[4]{};
+            for (auto c : delims)
+                table[u8(c) >> 6] |= u64(1) << (u8(c) & 63);
+            for (; b != e; ++b)
+                if (table[u8(*b) >> 6] & (u64(1) << (u8(*b) & 63)))
+                    return b;
+        }
+        else {
+            for (; b != e; ++b)
+                for (auto c : delims)
+                    if (*b == c)
+                        return b;
+        }
+        return e;
+    }
+
+#if defined(__AVX2__)
+    template <size_t N>
+    const char* find_delim_simd(const char* b, const char* e, const array<char, N>& delims) {
+        __m256i v[N];
+        for (size_t i = 0; i < N; ++i)
+            v[i] = _mm256_set1_epi8(delims[i]);
+
+        for (; e - b >= 32; b += 32) {
+            auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+            auto m = _mm256_cmpeq_epi8(x, v[0]);
+            for (size_t i = 1; i < N; ++i)
+                m = _mm256_or_si256(m, _mm256_cmpeq_epi8(x, v[i]));
+            if (auto mask = u32(_mm256_movemask_epi8(m)))
+                return b + __builtin_ctz(mask);
+        }
+        return find_delim_scalar(b, e, delims);
+    }
+#elif defined(__SSE2__)
+    template <size_t N>
+    const char* find_delim_simd(const char* b, const char* e, const array<char, N>& delims) {
+        __m128i v[N];
+        for (size_t i = 0; i < N; ++i)
+            v[i] = _mm_set1_epi8(delims[i]);
+
+        for (; e - b >= 16; b += 16) {
+            auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+            auto m = _mm_cmpeq_epi8(x, v[0]);
+            for (size_t i = 1; i < N; ++i)
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(x, v[i]));
+            if (auto mask = u32(_mm_movemask_epi8(m)))
+                return b + __builtin_ctz(mask);
+        }
+        return find_delim_scalar(b, e, delims);
+    }
+#elif defined(__ARM_NEON)
+    template <size_t N>
+    const char* find_delim_simd(const char* b, const char* e, const array<char, N>& delims) {
+        uint8x16_t v[N];
+        for (size_t i = 0; i < N; ++i)
+            v[i] = vdupq_n_u8(u8(delims[i]));
+
+        for (; e - b >= 16; b += 16) {
+            auto x = vld1q_u8(reinterpret_cast<const u8*>(b));
+            auto m = vceqq_u8(x, v[0]);
+            for (size_t i = 1; i < N; ++i)
+                m = vorrq_u8(m, vceqq_u8(x, v[i]));
+            if (vmaxvq_u8(m)) {
+                /* 4 bits per byte */
+                auto bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+                return b + (__builtin_ctzll(bits) >> 2);
+            }
+        }
+        return find_delim_scalar(b, e, delims);
+    }
+#else
+    template <size_t N>
+    const char* find_delim_simd(const char* b, const char* e, const array<char, N>& delims) {
+        return find_delim_scalar(b, e, delims);
+    }
+#endif
+} // namespace dtls
+
+/* Returns a pointer to the first char in [b, e) equal to any of delims or e */
+template <size_t N>
+const char* find_delim(const char* b, const char* e, const array<char, N>& delims) {
+    if constexpr (N == 1) {
+        if (b == e)
+            return e;
+        auto p = static_cast<const char*>(std::memchr(b, delims[0], size_t(e - b)));
+        return p ? p : e;
+    }
+    else if constexpr (N <= 16)
+        return dtls::find_delim_simd(b, e, delims);
+    else
+        return dtls::find_delim_scalar(b, e, delims);
+}
+
+inline const char* find_delim(const char* b, const char* e, char delim) {
+    return find_delim(b, e, array<char, 1>{delim});
+}
+} // namespace core
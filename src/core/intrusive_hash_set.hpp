@@ -0,0 +1,161 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <core/basic_types.hpp>
+#include <core/traits/decay.hpp>
+#include <core/traits/declval.hpp>
+
+namespace core {
+/* Base class for elements of intrusive_hash_set */
+template <typename Tag = void>
+class intrusive_hash_set_hook {
+public:
+    intrusive_hash_set_hook() = default;
+
+    intrusive_hash_set_hook(const intrusive_hash_set_hook&) noexcept {}
+
+    intrusive_hash_set_hook& operator=(const intrusive_hash_set_hook&) noexcept {
+        return *this;
+    }
+
+    [[nodiscard]]
+    bool is_linked() const noexcept {
+        return _pprev != nullptr;
+    }
+
+private:
+    template <typename, typename, typename>
+    friend class intrusive_hash_set;
+
+    intrusive_hash_set_hook*  _next  = nullptr;
+    intrusive_hash_set_hook** _pprev = nullptr; /* Bucket head or _next of the previous element */
+};
+
+/* Hash set of elements which are not owned by the set, T::key() provides the key
+ * Elements are chained into buckets through their hooks, memory is allocated only for the bucket array.
+ * Elements must be erased before destruction.
+ */
+template <typename T, typename Hash = std::hash<decay<decltype(declval<const T&>().key())>>, typename Tag = void>
+class intrusive_hash_set {
+    using hook = intrusive_hash_set_hook<Tag>;
+
+public:
+    using key_type = decay<decltype(declval<const T&>().key())>;
+
+    intrusive_hash_set(size_t bucket_count = 16): _buckets(round_buckets(bucket_count), nullptr) {}
+
+    ~intrusive_hash_set() {
+        clear();
+    }
+
+    intrusive_hash_set(const intrusive_hash_set&)            = delete;
+    intrusive_hash_set& operator=(const intrusive_hash_set&) = delete;
+
+    /* Returns false if an element with the same key is already present */
+    bool insert(T& value) {
+        if (find(value.key()))
+            return false;
+
+        if (_size >= _buckets.size())
+            rehash(_buckets.size() * 2);
+
+        link(static_cast<hook*>(&value), bucket(value.key()));
+        ++_size;
+        return true;
+    }
+
+    T* find(const key_type& key) noexcept {
+        for (auto h = *bucket(key); h; h = h->_next)
+            if (static_cast<T*>(h)->key() == key)
+                return static_cast<T*>(h);
+        return nullptr;
+    }
+
+    void erase(T& value) noexcept {
+        auto h = static_cast<hook*>(&value);
+        if (!h->_pprev)
+            return;
+
+        unlink(h);
+        --_size;
+    }
+
+    /* Erases and returns the element with the key, nullptr if not found */
+    T* extract(const key_type& key) noexcept {
+        auto value = find(key);
+        if (value)
+            erase(*value);
+        return value;
+    }
+
+    void clear() noexcept {
+        for (auto& b : _buckets)
+            while (b)
+                unlink(b);
+        _size = 0;
+    }
+
+    void foreach(auto&& handler) {
+        for (auto b : _buckets)
+            for (auto h = b; h;) {
+                auto next = h->_next;
+                handler(static_cast<T&>(*h));
+                h = next;
+            }
+    }
+
+    [[nodiscard]]
+    size_t size() const noexcept {
+        return _size;
+    }
+
+    [[nodiscard]]
+    bool empty() const noexcept {
+        return _size == 0;
+    }
+
+private:
+    static size_t round_buckets(size_t count) {
+        size_t result = 2;
+        while (result < count)
+            result <<= 1;
+        return result;
+    }
+
+    hook** bucket(const key_type& key) noexcept {
+        return &_buckets[Hash{}(key) & (_buckets.size() - 1)];
+    }
+
+    static void link(hook* h, hook** head) noexcept {
+        h->_next = *head;
+        if (*head)
+            (*head)->_pprev = &h->_next;
+        *head     = h;
+        h->_pprev = head;
+    }
+
+    static void unlink(hook* h) noexcept {
+        *h->_pprev = h->_next;
+        if (h->_next)
+            h->_next->_pprev = h->_pprev;
+        h->_next  = nullptr;
+        h->_pprev = nullptr;
+    }
+
+    void rehash(size_t count) {
+        std::vector<hook*> old(count, nullptr);
+        old.swap(_buckets);
+        for (auto b : old)
+            while (b) {
+                auto h = b;
+                b      = h->_next;
+                link(h, bucket(static_cast<T*>(h)->key()));
+            }
+    }
+
+    std::vector<hook*> _buckets;
+    size_t             _size = 0;
+};
+} // namespace core
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <functional>
+
+#include <core/basic_types.hpp>
+
+namespace core {
+template <typename T, typename Compare, typename Tag>
+class intrusive_heap;
+
+/* Base class for elements of intrusive_heap */
+template <typename Tag = void>
+class intrusive_heap_hook {
+public:
+    intrusive_heap_hook() = default;
+
+    intrusive_heap_hook(const intrusive_heap_hook&) noexcept {}
+
+    intrusive_heap_hook& operator=(const intrusive_heap_hook&) noexcept {
+        return *this;
+    }
+
+    [[nodiscard]]
+    bool is_linked() const noexcept {
+        return _linked;
+    }
+
+private:
+    template <typename, typename, typename>
+    friend class intrusive_heap;
+
+    intrusive_heap_hook* _child  = nullptr; /* Leftmost child */
+    intrusive_heap_hook* _next   = nullptr; /* Right sibling */
+    intrusive_heap_hook* _prev   = nullptr; /* Left sibling or parent for the leftmost child */
+    bool                 _linked = false;
+};
+
+/* Pairing heap of elements which are not owned by the heap
+ * top() is the element for which Compare returns true against all other elements (the smallest with std::less).
+ * push O(1), pop and erase amortized O(log n).
+ */
+template <typename T, typename Compare = std::less<T>, typename Tag = void>
+class intrusive_heap {
+    using hook = intrusive_heap_hook<Tag>;
+
+public:
+    intrusive_heap(Compare compare = {}): _cmp(compare) {}
+
+    intrusive_heap(const intrusive_heap&)            = delete;
+    intrusive_heap& operator=(const intrusive_heap&) = delete;
+
+    void push(T& value) noexcept {
+        auto h     = static_cast<hook*>(&value);
+        h->_linked = true;
+        _root      = _root ? meld(_root, h) : h;
+        ++_size;
+    }
+
+    T& top() noexcept {
+        return static_cast<T&>(*_root);
+    }
+
+    const T& top() const noexcept {
+        return static_cast<const T&>(*_root);
+    }
+
+    void pop() noexcept {
+        auto old = _root;
+        _root    = merge_pairs(old->_child);
+        reset(old);
+        --_size;
+    }
+
+    void erase(T& value) noexcept {
+        auto h = static_cast<hook*>(&value);
+        if (h == _root) {
+            pop();
+            return;
+        }
+
+        detach(h);
+        if (auto sub = merge_pairs(h->_child))
+            _root = meld(_root, sub);
+        reset(h);
+        --_size;
+    }
+
+    /* Restores heap order after the key of value was changed */
+    void update(T& value) noexcept {
+        erase(value);
+        push(value);
+    }
+
+    void clear() noexcept {
+        while (_root)
+            pop();
+    }
+
+    [[nodiscard]]
+    bool empty() const noexcept {
+        return _root == nullptr;
+    }
+
+    [[nodiscard]]
+    size_t size() const noexcept {
+        return _size;
+    }
+
+private:
+    bool less(hook* a, hook* b) {
+        return _cmp(static_cast<const T&>(*a), static_cast<const T&>(*b));
+    }
+
+    static void reset(hook* h) noexcept {
+        h->_child  = nullptr;
+        h->_next   = nullptr;
+        h->_prev   = nullptr;
+        h->_linked = false;
+    }
+
+    /* a and b are roots without siblings */
+    hook* meld(hook* a, hook* b) noexcept {
+        if (less(b, a)) {
+            auto t = a;
+            a      = b;
+            b      = t;
+        }
+
+        b->_next = a->_child;
+        if (a->_child)
+            a->_child->_prev = b;
+        b->_prev  = a;
+        a->_child = b;
+        return a;
+    }
+
+    static void detach(hook* h) noexcept {
+        if (h->_prev->_child == h)
+            h->_prev->_child = h->_next;
+        else
+            h->_prev->_next = h->_next;
+
+        if (h->_next)
+            h->_next->_prev = h->_prev;
+
+        h->_next = nullptr;
+        h->_prev = nullptr;
+    }
+
+    /* Two-pass merge of the sibling list */
+    hook* merge_pairs(hook* first) noexcept {
+        if (!first)
+            return nullptr;
+
+        hook* paired = nullptr;
+        while (first) {
+            auto a   = first;
+            auto b   = a->_next;
+            a->_prev = nullptr;
+            if (!b) {
+                a->_next = paired;
+                paired   = a;
+                break;
+            }
+
+            first    = b->_next;
+            a->_next = nullptr;
+            b->_next = nullptr;
+            b->_prev = nullptr;
+
+            auto m   = meld(a, b);
+            m->_next = paired;
+            paired   = m;
+        }
+
+        auto result   = paired;
+        paired        = paired->_next;
+        result->_next = nullptr;
+        while (paired) {
+            auto n   = paired;
+            paired   = n->_next;
+            n->_next = nullptr;
+            result   = meld(result, n);
+        }
+
+        result->_prev = nullptr;
+        return result;
+    }
+
+    hook*                         _root = nullptr;
+    size_t                        _size = 0;
+    [[no_unique_address]] Compare _cmp;
+};
+} // namespace core
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <iterator>
+
+#include <core/basic_types.hpp>
+
+namespace core {
+/* Base class for elements of intrusive_list
+ * Tag allows an element to be linked into several lists at once.
+ * Element unlinks itself on destruction.
+ */
+template <typename Tag = void>
+class intrusive_list_hook {
+public:
+    intrusive_list_hook() = default;
+
+    intrusive_list_hook(const intrusive_list_hook&) noexcept {}
+
+    intrusive_list_hook& operator=(const intrusive_list_hook&) noexcept {
+        return *this;
+    }
+
+    ~intrusive_list_hook() {
+        unlink();
+    }
+
+    [[nodiscard]]
+    bool is_linked() const noexcept {
+        return _next != nullptr;
+    }
+
+    void unlink() noexcept {
+        if (_next) {
+            _prev->_next = _next;
+            _next->_prev = _prev;
+            _prev        = nullptr;
+            _next        = nullptr;
+        }
+    }
+
+private:
+    template <typename, typename>
+    friend class intrusive_list;
+
+    void link_before(intrusive_list_hook* pos) noexcept {
+        _next        = pos;
+        _prev        = pos->_prev;
+        _prev->_next = this;
+        pos->_prev   = this;
+    }
+
+    intrusive_list_hook* _prev = nullptr;
+    intrusive_list_hook* _next = nullptr;
+};
+
+/* Doubly-linked list of elements which are not owned by the list
+ * Elements must outlive their membership or unlink themselves, the list itself is not movable.
+ */
+template <typename T, typename Tag = void>
+class intrusive_list {
+    using hook = intrusive_list_hook<Tag>;
+
+public:
+    template <typename U>
+    class iterator_t {
+    public:
+        using value_type        = U;
+        using reference         = U&;
+        using pointer           = U*;
+        using difference_type   = std::ptrdiff_t;
+        using iterator_category = std::bidirectional_iterator_tag;
+
+        iterator_t() = default;
+        explicit iterator_t(hook* h): _h(h) {}
+
+        U& operator*() const noexcept {
+            return static_cast<U&>(*_h);
+        }
+
+        U* operator->() const noexcept {
+            return &static_cast<U&>(*_h);
+        }
+
+        iterator_t& operator++() noexcept {
+            _h = _h->_next;
+            return *this;
+        }
+
+        iterator_t operator++(int) noexcept {
+            auto res = *this;
+            ++(*this);
+            return res;
+        }
+
+        iterator_t& operator--() noexcept {
+            _h = _h->_prev;
+            return *this;
+        }
+
+        iterator_t operator--(int) noexcept {
+            auto res = *this;
+            --(*this);
+            return res;
+        }
+
+        bool operator==(const iterator_t&) const = default;
+
+    private:
+        friend class intrusive_list;
+        hook* _h = nullptr;
+    };
+
+    using iterator       = iterator_t<T>;
+    using const_iterator = iterator_t<const T>;
+
+    intrusive_list() noexcept {
+        _head._prev = &_head;
+        _head._next = &_head;
+    }
+
+    ~intrusive_list() {
+        clear();
+    }
+
+    intrusive_list(const intrusive_list&)            = delete;
+    intrusive_list& operator=(const intrusive_list&) = delete;
+
+    void push_back(T& value) noexcept {
+        static_cast<hook&>(value).link_before(&_head);
+    }
+
+    void push_front(T& value) noexcept {
+        static_cast<hook&>(value).link_before(_head._next);
+    }
+
+    /* Inserts value before pos */
+    iterator insert(iterator pos, T& value) noexcept {
+        static_cast<hook&>(value).link_before(pos._h);
+        return iterator{static_cast<hook*>(&value)};
+    }
+
+    iterator erase(iterator pos) noexcept {
+        auto next = pos._h->_next;
+        pos._h->unlink();
+        return iterator{next};
+    }
+
+    static void erase(T& value) noexcept {
+        static_cast<hook&>(value).unlink();
+    }
+
+    T& front() noexcept {
+        return static_cast<T&>(*_head._next);
+    }
+
+    T& back() noexcept {
+        return static_cast<T&>(*_head._prev);
+    }
+
+    void pop_front() noexcept {
+        _head._next->unlink();
+    }
+
+    void pop_back() noexcept {
+        _head._prev->unlink();
+    }
+
+    void clear() noexcept {
+        while (!empty())
+            pop_front();
+    }
+
+    [[nodiscard]]
+    bool empty() const noexcept {
+        return _head._next == &_head;
+    }
+
+    /* O(n) */
+    [[nodiscard]]
+    size_t size() const noexcept {
+        size_t result = 0;
+        for (auto h = _head._next; h != &_head; h = h->_next)
+            ++result;
+        return result;
+    }
+
+    iterator begin() noexcept {
+        return iterator{_head._next};
+    }
+
+    iterator end() noexcept {
+        return iterator{&_head};
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator{const_cast<hook*>(_head._next)};
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator{const_cast<hook*>(&_head)};
+    }
+
+private:
+    hook _head;
+};
+} // namespace core
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <memory>
+
+#include <core/basic_types.hpp>
+#include <sys/mmap.hpp>
+
+namespace core::io
+{
+/* Fixed set of page aligned buffers for O_DIRECT I/O, allocated as a single anonymous mapping
+ * With huge_pages the mapping is tried with MAP_HUGETLB first and falls back to regular pages advised with MADV_HUGEPAGE.
+ */
+class aligned_buffer_pool {
+public:
+    static constexpr size_t page_size      = 4096;
+    static constexpr size_t huge_page_size = size_t(2) << 20;
+
+    aligned_buffer_pool(size_t buffer_size, size_t count, bool huge_pages = false):
+        _buffer_size(align_up(buffer_size, page_size)), _count(count), _free(new u8*[count]) {
+        auto len  = _buffer_size * count;
+        auto prot = sys::map_prot::read | sys::map_prot::write;
+
+        if (huge_pages) {
+            auto huge_len = align_up(len, huge_page_size);
+            if (auto res = sys::mmap(huge_len, prot, sys::map_flag::priv | sys::map_flag::anon | sys::map_flag::hugetlb)) {
+                _data = static_cast<u8*>(*res);
+                _len  = huge_len;
+            }
+        }
+
+        if (!_data) {
+            _data = static_cast<u8*>(sys::mmap(len, prot, sys::map_flag::priv | sys::map_flag::anon).get());
+            _len  = len;
+            if (huge_pages)
+                sys::madvise(_data, _len, sys::madvise_advice::hugepage);
+        }
+
+        for (size_t i = 0; i < count; ++i)
+            _free[i] = _data + (count - 1 - i) * _buffer_size;
+        _free_count = count;
+    }
+
+    ~aligned_buffer_pool() {
+        if (_data)
+            sys::munmap(_data, _len);
+    }
+
+    aligned_buffer_pool(const aligned_buffer_pool&)            = delete;
+    aligned_buffer_pool& operator=(const aligned_buffer_pool&) = delete;
+
+    /* Returns nullptr if all buffers are taken */
+    [[nodiscard]]
+    u8* acquire() noexcept {
+        return _free_count ? _free[--_free_count] : nullptr;
+    }
+
+    void release(u8* buff) noexcept {
+        _free[_free_count++] = buff;
+    }
+
+    size_t buffer_size() const noexcept {
+        return _buffer_size;
+    }
+
+    size_t count() const noexcept {
+        return _count;
+    }
+
+    size_t available() const noexcept {
+        return _free_count;
+    }
+
+    bool owns(const u8* buff) const noexcept {
+        return buff >= _data && buff < _data + _buffer_size * _count;
+    }
+
+    static constexpr size_t align_up(size_t value, size_t alignment) noexcept {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+private:
+    u8*                    _data = nullptr;
+    size_t                 _len  = 0;
+    size_t                 _buffer_size;
+    size_t                 _count;
+    std::unique_ptr<u8*[]> _free;
+    size_t                 _free_count = 0;
+};
+} // namespace core::io
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <memory>
+
+#include <core/io/file.hpp>
+#include <core/io/rw_impl.hpp>
+#include <core/opt.hpp>
+
+#include <sys/copy_file_range.hpp>
+#include <sys/read.hpp>
+#include <sys/sendfile.hpp>
+#include <sys/splice.hpp>
+#include <sys/statx.hpp>
+#include <sys/write.hpp>
+
+#ifndef DISABLE_ASYNC
+#include <core/async/sys/splice.hpp>
+#endif
+
+namespace core::io
+{
+namespace details
+{
+    inline constexpr size_t copy_chunk      = size_t(1) << 30; /* Max bytes per syscall */
+    inline constexpr size_t copy_pipe_chunk = size_t(1) << 16; /* Default pipe capacity */
+    inline constexpr size_t copy_buff_size  = size_t(1) << 18;
+
+    inline sys::file_type copy_fd_type(sys::fd_t fd) {
+        return sys::statx(fd, sys::statx_mask::mode).get().mode.type();
+    }
+
+    /* The kernel does not support this path for the fds */
+    inline bool copy_unsupported(errc error) {
+        return error == errc::einval || error == errc::exdev || error == errc::enosys || error == errc::eopnotsupp;
+    }
+
+    /* Calls transfer(max) until len bytes are copied, the input ends or the fds would block
+     * Returns null if the first call was rejected, so the caller may try another path.
+     */
+    inline opt<size_t> copy_loop(size_t len, auto&& transfer) {
+        size_t copied = 0;
+        while (copied < len) {
+            auto res = transfer(len - copied < copy_chunk ? len - copied : copy_chunk);
+            if (!res) {
+                if (copied == 0 && copy_unsupported(res.error()))
+                    return null;
+                if (res.error() == errc::eagain)
+                    break;
+                res.throw_if_error();
+            }
+            if (*res == 0)
+                break;
+            copied += *res;
+        }
+        return copied;
+    }
+
+    /* Neither fd is a pipe: in -> pipe -> out */
+    inline opt<size_t> copy_through_pipe(sys::fd_t in, sys::fd_t out, size_t len) {
+        auto   p      = file::pipe();
+        size_t copied = 0;
+        while (copied < len) {
+            auto res = sys::splice(in, nullptr, p.out, nullptr, len - copied < copy_pipe_chunk ? len - copied : copy_pipe_chunk, sys::splice_flag::move);
+            if (!res) {
+                if (copied == 0 && copy_unsupported(res.error()))
+                    return null;
+                if (res.error() == errc::eagain)
+                    break;
+                res.throw_if_error();
+            }
+            if (*res == 0)
+                break;
+
+            /* Data in the pipe must reach out, otherwise it is lost */
+            for (auto left = *res; left;) {
+                auto wrote = sys::splice(p.in, nullptr, out, nullptr, left, sys::splice_flag::move).get();
+                if (wrote == 0)
+                    throw errc_exception(errc::eio);
+                left -= wrote;
+            }
+            copied += *res;
+        }
+        return copied;
+    }
+
+    inline size_t copy_buffered(sys::fd_t in, sys::fd_t out, size_t len) {
+        auto   buff   = std::unique_ptr<u8[]>(new u8[copy_buff_size]);
+        size_t copied = 0;
+        while (copied < len) {
+            auto res = sys::read(in, buff.get(), len - copied < copy_buff_size ? len - copied : copy_buff_size);
+            if (!res && res.error() == errc::eagain)
+                break;
+
+            auto read = res.get();
+            if (read == 0)
+                break;
+
+            for (size_t pos = 0; pos < read;) {
+                auto wrote = sys::write(out, buff.get() + pos, read - pos).get();
+                if (wrote == 0)
+                    throw errc_exception(errc::eio);
+                pos += wrote;
+            }
+            copied += read;
+        }
+        return copied;
+    }
+
+    inline size_t copy_typed(sys::fd_t in, sys::file_type in_type, sys::fd_t out, sys::file_type out_type, size_t len) {
+        if (in_type == sys::file_type::regular && out_type == sys::file_type::regular) {
+            if (auto res = copy_loop(len, [&](size_t max) { return sys::copy_file_range(in, nullptr, out, nullptr, max); }))
+                return *res;
+        }
+
+        if (in_type == sys::file_type::regular || in_type == sys::file_type::block) {
+            if (auto res = copy_loop(len, [&](size_t max) { return sys::sendfile(out, in, nullptr, max); }))
+                return *res;
+        }
+
+        if (in_type == sys::file_type::fifo || out_type == sys::file_type::fifo) {
+            if (auto res = copy_loop(len, [&](size_t max) { return sys::splice(in, nullptr, out, nullptr, max, sys::splice_flag::move); }))
+                return *res;
+        }
+        else if (auto res = copy_through_pipe(in, out, len))
+            return *res;
+
+        return copy_buffered(in, out, len);
+    }
+} // namespace details
+
+/* Copies up to len bytes from in to out at their file positions, until the end of input by default
+ * The path is chosen by the fd types: copy_file_range for file -> file, sendfile from a file, splice when
+ * one side is a pipe or through an intermediate pipe otherwise. A read/write loop is the fallback.
+ * Stops early if a nonblocking fd would block, returns the number of bytes copied.
+ */
+inline size_t copy(sys::fd_t in, sys::fd_t out, size_t len = size_t(-1)) {
+    return details::copy_typed(in, details::copy_fd_type(in), out, details::copy_fd_type(out), len);
+}
+
+/* Same with the fd types cached by the backends, so no statx is done per call: io::copy(in, out) for io::in and
+ * io::out over fds. Their buffers are not involved, the buffered data must be consumed or flushed before.
+ */
+template <typename In, typename Out>
+size_t copy(const rw_impl<In>& in, const rw_impl<Out>& out, size_t len = size_t(-1))
+    requires requires { in.fd_type(); out.fd_type(); }
+{
+    return details::copy_typed(in.fd(), in.fd_type(), out.fd(), out.fd_type(), len);
+}
+} // namespace core::io
+
+#ifndef DISABLE_ASYNC
+namespace core::async
+{
+namespace details
+{
+    inline task<size_t> copy_spliced(sys::fd_t in, sys::fd_t out, bool through_pipe, size_t len) {
+        using io::details::copy_pipe_chunk;
+
+        size_t copied = 0;
+        if (!through_pipe) {
+            while (copied < len) {
+                auto res = (co_await splice(in, current_pos, out, current_pos, len - copied < copy_pipe_chunk ? len - copied : copy_pipe_chunk)).get();
+                if (res == 0)
+                    break;
+                copied += res;
+            }
+            co_return copied;
+        }
+
+        auto p = io::file::pipe();
+        while (copied < len) {
+            auto res = (co_await splice(in, current_pos, p.out, current_pos, len - copied < copy_pipe_chunk ? len - copied : copy_pipe_chunk)).get();
+            if (res == 0)
+                break;
+
+            for (auto left = res; left;) {
+                auto wrote = (co_await splice(p.in, current_pos, out, current_pos, left)).get();
+                if (wrote == 0)
+                    throw errc_exception(errc::eio);
+                left -= wrote;
+            }
+            copied += res;
+        }
+        co_return copied;
+    }
+} // namespace details
+
+/* Splices up to len bytes from in to out through the ring, an intermediate pipe is used if neither fd is a pipe */
+inline task<size_t> copy(sys::fd_t in, sys::fd_t out, size_t len = size_t(-1)) {
+    auto through_pipe = io::details::copy_fd_type(in) != sys::file_type::fifo && io::details::copy_fd_type(out) != sys::file_type::fifo;
+    return details::copy_spliced(in, out, through_pipe, len);
+}
+
+/* Same with the fd types cached by the backends, see io::copy */
+template <typename In, typename Out>
+task<size_t> copy(const io::rw_impl<In>& in, const io::rw_impl<Out>& out, size_t len = size_t(-1))
+    requires requires { in.fd_type(); out.fd_type(); }
+{
+    auto through_pipe = in.fd_type() != sys::file_type::fifo && out.fd_type() != sys::file_type::fifo;
+    return details::copy_spliced(in.fd(), out.fd(), through_pipe, len);
+}
+} // namespace core::async
+#endif
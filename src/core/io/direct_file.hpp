@@ -0,0 +1,304 @@
+#pragma once
+
+#include <core/assert.hpp>
+#include <core/concepts/trivial_span_like.hpp>
+#include <core/io/aligned_buffer_pool.hpp>
+#include <core/io/file.hpp>
+#include <core/utility/move.hpp>
+
+#include <sys/ftruncate.hpp>
+#include <sys/read.hpp>
+#include <sys/statx.hpp>
+#include <sys/write.hpp>
+
+#ifndef DISABLE_ASYNC
+#include <core/async/sys/read.hpp>
+#include <core/async/sys/write.hpp>
+#endif
+
+#define fwd(...) static_cast<decltype(__VA_ARGS__)>(__VA_ARGS__)
+
+namespace core::io
+{
+/* File opened with O_DIRECT: reads and writes bypass the page cache
+ * Buffers must be aligned to mem_alignment(), offsets and lengths to alignment(). Both are queried with statx
+ * and default to 4096 if the kernel does not report them. Misaligned requests throw EINVAL without a syscall.
+ */
+class direct_file {
+public:
+    static direct_file open(auto&&... args) {
+        return direct_file{file::open(fwd(args)..., sys::openflag::direct)};
+    }
+
+#ifndef DISABLE_ASYNC
+    static task<direct_file> open_async(auto&&... args) {
+        co_return direct_file{co_await file::open_async(fwd(args)..., sys::openflag::direct)};
+    }
+#endif
+
+    explicit direct_file(file f): _file(mov(f)) {
+        auto info = sys::statx(_file.fd(), sys::statx_mask::dio_mem_align).get();
+        if (info.mask.test(sys::statx_mask::dio_mem_align) && info.dio_offset_align) {
+            _align     = info.dio_offset_align;
+            _mem_align = info.dio_mem_align;
+        }
+    }
+
+    size_t alignment() const {
+        return _align;
+    }
+
+    size_t mem_alignment() const {
+        return _mem_align;
+    }
+
+    bool is_aligned(const void* buff, size_t size, u64 offset) const {
+        return uptr(buff) % _mem_align == 0 && size % _align == 0 && offset % _align == 0;
+    }
+
+    size_t pread(void* buff, size_t size, u64 offset) {
+        check_aligned(buff, size, offset);
+        return sys::pread(_file.fd(), static_cast<u8*>(buff), size, off_t(offset)).get();
+    }
+
+    size_t pwrite(const void* buff, size_t size, u64 offset) {
+        check_aligned(buff, size, offset);
+        return sys::pwrite(_file.fd(), static_cast<const u8*>(buff), size, off_t(offset)).get();
+    }
+
+#ifndef DISABLE_ASYNC
+    task<size_t> pread_async(void* buff, size_t size, u64 offset) {
+        check_aligned(buff, size, offset);
+        co_return (co_await async::pread(_file.fd(), buff, size, offset)).get();
+    }
+
+    task<size_t> pwrite_async(const void* buff, size_t size, u64 offset) {
+        check_aligned(buff, size, offset);
+        co_return (co_await async::pwrite(_file.fd(), buff, size, offset)).get();
+    }
+#endif
+
+    u64 size() const {
+        return sys::statx(_file.fd(), sys::statx_mask::size).get().size;
+    }
+
+    /* Any length is allowed */
+    void truncate(u64 size) {
+        sys::ftruncate(_file.fd(), off_t(size)).throw_if_error();
+    }
+
+    constexpr sys::fd_t fd() const {
+        return _file.fd();
+    }
+
+    constexpr operator sys::fd_t() const {
+        return _file.fd();
+    }
+
+private:
+    void check_aligned(const void* buff, size_t size, u64 offset) const {
+        if (!is_aligned(buff, size, offset))
+            throw errc_exception(errc::einval);
+    }
+
+    file _file;
+    u32  _align     = 4096;
+    u32  _mem_align = 4096;
+};
+
+/* Sequential writer to a direct_file through a pool of N aligned buffers of BS bytes
+ * The tail which is not a multiple of the file alignment is written zero padded by flush() and the file is truncated
+ * to offset(); the tail stays buffered and is rewritten in place by the next flush.
+ * write_async() keeps up to N - 1 buffers in flight like out_behind. The kernel reads them until the writes complete,
+ * so flush_async() must be awaited before destruction if write_async() was used: destruction with writes in flight
+ * terminates. The destructor flushes the tail synchronously.
+ */
+template <size_t BS = (size_t(1) << 20), size_t N = 4>
+    requires(N >= 1 && BS > 0 && BS % aligned_buffer_pool::page_size == 0)
+class direct_out {
+public:
+    direct_out(direct_file& file, u64 offset = 0, bool huge_pages = false): _file(file), _pool(BS, N, huge_pages), _offset(offset) {
+        if (offset % file.alignment())
+            throw errc_exception(errc::einval);
+    }
+
+    ~direct_out() {
+        tbc_r_assert(_count == 0 && "direct_out destroyed with writes in flight, flush_async() was not awaited");
+        try {
+            flush();
+        }
+        catch (...) {
+        }
+    }
+
+    direct_out(direct_out&&)            = delete;
+    direct_out& operator=(direct_out&&) = delete;
+
+    static constexpr size_t buffer_capacity() {
+        return BS;
+    }
+
+    /* Offset of the next byte written */
+    u64 offset() const {
+        return _offset + _pos;
+    }
+
+    void write(const trivial_span_like auto& data) {
+        auto   p       = reinterpret_cast<const u8*>(data.data());
+        size_t data_sz = data.size() * sizeof(*data.data());
+
+        while (data_sz) {
+            auto sz = fill(p, data_sz);
+            p       += sz;
+            data_sz -= sz;
+            if (_pos == BS)
+                write_full();
+        }
+    }
+
+    void write(const trivial auto& data) {
+        write(std::span{&data, 1});
+    }
+
+    void flush() {
+        if (!_pos)
+            return;
+
+        auto padded = pad_tail();
+        write_all(_cur, padded, _offset);
+        _file.truncate(_offset + _pos);
+    }
+
+#ifndef DISABLE_ASYNC
+    task<> write_async(const trivial_span_like auto& data) {
+        auto   p       = reinterpret_cast<const u8*>(data.data());
+        size_t data_sz = data.size() * sizeof(*data.data());
+
+        while (data_sz) {
+            if (!_cur && !_pool.available())
+                co_await complete_oldest();
+
+            auto sz = fill(p, data_sz);
+            p       += sz;
+            data_sz -= sz;
+            if (_pos == BS)
+                co_await submit();
+        }
+    }
+
+    task<> write_async(const trivial auto& data) {
+        co_await write_async(std::span{&data, 1});
+    }
+
+    /* All writes in flight are completed even if one of them fails, the first error is rethrown */
+    task<> flush_async() {
+        std::exception_ptr error;
+        while (_count) {
+            try {
+                co_await complete_oldest();
+            }
+            catch (...) {
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+        if (error)
+            std::rethrow_exception(error);
+
+        if (!_pos)
+            co_return;
+
+        auto padded = pad_tail();
+        for (size_t done = 0; done < padded;) {
+            auto wrote = co_await _file.pwrite_async(_cur + done, padded - done, _offset + done);
+            if (wrote == 0)
+                throw errc_exception(errc::eio);
+            done += wrote;
+        }
+        _file.truncate(_offset + _pos);
+    }
+#endif
+
+private:
+    size_t fill(const u8* p, size_t data_sz) {
+        if (!_cur)
+            _cur = _pool.acquire();
+
+        auto sz = data_sz < BS - _pos ? data_sz : BS - _pos;
+        __builtin_memcpy(_cur + _pos, p, sz);
+        _pos += sz;
+        return sz;
+    }
+
+    size_t pad_tail() {
+        auto padded = aligned_buffer_pool::align_up(_pos, _file.alignment());
+        __builtin_memset(_cur + _pos, 0, padded - _pos);
+        return padded;
+    }
+
+    void write_all(u8* buff, size_t size, u64 offset) {
+        for (size_t done = 0; done < size;) {
+            auto wrote = _file.pwrite(buff + done, size - done, offset + done);
+            if (wrote == 0)
+                throw errc_exception(errc::eio);
+            done += wrote;
+        }
+    }
+
+    void write_full() {
+        write_all(_cur, BS, _offset);
+        _offset += BS;
+        _pos     = 0;
+    }
+
+#ifndef DISABLE_ASYNC
+    /* The buffer belongs to the pool which outlives the write */
+    static task<u8*> write_buffer(direct_file& file, u8* buff, u64 offset) {
+        for (size_t done = 0; done < BS;) {
+            auto wrote = co_await file.pwrite_async(buff + done, BS - done, offset + done);
+            if (wrote == 0)
+                throw errc_exception(errc::eio);
+            done += wrote;
+        }
+        co_return buff;
+    }
+
+    task<> complete_oldest() {
+        auto& slot = _inflight[_head];
+        _head      = (_head + 1) % N;
+        --_count;
+        _pool.release(co_await slot);
+    }
+
+    task<> submit() {
+        /* One buffer is kept for filling */
+        while (_count && _count >= N - 1)
+            co_await complete_oldest();
+
+        if constexpr (N == 1) {
+            co_await write_buffer(_file, _cur, _offset);
+        }
+        else {
+            _inflight[(_head + _count) % N] = write_buffer(_file, _cur, _offset);
+            ++_count;
+            _cur = nullptr;
+        }
+        _offset += BS;
+        _pos     = 0;
+    }
+#endif
+
+    direct_file&        _file;
+    aligned_buffer_pool _pool;
+    u8*                 _cur    = nullptr;
+    size_t              _pos    = 0;
+    u64                 _offset = 0;
+#ifndef DISABLE_ASYNC
+    task<u8*> _inflight[N];
+    size_t    _head = 0;
+#endif
+    size_t _count = 0;
+};
+} // namespace core::io
+
+#undef fwd
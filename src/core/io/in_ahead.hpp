@@ -0,0 +1,220 @@
+#pragma once
+
+#ifndef DISABLE_ASYNC
+
+#include <memory>
+
+#include <core/assert.hpp>
+#include <core/async/sys/read.hpp>
+#include <core/io/in_base.hpp>
+
+#define fwd(...) static_cast<decltype(__VA_ARGS__)>(__VA_ARGS__)
+
+namespace core::io
+{
+/* Read-ahead async input: up to K reads of BS bytes are in flight while the current buffer is consumed.
+ * The window starts with one read and doubles on every buffer consumed sequentially, seek_async() resets it.
+ * Regular files are read with explicit offsets, pipes and sockets have a single read in flight.
+ * read_view_async() hands out the buffered data without a copy.
+ * drain_async() must be awaited before destruction if reads may be in flight: destruction with reads in flight
+ * terminates. Read errors are thrown by the read which hits them, drain_async() completes the reads behind it.
+ */
+template <typename Fd, size_t BS = 65536, size_t K = 4, typename B = rw_impl<Fd>>
+    requires(K >= 1 && BS > 0)
+class in_ahead : public B {
+public:
+    in_ahead(): B(true) {}
+    in_ahead(auto&& base): B(fwd(base), true) {}
+
+    ~in_ahead() {
+        tbc_r_assert(count == 0 && "in_ahead destroyed with reads in flight, drain_async() was not awaited");
+    }
+
+    in_ahead(in_ahead&&)            = delete;
+    in_ahead& operator=(in_ahead&&) = delete;
+
+    static constexpr size_t buffer_capacity() {
+        return BS;
+    }
+
+    static constexpr size_t max_window() {
+        return K;
+    }
+
+    /* Reads in flight allowed now */
+    size_t window() const {
+        return win;
+    }
+
+    /* Unread bytes of the current buffer */
+    size_t buffer_size() const {
+        return cur.size - cur.pos;
+    }
+
+    /* Returns up to max bytes of the current buffer, valid until the next call; empty span at the end of input */
+    task<std::span<const u8>> read_view_async(size_t max = size_t(-1)) {
+        if (cur.pos == cur.size && !co_await next_chunk())
+            co_return std::span<const u8>{};
+
+        auto sz = cur.size - cur.pos < max ? cur.size - cur.pos : max;
+        auto p  = cur.buff.get() + cur.pos;
+        cur.pos += sz;
+        co_return std::span<const u8>{p, sz};
+    }
+
+    /* Fills data until the end of input */
+    task<size_t> read_async(trivial_span_like auto&& data) {
+        constexpr auto element_size = sizeof(*data.data());
+        size_t         data_sz      = data.size() * element_size;
+        auto           dst          = (u8*)data.data();
+
+        size_t read = 0;
+        while (read != data_sz) {
+            auto view = co_await read_view_async(data_sz - read);
+            if (view.empty())
+                break;
+            __builtin_memcpy(dst + read, view.data(), view.size());
+            read += view.size();
+        }
+
+        if (read % element_size)
+            throw partial_read_error(read);
+        co_return read;
+    }
+
+    task<size_t> read_async(trivial auto& data) {
+        co_return co_await read_async(std::span{&data, 1});
+    }
+
+    task<> seek_async(off_t offset) {
+        co_await drain_async();
+        start();
+        if (pipe_like)
+            throw errc_exception(errc::espipe);
+
+        release(cur);
+        next = u64(offset);
+        eof  = false;
+        win  = 1;
+    }
+
+    /* Waits for the reads in flight, their data is dropped. The first error is rethrown after all of them complete */
+    task<> drain_async() {
+        std::exception_ptr error;
+        for (bool first = true; count; first = false) {
+            try {
+                auto c = co_await pop();
+                if (first && !pipe_like)
+                    next = c.off;
+                release(c);
+            }
+            catch (...) {
+                if (!error)
+                    error = std::current_exception();
+            }
+            eof = false;
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+private:
+    using buffer_t = std::unique_ptr<u8[]>;
+
+    struct chunk {
+        buffer_t buff;
+        size_t   size = 0;
+        size_t   pos  = 0;
+        u64      off  = async::current_pos;
+    };
+
+    /* Owns the buffer while it is read, so it outlives an unawaited read */
+    static task<chunk> read_chunk(sys::fd_t fd, buffer_t buff, u64 off) {
+        auto res = co_await async::pread(fd, buff.get(), BS, off);
+        co_return chunk{mov(buff), res.get(), 0, off};
+    }
+
+    void start() {
+        if (!started) {
+            pipe_like = this->is_pipe_like();
+            next      = pipe_like ? async::current_pos : u64(this->handle_seek(0, seek_whence::cur));
+            started   = true;
+        }
+    }
+
+    void release(chunk& c) {
+        if (c.buff && free_count < K + 1)
+            free_buffs[free_count++] = mov(c.buff);
+        c.buff.reset();
+        c.size = c.pos = 0;
+    }
+
+    void fill() {
+        while (!eof && count < (pipe_like ? 1 : win)) {
+            auto buff      = free_count ? mov(free_buffs[--free_count]) : buffer_t(new u8[BS]);
+            auto tail      = (head + count) % K;
+            inflight[tail] = read_chunk(this->fd(), mov(buff), next);
+            ++count;
+            if (!pipe_like)
+                next += BS;
+        }
+    }
+
+    task<chunk> pop() {
+        auto& slot = inflight[head];
+        head       = (head + 1) % K;
+        --count;
+        co_return co_await slot;
+    }
+
+    task<bool> next_chunk() {
+        release(cur);
+        start();
+        fill();
+        if (!count)
+            co_return false;
+
+        cur = co_await pop();
+        if (cur.size == 0) {
+            /* End of input: the reads behind it are dropped */
+            co_await drain_async();
+            if (!pipe_like)
+                next = cur.off;
+            eof = true;
+            release(cur);
+            co_return false;
+        }
+
+        if (!pipe_like && cur.size != BS) {
+            /* Short read: the reads behind it start from a wrong offset */
+            auto end = cur.off + cur.size;
+            co_await drain_async();
+            next = end;
+        }
+        else if (win < K) {
+            win *= 2;
+            if (win > K)
+                win = K;
+        }
+
+        fill();
+        co_return true;
+    }
+
+    chunk       cur;
+    buffer_t    free_buffs[K + 1];
+    size_t      free_count = 0;
+    task<chunk> inflight[K];
+    size_t      head      = 0;
+    size_t      count     = 0;
+    size_t      win       = 1;
+    u64         next      = async::current_pos;
+    bool        eof       = false;
+    bool        pipe_like = false;
+    bool        started   = false;
+};
+} // namespace core::io
+
+#undef fwd
+
+#endif
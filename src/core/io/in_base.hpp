@@ -1,7 +1,13 @@
 #pragma once
 
+#include <string>
+#include <string_view>
+
+#include <core/find_delim.hpp>
+#include <core/generator.hpp>
 #include <core/io/concepts.hpp>
 #include <core/io/rw_impl.hpp>
+#include <core/traits/conditional.hpp>
 
 #define fwd(...) static_cast<decltype(__VA_ARGS__)>(__VA_ARGS__)
 
@@ -81,6 +87,64 @@ public:
     }
 #endif
 
+    /* Returns the data up to delim and skips delim, null at the end of input; the last record may have no delim
+     * The view points into the internal buffer and is valid until the next read. Records longer than the buffer
+     * are collected in a separate string.
+     */
+#define read_until_tmpl(POSTFIX, RETURN, RESULT, READ_CALL)                \
+    RESULT read_until##POSTFIX(char delim) {                               \
+        static_assert(BS > 0, "read_until requires a buffer");             \
+        long_record.clear();                                               \
+        size_t scanned = 0;                                                \
+        bool   eof     = false;                                            \
+                                                                           \
+        while (true) {                                                     \
+            auto b = (const char*)buff + pos;                              \
+            auto p = find_delim(b + scanned, b + size, delim);             \
+            if (p != b + size || eof) {                                    \
+                if (p == b + size && size == 0 && long_record.empty())     \
+                    RETURN null;                                           \
+                                                                           \
+                auto len = size_t(p - b);                                  \
+                auto res = std::string_view(b, len);                       \
+                auto skip = p != b + size ? len + 1 : len;                 \
+                pos += skip;                                               \
+                size -= skip;                                              \
+                if (long_record.empty())                                   \
+                    RETURN res;                                            \
+                long_record.append(res);                                   \
+                RETURN std::string_view(long_record);                      \
+            }                                                              \
+                                                                           \
+            if (size == BS) {                                              \
+                long_record.append(b, size);                               \
+                size = 0;                                                  \
+            }                                                              \
+            else if (pos != 0)                                             \
+                __builtin_memmove(buff, b, size);                          \
+            pos     = 0;                                                   \
+            scanned = size;                                                \
+                                                                           \
+            auto read = READ_CALL(buff + size, BS - size);                 \
+            size += read;                                                  \
+            eof = read == 0;                                               \
+        }                                                                  \
+    }
+
+    read_until_tmpl(, return, opt<std::string_view>, this->handle_read)
+
+#ifndef DISABLE_ASYNC
+    read_until_tmpl(_async, co_return, task<opt<std::string_view>>, co_await this->handle_read_async)
+#endif
+
+#undef read_until_tmpl
+
+    /* for (auto line : in.lines()) */
+    generator<std::string_view> lines(char delim = '\n') {
+        while (auto line = read_until(delim))
+            co_yield *line;
+    }
+
     void seek(off_t offset, seek_whence whence = seek_whence::cur) {
         switch (whence) {
         case seek_whence::cur:
@@ -142,9 +206,13 @@ private:
     }
 
 private:
-    size_t  size = 0;
-    size_t  pos  = 0;
-    u8      buff[BS];
+    struct empty_t {};
+    using long_record_t = conditional<(BS > 0), std::string, empty_t>;
+
+    size_t                              size = 0;
+    size_t                              pos  = 0;
+    [[no_unique_address]] long_record_t long_record; /* read_until only */
+    u8                                  buff[BS];
 };
 } // namespace core::io
 
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <memory>
+
+#include <core/io/deduce_backend_type.hpp>
+#include <core/io/rw_impl.hpp>
+#include <core/lz4.hpp>
+
+#define fwd(...) static_cast<decltype(__VA_ARGS__)>(__VA_ARGS__)
+
+namespace core::io
+{
+/* LZ4 frame filter over a file backend: io::out o{io::lz4_frame{file}, size_c<65536>}
+ * Every buffer handed to the backend is compressed as one or more frame blocks of up to BlockSize bytes, so the
+ * in/out buffer size is the compression chunk. The end mark is written on destruction or by finish().
+ * Only writes are async on the backend: async reads, finish() and the destructor do blocking backend I/O on the
+ * calling thread, which is the ring thread with the uring runtime.
+ */
+template <typename Fd, size_t BlockSize = size_t(64) << 10>
+    requires(BlockSize > 0 && BlockSize <= lz4::max_block_size)
+struct lz4_frame {
+    Fd fd;
+};
+
+template <typename F>
+lz4_frame(F&&) -> lz4_frame<decl_type<details::deduce_backend_type<F&&, false>()>>;
+
+/* Reads concatenated frames with linked or independent blocks, checksums are skipped. Seek is not supported.
+ * Async writes compress in place and write through the backend's async handler, async reads decompress in place and
+ * read from the backend synchronously.
+ */
+template <typename Fd, size_t BlockSize>
+class rw_impl<lz4_frame<Fd, BlockSize>> : public rw_impl<Fd> {
+public:
+    rw_impl(bool from_start): rw_impl<Fd>(from_start) {}
+    rw_impl(auto&& init, bool from_start): rw_impl<Fd>(fwd(init).fd, from_start) {}
+
+    rw_impl(rw_impl&&)            = delete;
+    rw_impl& operator=(rw_impl&&) = delete;
+
+    ~rw_impl() {
+        try {
+            finish();
+        }
+        catch (...) {
+        }
+    }
+
+    /* Writes the end mark, the next write starts a new frame */
+    void finish() {
+        if (!header_written)
+            return;
+        write_all(lz4::frame_end_mark, sizeof(lz4::frame_end_mark));
+        header_written = false;
+    }
+
+    constexpr bool is_pipe_like() const {
+        return true;
+    }
+
+protected:
+    size_t handle_write(const void* data, size_t size) {
+        if (!wbuff)
+            wbuff = buffer_t(new u8[4 + BlockSize]);
+
+        if (!header_written) {
+            u8 header[lz4::frame_header_size];
+            lz4::write_frame_header(header, BlockSize);
+            write_all(header, sizeof(header));
+            header_written = true;
+        }
+
+        auto p = static_cast<const u8*>(data);
+        for (size_t off = 0; off < size; off += BlockSize) {
+            auto sz = lz4::write_frame_block(p + off, size - off < BlockSize ? size - off : BlockSize, wbuff.get());
+            write_all(wbuff.get(), sz);
+        }
+        return size;
+    }
+
+    size_t handle_writev(std::span<const iovec> iov) {
+        size_t wrote = 0;
+        for (auto& v : iov)
+            wrote += handle_write(v.iov_base, v.iov_len);
+        return wrote;
+    }
+
+    /* Short only at the end of input */
+    size_t handle_read(void* data, size_t size) {
+        auto p = static_cast<u8*>(data);
+        for (size_t done = 0; done < size;) {
+            if (rpos == rend && !next_block())
+                return done;
+
+            auto sz = rend - rpos < size - done ? rend - rpos : size - done;
+            __builtin_memcpy(p + done, rbuff.get() + rpos, sz);
+            rpos += sz;
+            done += sz;
+        }
+        return size;
+    }
+
+#ifndef DISABLE_ASYNC
+    task<size_t> handle_write_async(const void* data, size_t size) {
+        if (!wbuff)
+            wbuff = buffer_t(new u8[4 + BlockSize]);
+
+        if (!header_written) {
+            u8 header[lz4::frame_header_size];
+            lz4::write_frame_header(header, BlockSize);
+            co_await write_all_async(header, sizeof(header));
+            header_written = true;
+        }
+
+        auto p = static_cast<const u8*>(data);
+        for (size_t off = 0; off < size; off += BlockSize) {
+            auto sz = lz4::write_frame_block(p + off, size - off < BlockSize ? size - off : BlockSize, wbuff.get());
+            co_await write_all_async(wbuff.get(), sz);
+        }
+        co_return size;
+    }
+
+    task<size_t> handle_writev_async(std::span<const iovec> iov) {
+        size_t wrote = 0;
+        for (auto& v : iov)
+            wrote += co_await handle_write_async(v.iov_base, v.iov_len);
+        co_return wrote;
+    }
+
+    task<size_t> handle_read_async(void* data, size_t size) {
+        co_return handle_read(data, size);
+    }
+#endif
+
+    off_t handle_seek(off_t, seek_whence) {
+        throw errc_exception(errc::espipe);
+    }
+
+private:
+    using buffer_t = std::unique_ptr<u8[]>;
+
+    static constexpr size_t history_size = lz4::max_offset;
+
+    void write_all(const u8* data, size_t size) {
+        while (size) {
+            auto wrote = rw_impl<Fd>::handle_write(data, size);
+            if (wrote == 0)
+                throw errc_exception(errc::eio);
+            data += wrote;
+            size -= wrote;
+        }
+    }
+
+#ifndef DISABLE_ASYNC
+    task<> write_all_async(const u8* data, size_t size) {
+        while (size) {
+            auto wrote = co_await rw_impl<Fd>::handle_write_async(data, size);
+            if (wrote == 0)
+                throw errc_exception(errc::eio);
+            data += wrote;
+            size -= wrote;
+        }
+    }
+#endif
+
+    /* false at the end of input before a frame, throws on a truncated or malformed frame */
+    bool read_exact(u8* data, size_t size, bool eof_allowed = false) {
+        for (size_t done = 0; done < size;) {
+            auto read = rw_impl<Fd>::handle_read(data + done, size - done);
+            if (read == 0) {
+                if (done == 0 && eof_allowed)
+                    return false;
+                throw errc_exception(errc::eio);
+            }
+            done += read;
+        }
+        return true;
+    }
+
+    bool read_header() {
+        u8 header[lz4::frame_header_size + 8];
+        if (!read_exact(header, lz4::frame_header_size, true))
+            return false;
+        if (header[4] & 0x08)
+            read_exact(header + lz4::frame_header_size, 8);
+
+        auto info = lz4::read_frame_header(header, sizeof(header));
+        if (!info)
+            throw errc_exception(errc::ebadmsg);
+
+        if (!rbuff || info->block_size > block_size) {
+            block_size = info->block_size;
+            rbuff      = buffer_t(new u8[history_size + block_size]);
+            cbuff      = buffer_t(new u8[block_size]);
+        }
+        frame    = *info;
+        in_frame = true;
+        rpos = rend = history_size;
+        history     = 0;
+        return true;
+    }
+
+    bool next_block() {
+        while (true) {
+            if (!in_frame && !read_header())
+                return false;
+
+            u8 size_le[4];
+            read_exact(size_le, 4);
+            auto block = lz4::dtls::read32_le(size_le);
+            if (block == 0) {
+                if (frame.content_checksum)
+                    read_exact(size_le, 4);
+                in_frame = false;
+                continue;
+            }
+
+            auto sz = size_t(block & 0x7FFFFFFF);
+            if (sz > frame.block_size)
+                throw errc_exception(errc::ebadmsg);
+
+            /* Linked blocks may refer to the last 64 KiB of the previous ones */
+            size_t prefix = 0;
+            if (!frame.independent) {
+                prefix = history < history_size ? history : history_size;
+                __builtin_memmove(rbuff.get() + history_size - prefix, rbuff.get() + rend - prefix, prefix);
+            }
+            auto out = rbuff.get() + history_size;
+
+            if (block & 0x80000000)
+                read_exact(out, sz);
+            else {
+                read_exact(cbuff.get(), sz);
+                auto res = lz4::decompress_block(cbuff.get(), sz, out, frame.block_size, prefix);
+                if (!res)
+                    throw errc_exception(errc::ebadmsg);
+                sz = *res;
+            }
+            if (frame.block_checksum)
+                read_exact(size_le, 4);
+
+            rpos    = history_size;
+            rend    = history_size + sz;
+            history = prefix + sz;
+            if (sz)
+                return true;
+        }
+    }
+
+    buffer_t        wbuff;
+    buffer_t        rbuff;
+    buffer_t        cbuff;
+    lz4::frame_info frame{};
+    size_t          block_size     = 0;
+    size_t          rpos           = 0;
+    size_t          rend           = 0;
+    size_t          history        = 0; /* Valid bytes before rend */
+    bool            header_written = false;
+    bool            in_frame       = false;
+};
+} // namespace core::io
+
+#undef fwd
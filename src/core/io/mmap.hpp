@@ -1,5 +1,7 @@
 #pragma once
 
+#include <utility>
+
 #include <core/io/basic_types.hpp>
 #include <core/io/file.hpp>
 #include <core/meta/overload_resolution.hpp>
@@ -14,6 +16,9 @@
 
 namespace core::io
 {
+using sys::madvise_advice;
+using sys::msync_flag;
+
 namespace details
 {
     template <typename... Args>
@@ -61,7 +66,10 @@ public:
                     if (prot.test(map_prots::write))
                         write_enabled = true;
                 },
-                overload_default<map_flags, sys::map_offset>,
+                [&](map_flags flags) {
+                    _private = flags.test(map_flags::priv);
+                },
+                overload_default<sys::map_offset>,
             });
 
         if (_fd != invalid_fd) {
@@ -106,6 +114,11 @@ public:
         return _fd;
     }
 
+    /* Writes to a private mapping do not reach the file */
+    bool is_private() const {
+        return _private;
+    }
+
     bool valid() const {
         return _data.not_default();
     }
@@ -127,15 +140,37 @@ public:
         _mmap_sz = new_sz;
     }
 
+    /* Range [offset, offset + len) is extended to page boundaries */
+    void advise(madvise_advice advice, size_t offset = 0, size_t len = size_t(-1)) const {
+        auto [p, sz] = page_range(offset, len);
+        sys::madvise(p, sz, advice).throw_if_error();
+    }
+
+    void sync(size_t offset = 0, size_t len = size_t(-1), msync_flag flag = msync_flag::sync) const {
+        auto [p, sz] = page_range(offset, len);
+        sys::msync(p, sz, flag).throw_if_error();
+    }
+
     template <trivial T>
     auto&& from_byteview(this auto&& it, size_t start = 0) {
         return core::from_byteview<T>((char*)it._data.get() + start, std::min(sizeof(T), it._mmap_sz - start));
     }
 
+private:
+    std::pair<void*, size_t> page_range(size_t offset, size_t len) const {
+        auto page = sys::page_size();
+
+        offset   = offset < _mmap_sz ? offset : _mmap_sz;
+        len      = len < _mmap_sz - offset ? len : _mmap_sz - offset;
+        auto beg = offset & ~(page - 1);
+        return {data() + beg, len + offset - beg};
+    }
+
 private:
     Fd                               _fd;
     moveonly_trivial<void*, nullptr> _data    = nullptr;
     size_t                           _mmap_sz = 0;
+    bool                             _private = false;
 };
 
 template <typename... Args>
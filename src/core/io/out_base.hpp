@@ -1,6 +1,7 @@
 #pragma once
 
 #include <core/io/rw_impl.hpp>
+#include <core/io/write_overloads.hpp>
 #include <core/ranges/range.hpp>
 
 #define fwd(...) static_cast<decltype(__VA_ARGS__)>(__VA_ARGS__)
@@ -19,8 +20,11 @@ public:
 };
 
 template <typename Fd, size_t BS = 8192, typename B = rw_impl<Fd>>
-class out_base : public B {
+class out_base : public B, public write_overloads, public write_async_overloads {
 public:
+    using write_overloads::write;
+    using write_async_overloads::write_async;
+
     constexpr out_base(): B(false) {}
     constexpr out_base(auto&& base): B(fwd(base), false) {}
 
@@ -60,28 +64,31 @@ public:
         }
     }
 
-    void write(const trivial auto& data) {
-        write(std::span{&data, 1});
-    }
-
     template <input_range R> requires (!trivial<R> && !trivial_span_like<R>)
     void write(R&& data) {
         for (auto&& v : data)
             write(v);
     }
 
+    /* Pieces that overflow the buffer are written with a single writev: small ones are coalesced in the buffer,
+     * large ones are referenced in place. On partial_write_error the buffer is empty and size is the number
+     * of bytes written from the buffered data and the pieces.
+     */
     void write(const auto& data1, const auto& data2, const auto&... data) {
+        if constexpr (gatherable<decltype(data1), decltype(data2), decltype(data)...>) {
+            const std::span<const u8> pieces[] = {as_bytes(data1), as_bytes(data2), as_bytes(data)...};
+            if (!fits(pieces)) {
+                iovec iov[sizeof...(data) + 3];
+                write_iov(iov, gather(iov, pieces));
+                return;
+            }
+        }
+
         write(data1);
         write(data2);
         (write(data), ...);
     }
 
-    /* XXX: thats can be dangerous... */
-    template <size_t N> requires (N >= 1)
-    void write(const char(&data)[N]) {
-        write(std::span{data, N - 1});
-    }
-
 #ifndef DISABLE_ASYNC
     task<> write_async(const trivial_span_like auto& data) {
         constexpr auto element_size = sizeof(*data.data());
@@ -103,27 +110,39 @@ public:
         }
     }
 
-    auto write_async(const trivial auto& data) {
-        return write_async(std::span{&data, 1});
-    }
-
+    /* Trivial elements are copied straight into the buffer, the task is suspended only to flush it */
     template <input_range R> requires (!trivial<R> && !trivial_span_like<R>)
     task<> write_async(R&& data) {
-        for (auto&& v : data)
-            co_await write_async(v);
+        using value_t = remove_cvref<decltype(*begin(data))>;
+
+        if constexpr (trivial<value_t> && !trivial_span_like<value_t> && sizeof(value_t) <= BS) {
+            for (auto&& v : data) {
+                if (BS - pos < sizeof(v))
+                    co_await flush_async();
+                __builtin_memcpy(buff + pos, &v, sizeof(v));
+                pos += sizeof(v);
+            }
+        }
+        else {
+            for (auto&& v : data)
+                co_await write_async(v);
+        }
     }
 
     task<> write_async(const auto& data1, const auto& data2, const auto&... data) {
+        if constexpr (gatherable<decltype(data1), decltype(data2), decltype(data)...>) {
+            const std::span<const u8> pieces[] = {as_bytes(data1), as_bytes(data2), as_bytes(data)...};
+            if (!fits(pieces)) {
+                iovec iov[sizeof...(data) + 3];
+                co_await write_iov_async(iov, gather(iov, pieces));
+                co_return;
+            }
+        }
+
         co_await write_async(data1);
         co_await write_async(data2);
         (co_await write_async(data), ...);
     }
-
-    /* XXX: thats can be dangerous... */
-    template <size_t N> requires (N >= 1)
-    auto write_async(const char(&data)[N]) {
-        return write_async(std::span{data, N - 1});
-    }
 #endif
 
     void flush() {
@@ -167,6 +186,94 @@ public:
     }
 
 private:
+    static constexpr size_t gather_copy_max = BS / 4;
+
+    template <typename... Ts>
+    static constexpr bool gatherable = ((trivial_span_like<remove_cvref<Ts>> || trivial<remove_cvref<Ts>>) && ...);
+
+    static std::span<const u8> as_bytes(const auto& data) {
+        if constexpr (trivial_span_like<remove_cvref<decltype(data)>>)
+            return {reinterpret_cast<const u8*>(data.data()), data.size() * sizeof(*data.data())};
+        else
+            return {reinterpret_cast<const u8*>(&data), sizeof(data)};
+    }
+
+    template <size_t N>
+    static std::span<const u8> as_bytes(const char (&data)[N]) {
+        return {reinterpret_cast<const u8*>(data), N - 1};
+    }
+
+    bool fits(std::span<const std::span<const u8>> pieces) const {
+        size_t total = 0;
+        for (auto piece : pieces)
+            total += piece.size();
+        return total < BS - pos;
+    }
+
+    /* Buffered data and pieces in order, returns the number of iovecs used (at most pieces.size() + 1) */
+    size_t gather(iovec* iov, std::span<const std::span<const u8>> pieces) {
+        size_t n   = 0;
+        auto   add = [&](const u8* data, size_t size) {
+            if (!size)
+                return;
+            if (n && static_cast<const u8*>(iov[n - 1].iov_base) + iov[n - 1].iov_len == data)
+                iov[n - 1].iov_len += size;
+            else
+                iov[n++] = {const_cast<u8*>(data), size};
+        };
+
+        add(buff, pos);
+        for (auto piece : pieces) {
+            if (piece.size() <= gather_copy_max && BS - pos >= piece.size()) {
+                __builtin_memcpy(buff + pos, piece.data(), piece.size());
+                add(buff + pos, piece.size());
+                pos += piece.size();
+            }
+            else
+                add(piece.data(), piece.size());
+        }
+        pos = 0;
+        return n;
+    }
+
+    /* Drops the first wrote bytes from iov, returns the number of iovecs left */
+    static size_t advance_iov(iovec*& iov, size_t n, size_t wrote) {
+        while (n && wrote >= iov->iov_len) {
+            wrote -= iov->iov_len;
+            ++iov;
+            --n;
+        }
+        if (n) {
+            iov->iov_base = static_cast<u8*>(iov->iov_base) + wrote;
+            iov->iov_len -= wrote;
+        }
+        return n;
+    }
+
+    void write_iov(iovec* iov, size_t n) {
+        size_t total = 0;
+        while (n) {
+            auto wrote = this->handle_writev(std::span<const iovec>{iov, n});
+            if (wrote == 0)
+                throw partial_write_error(total);
+            total += wrote;
+            n = advance_iov(iov, n, wrote);
+        }
+    }
+
+#ifndef DISABLE_ASYNC
+    task<> write_iov_async(iovec* iov, size_t n) {
+        size_t total = 0;
+        while (n) {
+            auto wrote = co_await this->handle_writev_async(std::span<const iovec>{iov, n});
+            if (wrote == 0)
+                throw partial_write_error(total);
+            total += wrote;
+            n = advance_iov(iov, n, wrote);
+        }
+    }
+#endif
+
     void destroy() {
         flush();
     }
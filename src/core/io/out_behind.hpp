@@ -0,0 +1,219 @@
+#pragma once
+
+#ifndef DISABLE_ASYNC
+
+#include <memory>
+
+#include <core/assert.hpp>
+#include <core/async/sys/write.hpp>
+#include <core/io/out_base.hpp>
+
+#define fwd(...) static_cast<decltype(__VA_ARGS__)>(__VA_ARGS__)
+
+namespace core::io
+{
+/* Write-behind async output: N buffers of BS bytes, the filled buffer is submitted without waiting for the write
+ * and the next one is filled meanwhile. The producer waits only when all buffers are busy, so at most (N - 1) * BS
+ * bytes are in flight.
+ * Regular files are written with explicit offsets and may have N - 1 writes in flight, pipes and sockets have
+ * a single write in flight to keep the order. The file position is updated by flush_async().
+ * flush_async() must be awaited before destruction if anything was submitted: destruction with writes in flight
+ * terminates. The data which was not submitted yet is written synchronously by the destructor.
+ * After an error flush_async() completes the remaining writes and drops the unsubmitted data.
+ */
+template <typename Fd, size_t BS = 65536, size_t N = 2, typename B = rw_impl<Fd>>
+    requires(N >= 2 && BS > 0)
+class out_behind : public B, public write_async_overloads {
+public:
+    using write_async_overloads::write_async;
+
+    out_behind(): B(false) {}
+    out_behind(auto&& base): B(fwd(base), false) {}
+
+    ~out_behind() {
+        tbc_r_assert(count == 0 && "out_behind destroyed with writes in flight, flush_async() was not awaited");
+        if (!pos)
+            return;
+        try {
+            if (offset != async::current_pos)
+                this->handle_seek(off_t(offset), sys::seek_whence::set);
+            for (size_t done = 0; done < pos;) {
+                auto wrote = this->handle_write(cur.get() + done, pos - done);
+                if (wrote == 0)
+                    break;
+                done += wrote;
+            }
+        }
+        catch (...) {
+        }
+    }
+
+    out_behind(out_behind&&)            = delete;
+    out_behind& operator=(out_behind&&) = delete;
+
+    static constexpr size_t buffer_capacity() {
+        return BS;
+    }
+
+    static constexpr size_t buffers_count() {
+        return N;
+    }
+
+    constexpr size_t buffer_size() const {
+        return pos;
+    }
+
+    /* Bytes submitted but not completed yet */
+    size_t inflight_size() const {
+        return inflight_bytes;
+    }
+
+    task<> write_async(const trivial_span_like auto& data) {
+        auto   p       = reinterpret_cast<const u8*>(data.data());
+        size_t data_sz = data.size() * sizeof(*data.data());
+
+        while (data_sz) {
+            if (!cur)
+                cur = take_free();
+
+            auto sz = data_sz < BS - pos ? data_sz : BS - pos;
+            __builtin_memcpy(cur.get() + pos, p, sz);
+            pos     += sz;
+            p       += sz;
+            data_sz -= sz;
+
+            if (pos == BS)
+                co_await submit();
+        }
+    }
+
+    template <input_range R> requires (!trivial<R> && !trivial_span_like<R>)
+    task<> write_async(R&& data) {
+        using value_t = remove_cvref<decltype(*begin(data))>;
+
+        if constexpr (trivial<value_t> && !trivial_span_like<value_t> && sizeof(value_t) <= BS) {
+            for (auto&& v : data) {
+                if (BS - pos < sizeof(v))
+                    co_await submit();
+                if (!cur)
+                    cur = take_free();
+                __builtin_memcpy(cur.get() + pos, &v, sizeof(v));
+                pos += sizeof(v);
+            }
+        }
+        else {
+            for (auto&& v : data)
+                co_await write_async(v);
+        }
+    }
+
+    task<> write_async(const auto& data1, const auto& data2, const auto&... data) {
+        co_await write_async(data1);
+        co_await write_async(data2);
+        (co_await write_async(data), ...);
+    }
+
+    /* Submits the current buffer and waits for all writes, the first error is rethrown after all of them complete */
+    task<> flush_async() {
+        std::exception_ptr error;
+        try {
+            co_await submit();
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+
+        while (count) {
+            try {
+                co_await complete_oldest();
+            }
+            catch (...) {
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+
+        if (error) {
+            pos = 0;
+            std::rethrow_exception(error);
+        }
+
+        if (offset != async::current_pos)
+            this->handle_seek(off_t(offset), sys::seek_whence::set);
+    }
+
+private:
+    using buffer_t = std::unique_ptr<u8[]>;
+
+    /* Owns the buffer while it is written, so it outlives an unawaited write */
+    static task<buffer_t> write_buffer(sys::fd_t fd, buffer_t buff, size_t size, u64 off) {
+        size_t done = 0;
+        while (done < size) {
+            auto wrote = (co_await async::pwrite(fd, buff.get() + done, size - done, off == async::current_pos ? off : off + done)).get();
+            if (wrote == 0)
+                throw partial_write_error(done);
+            done += wrote;
+        }
+        co_return buff;
+    }
+
+    buffer_t take_free() {
+        if (free_count)
+            return mov(free_buffs[--free_count]);
+        return buffer_t(new u8[BS]);
+    }
+
+    task<> complete_oldest() {
+        auto& slot = inflight[head];
+        auto  size = sizes[head];
+        head       = (head + 1) % (N - 1);
+        --count;
+        inflight_bytes -= size;
+
+        auto buff                = co_await slot;
+        free_buffs[free_count++] = mov(buff);
+    }
+
+    task<> submit() {
+        if (!pos)
+            co_return;
+
+        if (!started) {
+            pipe_like = this->is_pipe_like();
+            offset    = pipe_like ? async::current_pos : u64(this->handle_seek(0, sys::seek_whence::cur));
+            started   = true;
+        }
+
+        auto max_inflight = pipe_like ? size_t(1) : N - 1;
+        while (count >= max_inflight)
+            co_await complete_oldest();
+
+        auto tail       = (head + count) % (N - 1);
+        inflight[tail]  = write_buffer(this->fd(), mov(cur), pos, offset);
+        sizes[tail]     = pos;
+        inflight_bytes += pos;
+        ++count;
+
+        if (offset != async::current_pos)
+            offset += pos;
+        pos = 0;
+    }
+
+    buffer_t       cur;
+    size_t         pos = 0;
+    buffer_t       free_buffs[N];
+    size_t         free_count = 0;
+    task<buffer_t> inflight[N - 1];
+    size_t         sizes[N - 1]{};
+    size_t         head           = 0;
+    size_t         count          = 0;
+    size_t         inflight_bytes = 0;
+    u64            offset         = async::current_pos;
+    bool           pipe_like      = false;
+    bool           started        = false;
+};
+} // namespace core::io
+
+#undef fwd
+
+#endif
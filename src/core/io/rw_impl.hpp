@@ -1,10 +1,12 @@
 #pragma once
 
 #include <atomic>
+#include <span>
 #include <core/concepts/trivial_span_like.hpp>
 #include <core/errc.hpp>
 #include <core/io/basic_types.hpp>
 #include <core/io/file.hpp>
+#include <core/io/mmap.hpp>
 #include <core/opt.hpp>
 #include <core/traits/is_ref.hpp>
 #include <sys/lseek.hpp>
@@ -49,6 +51,13 @@ protected:
         return size;
     }
 
+    constexpr size_t handle_writev(std::span<const iovec> iov) {
+        size_t wrote = 0;
+        for (auto& v : iov)
+            wrote += handle_write(v.iov_base, v.iov_len);
+        return wrote;
+    }
+
     constexpr size_t handle_read(void* data, size_t size) {
         auto sz = avail();
         if (sz > size)
@@ -63,6 +72,10 @@ protected:
         co_return handle_write(data, size);
     }
 
+    task<size_t> handle_writev_async(std::span<const iovec> iov) {
+        co_return handle_writev(iov);
+    }
+
     task<size_t> handle_read_async(void* data, size_t size) {
         co_return handle_read(data, size);
     }
@@ -118,11 +131,25 @@ public:
         }
     }
 
+    /* Queried once with statx */
+    sys::file_type fd_type() const {
+        auto file_type = _file_type.load(std::memory_order_relaxed);
+        if (!file_type) {
+            file_type = sys::statx(_fd, sys::statx_mask::mode).get().mode.type();
+            _file_type.store(file_type, std::memory_order_relaxed);
+        }
+        return *file_type;
+    }
+
 protected:
     size_t handle_write(const void* data, size_t size) {
         return sys::write(_fd, data, size).get();
     }
 
+    size_t handle_writev(std::span<const iovec> iov) {
+        return sys::writev(_fd, iov).get();
+    }
+
     size_t handle_read(void* data, size_t size) {
         auto res = sys::read(_fd, data, size);
         if (!is_pipe_like() || res)
@@ -136,6 +163,10 @@ protected:
         co_return (co_await async::write(_fd, data, size)).get();
     }
 
+    task<size_t> handle_writev_async(std::span<const iovec> iov) {
+        co_return (co_await async::writev(_fd, iov)).get();
+    }
+
     task<size_t> handle_read_async(void* data, size_t size) {
         auto res = co_await async::read(_fd, data, size);
         if (!is_pipe_like() || res) {
@@ -150,18 +181,157 @@ protected:
         return sys::lseek(_fd, offset, whence).get();
     }
 
-    sys::file_type fd_type() const {
-        auto file_type = _file_type.load(std::memory_order_relaxed);
-        if (!file_type) {
-            file_type = sys::statx(_fd, sys::statx_mask::mode).get().mode.type();
-            _file_type.store(file_type, std::memory_order_relaxed);
+private:
+    T                                              _fd;
+    mutable std::atomic<core::opt<sys::file_type>> _file_type;
+};
+
+/* Mapped file as a backend: reads are served from the mapping, writes past the end grow it with mremap
+ * (and ftruncate for file mappings). Readers and writers start at the beginning of the mapping. The mapping grows
+ * by doubling, a writer truncates it (and the file) to the written size on destruction, so the preallocated size
+ * is only a hint. Use a zero-sized in/out buffer (size_c<0>) to keep read_view() and the stream positions in sync.
+ * Writers over a private file mapping are rejected with einval: the data would not reach the file but the file
+ * would still be truncated.
+ */
+template <typename Fd>
+class rw_impl<mmap<Fd>> {
+public:
+    rw_impl(bool) {}
+    rw_impl(auto&& init, bool from_start): _map(fwd(init)), end(from_start ? _map.size() : 0), writer(!from_start) {
+        if (writer && _map.fd() != invalid_fd && _map.is_private())
+            throw errc_exception(errc::einval);
+    }
+
+    rw_impl(rw_impl&&)            = default;
+    rw_impl& operator=(rw_impl&&) = default;
+
+    ~rw_impl() {
+        if (writer && _map.valid() && end < _map.size()) {
+            try {
+                shrink_to_end();
+            }
+            catch (...) {
+            }
         }
-        return *file_type;
+    }
+
+    auto&& base_buff(this auto&& it) {
+        return fwd(it)._map;
+    }
+
+    constexpr bool is_pipe_like() const {
+        return false;
+    }
+
+    size_t avail() const {
+        return end - pos;
+    }
+
+    /* Returns up to size bytes from the current position without a copy and advances it */
+    std::span<const u8> read_view(size_t size) {
+        auto sz = avail() < size ? avail() : size;
+        auto p  = _map.template data<const u8>() + pos;
+        pos += sz;
+        return {p, sz};
+    }
+
+    /* Random access without a copy, the position is not changed */
+    std::span<const u8> view(size_t offset, size_t size) const {
+        offset = offset < end ? offset : end;
+        return {_map.template data<const u8>() + offset, end - offset < size ? end - offset : size};
+    }
+
+    void advise(madvise_advice advice, size_t offset = 0, size_t len = size_t(-1)) const {
+        _map.advise(advice, offset, len);
+    }
+
+    void sync(size_t offset = 0, size_t len = size_t(-1), msync_flag flag = msync_flag::sync) const {
+        _map.sync(offset, len, flag);
+    }
+
+protected:
+    size_t handle_write(const void* data, size_t size) {
+        if (pos + size > _map.size())
+            grow(pos + size);
+
+        __builtin_memcpy(_map.template data<u8>() + pos, data, size);
+        pos += size;
+        if (pos > end)
+            end = pos;
+        return size;
+    }
+
+    size_t handle_writev(std::span<const iovec> iov) {
+        size_t wrote = 0;
+        for (auto& v : iov)
+            wrote += handle_write(v.iov_base, v.iov_len);
+        return wrote;
+    }
+
+    size_t handle_read(void* data, size_t size) {
+        auto view = read_view(size);
+        __builtin_memcpy(data, view.data(), view.size());
+        return view.size();
+    }
+
+#ifndef DISABLE_ASYNC
+    task<size_t> handle_write_async(const void* data, size_t size) {
+        co_return handle_write(data, size);
+    }
+
+    task<size_t> handle_writev_async(std::span<const iovec> iov) {
+        co_return handle_writev(iov);
+    }
+
+    task<size_t> handle_read_async(void* data, size_t size) {
+        co_return handle_read(data, size);
+    }
+#endif
+
+    off_t handle_seek(off_t offset, seek_whence whence) {
+        auto new_pos = off_t(pos);
+        switch (whence) {
+        case seek_whence::cur: new_pos = off_t(pos) + offset; break;
+        case seek_whence::set: new_pos = offset; break;
+        case seek_whence::end: new_pos = off_t(end) + offset; break;
+        }
+
+        if (new_pos < 0)
+            new_pos = 0;
+        else if (size_t(new_pos) > end)
+            new_pos = off_t(end);
+
+        return off_t(pos = size_t(new_pos));
     }
 
 private:
-    T                                              _fd;
-    mutable std::atomic<core::opt<sys::file_type>> _file_type;
+    void grow(size_t min_size) {
+        auto new_size = _map.size() * 2;
+        if (new_size < min_size)
+            new_size = min_size;
+
+        if (_map.fd() != invalid_fd)
+            _map.truncate(new_size);
+        else
+            _map.remap(new_size);
+    }
+
+    /* A mapping can not be empty, only the file is truncated when nothing was written */
+    void shrink_to_end() {
+        if (end == 0) {
+            if (_map.fd() != invalid_fd)
+                sys::ftruncate(_map.fd(), 0).throw_if_error();
+        }
+        else if (_map.fd() != invalid_fd)
+            _map.truncate(end);
+        else
+            _map.remap(end);
+    }
+
+    mmap<Fd> _map;
+    size_t   pos    = 0;
+    size_t   end    = 0;
+    bool     writer = false;
 };
 } // namespace core::io
 
@@ -1,7 +1,5 @@
 #pragma once
 #include <liburing.h>
-#include <set>
-#include <unordered_map>
 
 #include <sys/close.hpp>
 #include <sys/eventfd.hpp>
@@ -13,6 +11,8 @@
 #include <core/async/cancelation_point.hpp>
 #include <core/async/coro_handle_metainfo.hpp>
 #include <core/errc_exception.hpp>
+#include <core/intrusive_hash_set.hpp>
+#include <core/intrusive_list.hpp>
 #include <core/io/uring/structs.hpp>
 #include <core/moveonly_trivial.hpp>
 #include <core/opt.hpp>
@@ -52,28 +52,37 @@ auto make_uring_awaitable(auto&& suspend_handler, async_task_type task_type = as
 
 class ctx {
 public:
-    struct thread_task {
-        thread_task(sys::fd_t fd, uring_awaitable* iawaitable): eventfd(fd), awaitable(iawaitable) {}
+    /* Operation which runs in another thread and signals completion through eventfd
+     * Lives in the frame of the awaiting coroutine and stays linked into ctx until completion
+     */
+    struct thread_task : intrusive_hash_set_hook<> {
+        thread_task() = default;
 
         ~thread_task() {
+            if (owner)
+                owner->thread_tasks.erase(*this);
             if (eventfd.not_default()) {
                 sys::close(eventfd).throw_if_error();
             }
         }
 
-        thread_task(thread_task&&) = default;
-        thread_task& operator=(thread_task&& rhs) noexcept {
-            if (eventfd.not_default()) {
-                sys::close(eventfd).throw_if_error();
-            }
-            eventfd   = mov(rhs.eventfd);
-            awaitable = rhs.awaitable;
+        thread_task(const thread_task&)            = delete;
+        thread_task& operator=(const thread_task&) = delete;
 
-            return *this;
+        sys::fd_t key() const {
+            return eventfd;
         }
 
         moveonly_trivial<sys::fd_t, sys::invalid_fd> eventfd;
-        uring_awaitable*                             awaitable;
+        uring_awaitable*                             awaitable = nullptr;
+        ctx*                                         owner     = nullptr;
+    };
+
+    /* Signalfd pipe of a child context, lives in the frame of the spawning coroutine */
+    struct child_signalfd_pipe : intrusive_list_hook<> {
+        child_signalfd_pipe(sys::pipe_result ipipe): pipe(ipipe) {}
+
+        sys::pipe_result pipe;
     };
 
     explicit ctx(unsigned entries, setup_flags flags = {}): ring(init) {
@@ -104,11 +113,11 @@ public:
             auto [awaitable, type] = async::unpack_awaitable(cqe->user_data);
 
             if (type == async::awaitable_type::uring_threaded) {
-                auto  efd       = sys::fd_t(cqe->user_data);
-                auto  task_it   = thread_tasks.find(efd);
-                auto* awaitable = task_it->second.awaitable;
-                awaitable->resume(cqe->res);
-                thread_tasks.erase(task_it);
+                auto efd = sys::fd_t(cqe->user_data);
+                if (auto finished = thread_tasks.extract(efd)) {
+                    finished->owner = nullptr;
+                    finished->awaitable->resume(cqe->res);
+                }
             } else {
                 auto* awaitable = (uring_awaitable*)(cqe->user_data);
                 // glog().debug("resume {x}", (u64)awaitable);
@@ -149,12 +158,15 @@ public:
         return ring ? &*ring : nullptr;
     }
 
-    void schedule_thread_task(uring_awaitable& awaitable, auto&& launcher) {
+    void schedule_thread_task(thread_task& task, uring_awaitable& awaitable, auto&& launcher) {
         auto& sqe = get_sqe();
         auto efd = sys::eventfd(0, sys::eventfd_flags::nonblock).get();
         io_uring_prep_poll_add(&sqe, int(efd), unsigned(sys::poll_event::in));
         io_uring_sqe_set_data64(&sqe, async::pack_awaitable(u64(efd), async::awaitable_type::uring_threaded));
-        thread_tasks.emplace(efd, thread_task{efd, &awaitable});
+        task.eventfd   = efd;
+        task.awaitable = &awaitable;
+        task.owner     = this;
+        thread_tasks.insert(task);
         io_uring_submit(get_ring());
         launcher(efd);
     }
@@ -163,12 +175,12 @@ public:
         return _child_signalfd_pipes;
     }
 
-    void add_child_signalfd_pipe(sys::pipe_result pipe) {
-        _child_signalfd_pipes.emplace(pipe);
+    void add_child_signalfd_pipe(child_signalfd_pipe& pipe) {
+        _child_signalfd_pipes.push_back(pipe);
     }
 
-    void remove_child_signalfd_pipe(sys::pipe_result pipe) {
-        _child_signalfd_pipes.emplace(pipe);
+    void remove_child_signalfd_pipe(child_signalfd_pipe& pipe) {
+        _child_signalfd_pipes.erase(pipe);
     }
 
     sys::fd_t ensure_internal_kill_event() {
@@ -216,8 +228,8 @@ private:
     sys::fd_t     _internal_kill_event  = sys::invalid_fd;
     sys::fd_t     _kill_event_recipient = sys::invalid_fd;
 
-    std::unordered_map<sys::fd_t, thread_task> thread_tasks;
-    std::set<sys::pipe_result>                 _child_signalfd_pipes;
+    intrusive_hash_set<thread_task>     thread_tasks;
+    intrusive_list<child_signalfd_pipe> _child_signalfd_pipes;
 };
 
 inline thread_local ctx* current_ctx = nullptr;
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <span>
+
+#include <core/concepts/trivial.hpp>
+
+namespace core::io
+{
+/* Overloads shared by the writers, the derived class provides write(trivial_span_like) and brings these in with
+ * using write_overloads::write
+ * char arrays are written without the last char which is the terminating zero of a string literal.
+ * XXX: thats can be dangerous for arrays which are not literals...
+ */
+struct write_overloads {
+    auto write(this auto&& it, const trivial auto& data) {
+        return it.write(std::span{&data, 1});
+    }
+
+    template <size_t N> requires (N >= 1)
+    auto write(this auto&& it, const char(&data)[N]) {
+        return it.write(std::span{data, N - 1});
+    }
+};
+
+/* Same as write_overloads for write_async(trivial_span_like) */
+struct write_async_overloads {
+    auto write_async(this auto&& it, const trivial auto& data) {
+        return it.write_async(std::span{&data, 1});
+    }
+
+    template <size_t N> requires (N >= 1)
+    auto write_async(this auto&& it, const char(&data)[N]) {
+        return it.write_async(std::span{data, N - 1});
+    }
+};
+} // namespace core::io
@@ -0,0 +1,404 @@
+#pragma once
+
+#include <vector>
+
+#include <core/basic_types.hpp>
+#include <core/bits.hpp>
+#include <core/concepts/trivial_span_like.hpp>
+#include <core/opt.hpp>
+
+/* LZ4 block and frame format codec
+ * Blocks are compressed with the single pass hash table matcher of the reference "fast" mode, frames are written
+ * with independent blocks and without checksums (the header checksum is always set) and are readable by lz4(1).
+ */
+namespace core::lz4
+{
+inline constexpr u32    frame_magic    = 0x184D2204;
+inline constexpr size_t min_match      = 4;
+inline constexpr size_t last_literals  = 5;  /* The last 5 bytes are always literals */
+inline constexpr size_t mf_limit       = 12; /* The last match starts at least 12 bytes before the end */
+inline constexpr size_t max_offset     = 65535;
+inline constexpr size_t max_block_size = size_t(4) << 20;
+
+namespace dtls {
+    inline u32 read32(const u8* p) {
+        u32 v;
+        __builtin_memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline u64 read64(const u8* p) {
+        u64 v;
+        __builtin_memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline u32 read32_le(const u8* p) {
+        return u32(p[0]) | u32(p[1]) << 8 | u32(p[2]) << 16 | u32(p[3]) << 24;
+    }
+
+    inline void write32_le(u8* p, u32 v) {
+        p[0] = u8(v);
+        p[1] = u8(v >> 8);
+        p[2] = u8(v >> 16);
+        p[3] = u8(v >> 24);
+    }
+
+    /* Number of equal leading bytes of two different words */
+    inline size_t common_bytes(u64 diff) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        return size_t(__builtin_clzll(diff)) >> 3;
+#else
+        return size_t(__builtin_ctzll(diff)) >> 3;
+#endif
+    }
+
+    inline u8* write_length(u8* op, size_t len) {
+        for (; len >= 255; len -= 255)
+            *op++ = 255;
+        *op++ = u8(len);
+        return op;
+    }
+
+    /* Only for the frame header checksum */
+    inline u32 xxh32(const u8* p, size_t size, u32 seed) {
+        constexpr u32 p1 = 2654435761U, p2 = 2246822519U, p3 = 3266489917U, p4 = 668265263U, p5 = 374761393U;
+
+        auto end = p + size;
+        u32  h;
+        if (size >= 16) {
+            u32 v[4] = {seed + p1 + p2, seed + p2, seed, seed - p1};
+            for (; end - p >= 16; p += 16)
+                for (int i = 0; i < 4; ++i)
+                    v[i] = rotl(v[i] + read32_le(p + i * 4) * p2, 13) * p1;
+            h = rotl(v[0], 1) + rotl(v[1], 7) + rotl(v[2], 12) + rotl(v[3], 18);
+        }
+        else
+            h = seed + p5;
+
+        h += u32(size);
+        for (; end - p >= 4; p += 4)
+            h = rotl(h + read32_le(p) * p3, 17) * p4;
+        for (; p != end; ++p)
+            h = rotl(h + *p * p5, 11) * p1;
+
+        h ^= h >> 15;
+        h *= p2;
+        h ^= h >> 13;
+        h *= p3;
+        h ^= h >> 16;
+        return h;
+    }
+} // namespace dtls
+
+inline constexpr size_t compress_bound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+/* Returns the compressed size or 0 if it does not fit to capacity; compress_bound(size) always fits */
+inline size_t compress_block(const void* input, size_t size, void* output, size_t capacity) {
+    using namespace dtls;
+
+    constexpr int    hash_log     = 12;
+    constexpr size_t skip_trigger = 6;
+
+    auto src    = static_cast<const u8*>(input);
+    auto ip     = src;
+    auto anchor = src;
+    auto iend   = src + size;
+    auto dst    = static_cast<u8*>(output);
+    auto op     = dst;
+    auto oend   = dst + capacity;
+
+    auto hash = [](u32 seq) {
+        return (seq * 2654435761U) >> (32 - hash_log);
+    };
+
+    if (size > mf_limit) {
+        u32  table[1 << hash_log] = {};
+        auto mflimit              = iend - mf_limit;
+        auto match_limit          = iend - last_literals;
+
+        ++ip;
+        while (true) {
+            const u8* match;
+            size_t    attempts = size_t(1) << skip_trigger;
+
+            /* Steps grow on incompressible data */
+            while (true) {
+                if (ip > mflimit)
+                    goto last;
+
+                auto h   = hash(read32(ip));
+                match    = src + table[h];
+                table[h] = u32(ip - src);
+                if (match < ip && size_t(ip - match) <= max_offset && read32(match) == read32(ip))
+                    break;
+                ip += attempts++ >> skip_trigger;
+            }
+
+            while (ip > anchor && match > src && ip[-1] == match[-1]) {
+                --ip;
+                --match;
+            }
+
+            auto mp = ip + min_match;
+            auto mm = match + min_match;
+            while (mp + 8 <= match_limit) {
+                if (auto diff = read64(mp) ^ read64(mm)) {
+                    mp += common_bytes(diff);
+                    goto match_end;
+                }
+                mp += 8;
+                mm += 8;
+            }
+            while (mp < match_limit && *mp == *mm) {
+                ++mp;
+                ++mm;
+            }
+        match_end:
+            auto lit  = size_t(ip - anchor);
+            auto mlen = size_t(mp - ip) - min_match;
+            if (size_t(oend - op) < 1 + lit / 255 + 1 + lit + 2 + mlen / 255 + 1 + 1 + last_literals)
+                return 0;
+
+            auto token = op++;
+            if (lit >= 15) {
+                *token = 15 << 4;
+                op     = write_length(op, lit - 15);
+            }
+            else
+                *token = u8(lit << 4);
+            __builtin_memcpy(op, anchor, lit);
+            op += lit;
+
+            auto offset = size_t(ip - match);
+            *op++       = u8(offset);
+            *op++       = u8(offset >> 8);
+
+            if (mlen >= 15) {
+                *token |= 15;
+                op      = write_length(op, mlen - 15);
+            }
+            else
+                *token |= u8(mlen);
+
+            ip     = mp;
+            anchor = ip;
+            if (ip > mflimit)
+                break;
+            table[hash(read32(ip - 2))] = u32(ip - 2 - src);
+        }
+    }
+
+last:
+    auto lit = size_t(iend - anchor);
+    if (size_t(oend - op) < 1 + lit / 255 + 1 + lit)
+        return 0;
+
+    if (lit >= 15) {
+        *op++ = 15 << 4;
+        op    = write_length(op, lit - 15);
+    }
+    else
+        *op++ = u8(lit << 4);
+    if (lit)
+        __builtin_memcpy(op, anchor, lit);
+    op += lit;
+
+    return size_t(op - dst);
+}
+
+/* Returns the decompressed size or null if the input is malformed or does not fit to capacity
+ * prefix bytes before output are valid data which matches may refer to (the previous blocks of a linked frame).
+ */
+inline opt<size_t> decompress_block(const void* input, size_t size, void* output, size_t capacity, size_t prefix = 0) {
+    auto ip   = static_cast<const u8*>(input);
+    auto iend = ip + size;
+    auto dst  = static_cast<u8*>(output);
+    auto op   = dst;
+    auto oend = dst + capacity;
+
+    auto read_length = [&](size_t& len) {
+        u8 b;
+        do {
+            if (ip == iend)
+                return false;
+            b    = *ip++;
+            len += b;
+        } while (b == 255);
+        return true;
+    };
+
+    while (ip != iend) {
+        auto   token = *ip++;
+        size_t lit   = token >> 4;
+        if (lit == 15 && !read_length(lit))
+            return null;
+        if (lit > size_t(iend - ip) || lit > size_t(oend - op))
+            return null;
+        /* Short copies by 16 bytes when both sides have slack */
+        if (lit <= 32 && size_t(iend - ip) >= 32 + 2 && size_t(oend - op) >= 32) {
+            __builtin_memcpy(op, ip, 16);
+            __builtin_memcpy(op + 16, ip + 16, 16);
+        }
+        else
+            __builtin_memcpy(op, ip, lit);
+        op += lit;
+        ip += lit;
+
+        /* The last sequence has no match */
+        if (ip == iend)
+            break;
+
+        if (iend - ip < 2)
+            return null;
+        auto offset = size_t(ip[0]) | size_t(ip[1]) << 8;
+        ip += 2;
+
+        size_t mlen = token & 15;
+        if (mlen == 15 && !read_length(mlen))
+            return null;
+        mlen += min_match;
+
+        if (offset == 0 || offset > size_t(op - dst) + prefix || mlen > size_t(oend - op))
+            return null;
+
+        auto match = op - offset;
+        if (offset >= 8 && size_t(oend - op) >= mlen + 8) {
+            for (size_t i = 0; i < mlen; i += 8)
+                __builtin_memcpy(op + i, match + i, 8);
+        }
+        else
+            for (size_t i = 0; i < mlen; ++i)
+                op[i] = match[i];
+        op += mlen;
+    }
+
+    return size_t(op - dst);
+}
+
+/* Block max size code of the frame descriptor: 4 - 64 KiB, 5 - 256 KiB, 6 - 1 MiB, 7 - 4 MiB */
+inline constexpr u8 block_size_code(size_t block_size) {
+    return block_size <= (size_t(64) << 10) ? 4 : block_size <= (size_t(256) << 10) ? 5 : block_size <= (size_t(1) << 20) ? 6 : 7;
+}
+
+inline constexpr size_t block_size_by_code(u8 code) {
+    return size_t(1) << (8 + code * 2);
+}
+
+inline constexpr size_t frame_header_size = 7;
+
+inline void write_frame_header(u8* out, size_t block_size) {
+    dtls::write32_le(out, frame_magic);
+    out[4] = 0x60; /* Version 01, independent blocks */
+    out[5] = u8(block_size_code(block_size) << 4);
+    out[6] = u8(dtls::xxh32(out + 4, 2, 0) >> 8);
+}
+
+/* Writes one block of the frame: 4 bytes of size and the data, stored as is if it does not compress
+ * out must have 4 + size bytes available.
+ */
+inline size_t write_frame_block(const void* data, size_t size, u8* out) {
+    auto sz = compress_block(data, size, out + 4, size);
+    if (sz == 0 || sz >= size) {
+        __builtin_memcpy(out + 4, data, size);
+        dtls::write32_le(out, u32(size) | 0x80000000);
+        return size + 4;
+    }
+    dtls::write32_le(out, u32(sz));
+    return sz + 4;
+}
+
+inline constexpr u8 frame_end_mark[4] = {};
+
+/* Whole frame in memory, e.g. compress_frame(to_bytes(value)) */
+inline std::vector<char> compress_frame(const trivial_span_like auto& data, size_t block_size = size_t(64) << 10) {
+    auto p    = reinterpret_cast<const u8*>(data.data());
+    auto size = data.size() * sizeof(*data.data());
+
+    std::vector<char> result(frame_header_size + size + (size / block_size + 1) * 4 + 4);
+    auto              out = reinterpret_cast<u8*>(result.data());
+    write_frame_header(out, block_size);
+
+    size_t pos = frame_header_size;
+    for (size_t off = 0; off < size; off += block_size)
+        pos += write_frame_block(p + off, size - off < block_size ? size - off : block_size, out + pos);
+
+    __builtin_memcpy(out + pos, frame_end_mark, 4);
+    result.resize(pos + 4);
+    return result;
+}
+
+struct frame_info {
+    size_t header_size;
+    size_t block_size;
+    bool   independent;
+    bool   block_checksum;
+    bool   content_checksum;
+};
+
+/* Parses the frame header, null if it is malformed, truncated or uses a dictionary */
+inline opt<frame_info> read_frame_header(const u8* p, size_t size) {
+    if (size < frame_header_size || dtls::read32_le(p) != frame_magic)
+        return null;
+
+    auto flg = p[4];
+    auto bd  = p[5];
+    if ((flg >> 6) != 1 || (flg & 0x03) || (bd & 0x8F) || ((bd >> 4) & 7) < 4)
+        return null;
+
+    frame_info info{
+        .header_size      = frame_header_size + ((flg & 0x08) ? 8 : 0),
+        .block_size       = block_size_by_code((bd >> 4) & 7),
+        .independent      = bool(flg & 0x20),
+        .block_checksum   = bool(flg & 0x10),
+        .content_checksum = bool(flg & 0x04),
+    };
+
+    if (size < info.header_size || p[info.header_size - 1] != u8(dtls::xxh32(p + 4, info.header_size - 5, 0) >> 8))
+        return null;
+    return info;
+}
+
+/* Whole frame in memory, null if it is malformed; checksums are skipped, not verified */
+inline opt<std::vector<char>> decompress_frame(const trivial_span_like auto& data) {
+    auto p    = reinterpret_cast<const u8*>(data.data());
+    auto size = data.size() * sizeof(*data.data());
+
+    auto info = read_frame_header(p, size);
+    if (!info)
+        return null;
+
+    std::vector<char> result;
+    size_t            pos = info->header_size;
+    while (true) {
+        if (size - pos < 4)
+            return null;
+        auto block = dtls::read32_le(p + pos);
+        pos += 4;
+        if (block == 0)
+            break;
+
+        auto sz = size_t(block & 0x7FFFFFFF);
+        if (sz > info->block_size || size - pos < sz + (info->block_checksum ? 4 : 0))
+            return null;
+
+        auto prev = result.size();
+        result.resize(prev + info->block_size);
+        auto out = reinterpret_cast<u8*>(result.data()) + prev;
+        if (block & 0x80000000) {
+            __builtin_memcpy(out, p + pos, sz);
+            result.resize(prev + sz);
+        }
+        else {
+            auto res = decompress_block(p + pos, sz, out, info->block_size, info->independent ? 0 : prev);
+            if (!res)
+                return null;
+            result.resize(prev + *res);
+        }
+        pos += sz + (info->block_checksum ? 4 : 0);
+    }
+    return result;
+}
+} // namespace core::lz4
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <new>
+
+#include <core/basic_types.hpp>
+#include <core/spsc_ring.hpp>
+
+#define fwd(...) static_cast<decltype(__VA_ARGS__)>(__VA_ARGS__)
+
+namespace core {
+/* Lock-free bounded multi-producer multi-consumer ring (D. Vyukov's algorithm)
+ * Capacity is rounded up to a power of two.
+ * Batch operations are not atomic: they push/pop values one by one until the ring is full/empty.
+ * If Waitable is true push()/pop() block on futex while the ring is full/empty.
+ */
+template <typename T, bool Waitable = false>
+class mpmc_ring {
+    struct cell {
+        std::atomic<u32> seq;
+        alignas(T) char  storage[sizeof(T)];
+
+        T* value() noexcept {
+            return reinterpret_cast<T*>(storage);
+        }
+    };
+
+public:
+    explicit mpmc_ring(u32 capacity): _mask(dtls::ring_capacity(capacity) - 1), _cells(new cell[_mask + 1]) {
+        for (u32 i = 0; i <= _mask; ++i)
+            _cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    ~mpmc_ring() {
+        for (auto i = _dequeue_pos.load(std::memory_order_relaxed), e = _enqueue_pos.load(std::memory_order_relaxed); i != e; ++i)
+            _cells[i & _mask].value()->~T();
+        delete[] _cells;
+    }
+
+    mpmc_ring(const mpmc_ring&)            = delete;
+    mpmc_ring& operator=(const mpmc_ring&) = delete;
+
+    bool try_push(auto&& value) {
+        return try_emplace(fwd(value));
+    }
+
+    bool try_emplace(auto&&... args) {
+        auto  pos = _enqueue_pos.load(std::memory_order_relaxed);
+        cell* c;
+        while (true) {
+            c         = _cells + (pos & _mask);
+            auto diff = i32(c->seq.load(std::memory_order_acquire) - pos);
+            if (diff == 0) {
+                if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+        }
+
+        ::new (c->value()) T(fwd(args)...);
+        c->seq.store(pos + 1, std::memory_order_release);
+        if constexpr (Waitable)
+            _not_empty.notify_one();
+        return true;
+    }
+
+    /* Copies up to count values, returns number of pushed values */
+    size_t try_push(const T* values, size_t count) {
+        size_t n = 0;
+        while (n < count && try_push(values[n]))
+            ++n;
+        return n;
+    }
+
+    bool try_pop(T& output) {
+        auto  pos = _dequeue_pos.load(std::memory_order_relaxed);
+        cell* c;
+        while (true) {
+            c         = _cells + (pos & _mask);
+            auto diff = i32(c->seq.load(std::memory_order_acquire) - (pos + 1));
+            if (diff == 0) {
+                if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = _dequeue_pos.load(std::memory_order_relaxed);
+        }
+
+        output = mov(*c->value());
+        c->value()->~T();
+        c->seq.store(pos + _mask + 1, std::memory_order_release);
+        if constexpr (Waitable)
+            _not_full.notify_one();
+        return true;
+    }
+
+    /* Moves up to max values to output, returns number of popped values */
+    size_t try_pop(T* output, size_t max) {
+        size_t n = 0;
+        while (n < max && try_pop(output[n]))
+            ++n;
+        return n;
+    }
+
+    void push(auto&& value) requires Waitable {
+        while (!try_push(fwd(value))) {
+            auto key = _not_full.prepare_wait();
+            if (try_push(fwd(value))) {
+                _not_full.cancel_wait();
+                return;
+            }
+            _not_full.wait(key);
+        }
+    }
+
+    T pop() requires Waitable {
+        T result;
+        while (!try_pop(result)) {
+            auto key = _not_empty.prepare_wait();
+            if (try_pop(result)) {
+                _not_empty.cancel_wait();
+                break;
+            }
+            _not_empty.wait(key);
+        }
+        return result;
+    }
+
+    /* Blocks until at least one value is popped */
+    size_t pop(T* output, size_t max) requires Waitable {
+        if (max == 0)
+            return 0;
+        output[0] = pop();
+        return 1 + try_pop(output + 1, max - 1);
+    }
+
+    /* Approximate if called concurrently with push or pop */
+    [[nodiscard]]
+    size_t size() const noexcept {
+        auto diff = i32(_enqueue_pos.load(std::memory_order_acquire) - _dequeue_pos.load(std::memory_order_acquire));
+        return diff < 0 ? 0 : size_t(diff);
+    }
+
+    [[nodiscard]]
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    [[nodiscard]]
+    size_t capacity() const noexcept {
+        return _mask + 1;
+    }
+
+private:
+    struct empty_t {};
+    using event_t = conditional<Waitable, event_count, empty_t>;
+
+    /* Events are placed next to the position of the notifying side */
+    alignas(cache_line_size) std::atomic<u32> _enqueue_pos = 0;
+    [[no_unique_address]] event_t             _not_empty;
+
+    alignas(cache_line_size) std::atomic<u32> _dequeue_pos = 0;
+    [[no_unique_address]] event_t             _not_full;
+
+    alignas(cache_line_size) u32 _mask;
+    cell*                        _cells;
+};
+} // namespace core
+
+#undef fwd
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <charconv>
+#include <span>
+#include <vector>
+
+#include <core/array.hpp>
+#include <core/basic_types.hpp>
+#include <core/concepts/number.hpp>
+#include <core/find_delim.hpp>
+#include <core/limits.hpp>
+
+namespace core {
+struct parse_many_error {
+    size_t    pos; /* Offset of the field in the input */
+    std::errc ec;
+};
+
+struct parse_many_result {
+    size_t                        count = 0; /* Values written to out */
+    std::vector<parse_many_error> errors;
+
+    explicit operator bool() const {
+        return errors.empty();
+    }
+};
+
+inline constexpr array<char, 5> parse_many_default_delims{',', ' ', '\t', '\n', '\r'};
+
+namespace dtls {
+    inline u64 load_8chars(const char* p) {
+        u64 v;
+        __builtin_memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        v = __builtin_bswap64(v);
+#endif
+        return v;
+    }
+
+    inline bool is_8digits(u64 v) {
+        return ((v & 0xF0F0F0F0F0F0F0F0) | (((v + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333;
+    }
+
+    /* SWAR: 8 ascii digits to a number with 3 multiplications */
+    inline u32 parse_8digits(u64 v) {
+        constexpr u64 mask = 0x000000FF000000FF;
+        constexpr u64 mul1 = 100 + (u64(1000000) << 32);
+        constexpr u64 mul2 = 1 + (u64(10000) << 32);
+
+        v -= 0x3030303030303030;
+        v = v * 10 + (v >> 8);
+        return u32((((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32);
+    }
+
+    /* Accumulates the digits to value and returns the end of them; value overflows after 19 digits */
+    inline const char* parse_digits(const char* p, const char* e, u64& value) {
+        while (e - p >= 16) {
+            auto hi = load_8chars(p);
+            auto lo = load_8chars(p + 8);
+            if (!is_8digits(hi) || !is_8digits(lo))
+                break;
+            value = value * 10000000000000000 + u64(parse_8digits(hi)) * 100000000 + parse_8digits(lo);
+            p += 16;
+        }
+        if (e - p >= 8) {
+            auto v = load_8chars(p);
+            if (is_8digits(v)) {
+                value = value * 100000000 + parse_8digits(v);
+                p += 8;
+            }
+        }
+        for (; p != e && u8(*p - '0') < 10; ++p)
+            value = value * 10 + u8(*p - '0');
+        return p;
+    }
+
+    template <typename T>
+    std::errc parse_int(const char* b, const char* e, T& out) {
+        auto p   = b;
+        bool neg = false;
+        if constexpr (signed_integral<T>) {
+            if (p != e && *p == '-') {
+                neg = true;
+                ++p;
+            }
+        }
+
+        u64  value = 0;
+        auto end   = parse_digits(p, e, value);
+        if (end == p || end != e)
+            return std::errc::invalid_argument;
+        if (end - p > 19)
+            return std::from_chars(b, e, out).ec;
+
+        if (value > u64(limits<T>::max()) + neg)
+            return std::errc::result_out_of_range;
+
+        out = neg ? T(0 - value) : T(value);
+        return {};
+    }
+
+    inline constexpr double pow10_exact[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                             1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    /* Clinger's fast path: a mantissa and a power of ten which are both exact in T give a correctly rounded result
+     * with a single operation. Everything else goes to std::from_chars.
+     */
+    template <typename T>
+    std::errc parse_float(const char* b, const char* e, T& out) {
+        constexpr u64 max_mantissa = u64(1) << (sizeof(T) == sizeof(float) ? 24 : 53);
+        constexpr i64 max_exp      = sizeof(T) == sizeof(float) ? 10 : 22;
+
+        auto p   = b;
+        bool neg = false;
+        if (p != e && *p == '-') {
+            neg = true;
+            ++p;
+        }
+
+        u64  mantissa = 0;
+        auto q        = parse_digits(p, e, mantissa);
+        auto digits   = q - p;
+        i64  exp      = 0;
+        if (q != e && *q == '.') {
+            auto frac  = q + 1;
+            q          = parse_digits(frac, e, mantissa);
+            exp        = frac - q;
+            digits    += q - frac;
+        }
+
+        if (q != e && (*q == 'e' || *q == 'E') && digits) {
+            ++q;
+            bool exp_neg = q != e && *q == '-';
+            if (q != e && (*q == '-' || *q == '+'))
+                ++q;
+
+            i64  value = 0;
+            auto start = q;
+            for (; q != e && u8(*q - '0') < 10 && q - start < 6; ++q)
+                value = value * 10 + u8(*q - '0');
+            exp += exp_neg ? -value : value;
+            if (q == start)
+                digits = 0;
+        }
+
+        if (q == e && digits && digits <= 19 && mantissa <= max_mantissa && exp >= -max_exp && exp <= max_exp) {
+            auto v = T(mantissa);
+            v      = exp < 0 ? v / T(pow10_exact[-exp]) : v * T(pow10_exact[exp]);
+            out    = neg ? -v : v;
+            return {};
+        }
+
+        auto rc = std::from_chars(b, e, out);
+        if (rc.ec == std::errc() && rc.ptr != e)
+            return std::errc::invalid_argument;
+        return rc.ec;
+    }
+} // namespace dtls
+
+/* Parses delimiter separated decimal numbers, e.g. "1,2,3" or "0.5 1e3\n", and writes them to the output iterator
+ * Runs of delimiters are skipped. Fields which are not a valid T are skipped too and reported with their offsets,
+ * nothing throws.
+ */
+template <number T, size_t N>
+    requires(sizeof(T) <= sizeof(u64) && !any_of<remove_cv<T>, bool, char, wchar_t, char8_t, char16_t, char32_t>)
+parse_many_result parse_many(std::span<const char> input, auto out, const array<char, N>& delims) {
+    parse_many_result result;
+
+    auto b = input.data();
+    auto e = b + input.size();
+    while (b != e) {
+        auto field_end = find_delim(b, e, delims);
+        if (field_end != b) {
+            T    value{};
+            auto ec = std::errc();
+            if constexpr (floating_point<T>)
+                ec = dtls::parse_float(b, field_end, value);
+            else
+                ec = dtls::parse_int(b, field_end, value);
+
+            if (ec == std::errc()) {
+                *out++ = value;
+                ++result.count;
+            }
+            else
+                result.errors.push_back({size_t(b - input.data()), ec});
+        }
+        b = field_end == e ? e : field_end + 1;
+    }
+    return result;
+}
+
+template <number T>
+parse_many_result parse_many(std::span<const char> input, auto out) {
+    return parse_many<T>(input, out, parse_many_default_delims);
+}
+} // namespace core
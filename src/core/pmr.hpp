@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <core/arena.hpp>
+#include <core/basic_types.hpp>
+#include <core/ring_buffer.hpp>
+
+namespace core::pmr {
+/* Type-erased memory source for pmr::allocator */
+class memory_resource {
+public:
+    virtual ~memory_resource() = default;
+
+    [[nodiscard]]
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        return do_allocate(size, align);
+    }
+
+    void deallocate(void* p, size_t size, size_t align = alignof(std::max_align_t)) noexcept {
+        do_deallocate(p, size, align);
+    }
+
+protected:
+    virtual void* do_allocate(size_t size, size_t align)                     = 0;
+    virtual void  do_deallocate(void* p, size_t size, size_t align) noexcept = 0;
+};
+
+class new_delete_resource_t : public memory_resource {
+protected:
+    void* do_allocate(size_t size, size_t align) final {
+        return ::operator new(size, std::align_val_t(align));
+    }
+
+    void do_deallocate(void* p, size_t size, size_t align) noexcept final {
+        ::operator delete(p, size, std::align_val_t(align));
+    }
+};
+
+inline memory_resource* new_delete_resource() noexcept {
+    static new_delete_resource_t resource;
+    return &resource;
+}
+
+/* Arena exposed as memory_resource */
+class arena_resource : public memory_resource, public arena {
+public:
+    using arena::arena;
+    using arena::allocate;
+    using arena::deallocate;
+
+protected:
+    void* do_allocate(size_t size, size_t align) final {
+        return arena::allocate(size, align);
+    }
+
+    void do_deallocate(void* p, size_t size, size_t align) noexcept final {
+        arena::deallocate(p, size, align);
+    }
+};
+
+/* Allocator which takes memory from memory_resource, new/delete by default */
+template <typename T = std::byte>
+class allocator {
+public:
+    using value_type = T;
+
+    allocator() noexcept = default;
+    allocator(memory_resource* resource) noexcept: _resource(resource) {}
+
+    template <typename U>
+    allocator(const allocator<U>& a) noexcept: _resource(a.resource()) {}
+
+    [[nodiscard]]
+    T* allocate(size_t count) {
+        return static_cast<T*>(_resource->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t count) noexcept {
+        _resource->deallocate(p, count * sizeof(T), alignof(T));
+    }
+
+    [[nodiscard]]
+    memory_resource* resource() const noexcept {
+        return _resource;
+    }
+
+    template <typename U>
+    bool operator==(const allocator<U>& a) const noexcept {
+        return _resource == a.resource();
+    }
+
+private:
+    memory_resource* _resource = new_delete_resource();
+};
+
+template <typename T>
+using vector = std::vector<T, allocator<T>>;
+
+template <typename T>
+using ring_buffer = core::ring_buffer<T, allocator<T>>;
+
+/* Promise mixin for coroutines which frames should be allocated from memory_resource
+ * Frame is allocated from the resource if coroutine takes (std::allocator_arg, allocator) as first arguments
+ * (after the object argument for member coroutines), with operator new otherwise.
+ */
+struct frame_allocated {
+    static void* operator new(size_t size) {
+        return allocate_frame(size, nullptr);
+    }
+
+    template <typename T>
+    static void* operator new(size_t size, std::allocator_arg_t, const allocator<T>& a, auto&&...) {
+        return allocate_frame(size, a.resource());
+    }
+
+    template <typename T>
+    static void* operator new(size_t size, auto&&, std::allocator_arg_t, const allocator<T>& a, auto&&...) {
+        return allocate_frame(size, a.resource());
+    }
+
+    static void operator delete(void* p, size_t size) noexcept {
+        auto full     = frame_size(size);
+        auto resource = *reinterpret_cast<memory_resource**>(static_cast<char*>(p) + full - sizeof(memory_resource*));
+        if (resource)
+            resource->deallocate(p, full);
+        else
+            ::operator delete(p, full);
+    }
+
+private:
+    static constexpr size_t frame_size(size_t size) noexcept {
+        constexpr auto align = alignof(memory_resource*);
+        return (size + align - 1) / align * align + sizeof(memory_resource*);
+    }
+
+    /* Resource pointer is stored after the frame, nullptr means global operator new */
+    static void* allocate_frame(size_t size, memory_resource* resource) {
+        auto full = frame_size(size);
+        auto p    = resource ? resource->allocate(full) : ::operator new(full);
+        *reinterpret_cast<memory_resource**>(static_cast<char*>(p) + full - sizeof(memory_resource*)) = resource;
+        return p;
+    }
+};
+} // namespace core::pmr
@@ -152,28 +152,30 @@ public:
         poll_details::set_pfd<0>(_fds, fwd(args)...);
     }
 
-    void run(opt<sys::nanoseconds> timeout = null) {
-        while (true) {
-            auto count   = poll(_fds, timeout).get();
-            bool running = true;
-            for (size_t i = 0; count > 0 && i < S; ++i) {
-                if (_fds[i].revents & _fds[i].events) {
-                    --count;
-                    running =
-                        running && idx_dispatch_r<bool, S>(i, [this](auto idx) {
-                            if constexpr (is_same<invoke_result<remove_cvref<decltype(_handler)>, decltype(idx), decltype(_fds[idx])>,
-                                                  void>) {
-                                _handler(idx, _fds[idx]);
-                                return true;
-                            }
-                            else
-                                return _handler(idx, _fds[idx]);
-                        });
-                }
+    /* Polls once and dispatches the ready fds, false if a handler requested stop */
+    bool poll_once(opt<sys::nanoseconds> timeout = null) {
+        auto count   = poll(_fds, timeout).get();
+        bool running = true;
+        for (size_t i = 0; count > 0 && i < S; ++i) {
+            if (_fds[i].revents & _fds[i].events) {
+                --count;
+                running =
+                    running && idx_dispatch_r<bool, S>(i, [this](auto idx) {
+                        if constexpr (is_same<invoke_result<remove_cvref<decltype(_handler)>, decltype(idx), decltype(_fds[idx])>,
+                                              void>) {
+                            _handler(idx, _fds[idx]);
+                            return true;
+                        }
+                        else
+                            return _handler(idx, _fds[idx]);
+                    });
             }
-            if (!running)
-                break;
         }
+        return running;
+    }
+
+    void run(opt<sys::nanoseconds> timeout = null) {
+        while (poll_once(timeout)) {}
     }
 
     void operator()(opt<sys::nanoseconds> timeout = null) {
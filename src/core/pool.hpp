@@ -0,0 +1,202 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+
+#include <core/arena.hpp>
+#include <core/basic_types.hpp>
+
+#define fwd(...) static_cast<decltype(__VA_ARGS__)>(__VA_ARGS__)
+
+namespace core {
+namespace dtls {
+    inline std::atomic<u64> pool_id_counter = 1;
+} // namespace dtls
+
+/* Fixed-size object pool
+ * Free blocks are kept in a shared list protected by a mutex and in a per-thread cache,
+ * so allocate/deallocate from the same thread usually do not take the lock.
+ * The thread cache is shared by all pools of the same type. Blocks cached for one pool are returned to its list when
+ * the thread switches to another pool and when the thread exits, unless that pool is already destroyed.
+ */
+template <typename T, size_t ChunkObjects = 64, size_t CacheSize = 32>
+class pool {
+    union node {
+        node* next;
+        alignas(T) char storage[sizeof(T)];
+    };
+
+    struct chunk {
+        chunk* next;
+        node   nodes[ChunkObjects];
+    };
+
+    /* Outlives the pool while thread caches refer to it, alive is cleared when the pool memory is released */
+    struct shared_list {
+        std::mutex mtx;
+        node*      free  = nullptr;
+        bool       alive = true;
+    };
+
+    struct thread_cache {
+        ~thread_cache() {
+            release(*this);
+        }
+
+        u64                        pool_id = 0;
+        std::weak_ptr<shared_list> owner;
+        node*                      head = nullptr;
+        size_t                     size = 0;
+    };
+
+    static inline thread_local thread_cache tl_cache;
+
+public:
+    pool() = default;
+
+    ~pool() {
+        std::lock_guard lock{_shared->mtx};
+        _shared->alive = false;
+        while (_chunks) {
+            auto next = _chunks->next;
+            delete _chunks;
+            _chunks = next;
+        }
+    }
+
+    pool(const pool&)            = delete;
+    pool& operator=(const pool&) = delete;
+
+    [[nodiscard]]
+    T* allocate() {
+        auto& cache = tl_cache;
+        if (cache.pool_id != _id || !cache.head)
+            refill(cache);
+
+        auto n     = cache.head;
+        cache.head = n->next;
+        --cache.size;
+
+        _allocations.fetch_add(1, std::memory_order_relaxed);
+        return reinterpret_cast<T*>(n->storage);
+    }
+
+    void deallocate(T* ptr) noexcept {
+        _deallocations.fetch_add(1, std::memory_order_relaxed);
+
+        auto  n     = reinterpret_cast<node*>(ptr);
+        auto& cache = tl_cache;
+        if (cache.pool_id != _id) {
+            std::lock_guard lock{_shared->mtx};
+            n->next       = _shared->free;
+            _shared->free = n;
+            return;
+        }
+
+        n->next    = cache.head;
+        cache.head = n;
+        if (++cache.size > CacheSize)
+            flush(cache, CacheSize / 2);
+    }
+
+    template <typename... Ts>
+    T* create(Ts&&... args) {
+        auto p = allocate();
+        try {
+            return ::new (p) T(fwd(args)...);
+        }
+        catch (...) {
+            deallocate(p);
+            throw;
+        }
+    }
+
+    void destroy(T* ptr) noexcept {
+        ptr->~T();
+        deallocate(ptr);
+    }
+
+    [[nodiscard]]
+    alloc_stats stats() const noexcept {
+        std::lock_guard lock{_shared->mtx};
+        return {
+            .allocations     = _allocations.load(std::memory_order_relaxed),
+            .deallocations   = _deallocations.load(std::memory_order_relaxed),
+            .bytes_requested = _allocations.load(std::memory_order_relaxed) * sizeof(T),
+            .bytes_reserved  = _chunks_count * sizeof(chunk),
+            .chunks          = _chunks_count,
+        };
+    }
+
+private:
+    /* Takes up to half of cache size from the shared list, allocates a new chunk if it is empty */
+    void refill(thread_cache& cache) {
+        if (cache.pool_id != _id) {
+            release(cache);
+            cache.pool_id = _id;
+            cache.owner   = _shared;
+        }
+
+        std::lock_guard lock{_shared->mtx};
+        auto&           free = _shared->free;
+        if (!free) {
+            auto c  = new chunk;
+            c->next = _chunks;
+            _chunks = c;
+            ++_chunks_count;
+            for (size_t i = 0; i < ChunkObjects; ++i) {
+                c->nodes[i].next = free;
+                free             = c->nodes + i;
+            }
+        }
+
+        while (free && cache.size < CacheSize / 2 + 1) {
+            auto n     = free;
+            free       = n->next;
+            n->next    = cache.head;
+            cache.head = n;
+            ++cache.size;
+        }
+    }
+
+    void flush(thread_cache& cache, size_t count) noexcept {
+        std::lock_guard lock{_shared->mtx};
+        for (; count && cache.head; --count) {
+            auto n     = cache.head;
+            cache.head = n->next;
+            --cache.size;
+            n->next       = _shared->free;
+            _shared->free = n;
+        }
+    }
+
+    /* Returns all cached blocks to the pool they belong to, drops them if it is destroyed */
+    static void release(thread_cache& cache) noexcept {
+        if (cache.head) {
+            if (auto owner = cache.owner.lock()) {
+                std::lock_guard lock{owner->mtx};
+                if (owner->alive) {
+                    auto tail = cache.head;
+                    while (tail->next)
+                        tail = tail->next;
+                    tail->next  = owner->free;
+                    owner->free = cache.head;
+                }
+            }
+        }
+        cache.head = nullptr;
+        cache.size = 0;
+    }
+
+    std::shared_ptr<shared_list> _shared        = std::make_shared<shared_list>();
+    chunk*                       _chunks        = nullptr;
+    size_t                       _chunks_count  = 0;
+    std::atomic<size_t>          _allocations   = 0;
+    std::atomic<size_t>          _deallocations = 0;
+    u64                          _id            = dtls::pool_id_counter.fetch_add(1, std::memory_order_relaxed);
+};
+} // namespace core
+
+#undef fwd
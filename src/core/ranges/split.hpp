@@ -1,8 +1,12 @@
 #pragma once
 
+#include <iterator>
+
 #include "core/array.hpp"
 #include <core/begin_end.hpp>
+#include <core/find_delim.hpp>
 #include <core/traits/decay.hpp>
+#include <core/traits/is_same.hpp>
 #include <core/traits/declval.hpp>
 #include <core/traits/remove_const.hpp>
 #include <core/utility/move.hpp>
@@ -53,13 +57,24 @@ private:
         return false;
     }
 
+    /* Contiguous char ranges are scanned with core::find_delim */
+    I find_next_delim(I from) const {
+        if constexpr (is_same<non_const_t, char> && std::contiguous_iterator<I>) {
+            auto p = std::to_address(from);
+            return from + (find_delim(p, std::to_address(end), delims) - p);
+        }
+        else {
+            while (from != end && !has_delim(delims, *from))
+                ++from;
+            return from;
+        }
+    }
+
     void init() {
         if (!allow_empty)
             while (b != end && has_delim(delims, *b))
                 ++b;
-        e = b;
-        while (e != end && !has_delim(delims, *e))
-            ++e;
+        e = find_next_delim(b);
     }
 
     void next() {
@@ -70,9 +85,7 @@ private:
             if (b == end)
                 return;
 
-            e = ++b;
-            while (e != end && !has_delim(delims, *e))
-                ++e;
+            e = find_next_delim(++b);
 
             repeat = !allow_empty && b == e;
         }
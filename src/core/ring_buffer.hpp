@@ -95,7 +95,7 @@ public:
     using iterator       = ring_buffer_iterator<typename std::vector<T, Allocator>::iterator>;
     using const_iterator = ring_buffer_iterator<typename std::vector<T, Allocator>::const_iterator>;
 
-    ring_buffer(size_t size): _data(size > 0 ? size : 1) {}
+    ring_buffer(size_t size, const Allocator& allocator = Allocator()): _data(size > 0 ? size : 1, allocator) {}
 
     void clear() {
         for (auto& s : _data)
@@ -107,7 +107,7 @@ public:
 
     void resize(size_t new_size) {
         new_size = new_size > 0 ? new_size : 1;
-        ring_buffer new_buf{new_size};
+        ring_buffer new_buf{new_size, _data.get_allocator()};
         for (auto& v : *this)
             new_buf.push(std::move(v));
 
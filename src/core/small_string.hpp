@@ -0,0 +1,170 @@
+#pragma once
+
+#include <ostream>
+#include <string_view>
+
+#include <core/concepts/string.hpp>
+#include <core/small_vector.hpp>
+
+namespace core {
+/* Null-terminated string with inline storage for N characters */
+template <size_t N>
+class small_string {
+public:
+    using value_type = char;
+
+    small_string() {
+        _buf.push_back('\0');
+    }
+
+    small_string(std::string_view str) {
+        assign(str);
+    }
+
+    small_string(const char* str): small_string(std::string_view(str)) {}
+
+    template <sized_str_typed<char> S>
+    explicit small_string(const S& str): small_string(std::string_view(str.data(), str.size())) {}
+
+    small_string(const small_string&)            = default;
+    small_string& operator=(const small_string&) = default;
+
+    /* Moved-from string remains valid and empty */
+    small_string(small_string&& str) noexcept: _buf(mov(str._buf)) {
+        str._buf.push_back('\0');
+    }
+
+    small_string& operator=(small_string&& str) noexcept {
+        if (this == &str)
+            return *this;
+        _buf = mov(str._buf);
+        str._buf.push_back('\0');
+        return *this;
+    }
+
+    small_string& operator=(std::string_view str) {
+        assign(str);
+        return *this;
+    }
+
+    small_string& operator=(const char* str) {
+        return *this = std::string_view(str);
+    }
+
+    void assign(std::string_view str) {
+        if (str.data() >= data() && str.data() < data() + _buf.size()) {
+            /* Substring of this, moved to the front in place */
+            __builtin_memmove(data(), str.data(), str.size());
+            resize(str.size());
+            return;
+        }
+
+        _buf.clear();
+        _buf.reserve(str.size() + 1);
+        _buf.append(str.data(), str.size());
+        _buf.push_back('\0');
+    }
+
+    /* str may be a view of this string */
+    small_string& append(std::string_view str) {
+        _buf.pop_back();
+        _buf.append(str.data(), str.size());
+        _buf.push_back('\0');
+        return *this;
+    }
+
+    small_string& operator+=(std::string_view str) {
+        return append(str);
+    }
+
+    small_string& operator+=(char c) {
+        push_back(c);
+        return *this;
+    }
+
+    void push_back(char c) {
+        _buf.back() = c;
+        _buf.push_back('\0');
+    }
+
+    void resize(size_t size, char c = '\0') {
+        auto prev = this->size();
+        _buf.resize(size + 1);
+        for (size_t i = prev; i < size; ++i)
+            _buf[i] = c;
+        _buf.back() = '\0';
+    }
+
+    void clear() noexcept {
+        _buf.clear();
+        _buf.push_back('\0');
+    }
+
+    char* data() noexcept {
+        return _buf.data();
+    }
+
+    const char* data() const noexcept {
+        return _buf.data();
+    }
+
+    const char* c_str() const noexcept {
+        return _buf.data();
+    }
+
+    size_t size() const noexcept {
+        return _buf.size() - 1;
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    bool is_inline() const noexcept {
+        return _buf.is_inline();
+    }
+
+    char* begin() noexcept {
+        return data();
+    }
+
+    const char* begin() const noexcept {
+        return data();
+    }
+
+    char* end() noexcept {
+        return data() + size();
+    }
+
+    const char* end() const noexcept {
+        return data() + size();
+    }
+
+    char& operator[](size_t i) noexcept {
+        return _buf[i];
+    }
+
+    const char& operator[](size_t i) const noexcept {
+        return _buf[i];
+    }
+
+    operator std::string_view() const noexcept {
+        return {data(), size()};
+    }
+
+    std::string_view view() const noexcept {
+        return {data(), size()};
+    }
+
+    friend bool operator==(const small_string& lhs, std::string_view rhs) noexcept {
+        return lhs.view() == rhs;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const small_string& str) {
+        return os << str.view();
+    }
+
+private:
+    small_vector<char, N + 1> _buf;
+};
+} // namespace core
@@ -0,0 +1,353 @@
+#pragma once
+
+#include <initializer_list>
+#include <new>
+
+#include <core/basic_types.hpp>
+#include <core/concepts/nothrow_ctor.hpp>
+#include <core/concepts/trivial_ctor.hpp>
+#include <core/concepts/trivial_dtor.hpp>
+#include <core/finalizer.hpp>
+#include <core/utility/move.hpp>
+
+#define fwd(...) static_cast<decltype(__VA_ARGS__)>(__VA_ARGS__)
+
+namespace core {
+namespace dtls {
+    /* Element operations used when storage changes
+     * Specialized for trivial types: relocation and copying collapse to memcpy, destruction to nothing
+     */
+    template <typename T>
+    struct smv_dtor_ops {
+        static void destroy(T* data, size_t size) noexcept {
+            for (size_t i = 0; i < size; ++i)
+                data[i].~T();
+        }
+    };
+
+    template <trivial_dtor T>
+    struct smv_dtor_ops<T> {
+        static void destroy(T*, size_t) noexcept {}
+    };
+
+    template <typename T>
+    struct smv_mctor_ops : smv_dtor_ops<T> {
+        /* Move elements to uninitialized dst and destroy source elements */
+        static void relocate(T* dst, T* src, size_t size) noexcept(nothrow_move_ctor<T>) {
+            for (size_t i = 0; i < size; ++i) {
+                ::new (dst + i) T(mov(src[i]));
+                src[i].~T();
+            }
+        }
+    };
+
+    template <trivial_move_ctor T> requires trivial_dtor<T>
+    struct smv_mctor_ops<T> : smv_dtor_ops<T> {
+        static void relocate(T* dst, T* src, size_t size) noexcept {
+            __builtin_memcpy((void*)dst, (const void*)src, size * sizeof(T));
+        }
+    };
+
+    template <typename T>
+    struct smv_ops : smv_mctor_ops<T> {
+        static void copy(T* dst, const T* src, size_t size) {
+            for (size_t i = 0; i < size; ++i)
+                ::new (dst + i) T(src[i]);
+        }
+    };
+
+    template <trivial_copy_ctor T>
+    struct smv_ops<T> : smv_mctor_ops<T> {
+        static void copy(T* dst, const T* src, size_t size) noexcept {
+            __builtin_memcpy((void*)dst, (const void*)src, size * sizeof(T));
+        }
+    };
+
+    template <typename T, size_t S>
+    struct small_vector_base {
+        T* data() noexcept {
+            return _heap ? _heap : reinterpret_cast<T*>(_data);
+        }
+
+        const T* data() const noexcept {
+            return _heap ? _heap : reinterpret_cast<const T*>(_data);
+        }
+
+        auto begin() noexcept {
+            return data();
+        }
+
+        auto begin() const noexcept {
+            return data();
+        }
+
+        auto end() noexcept {
+            return begin() + _size;
+        }
+
+        auto end() const noexcept {
+            return begin() + _size;
+        }
+
+        constexpr size_t size() const noexcept {
+            return _size;
+        }
+
+        constexpr size_t capacity() const noexcept {
+            return _capacity;
+        }
+
+        constexpr bool empty() const noexcept {
+            return _size == 0;
+        }
+
+        /* True if elements are stored in the inline buffer */
+        constexpr bool is_inline() const noexcept {
+            return _heap == nullptr;
+        }
+
+        static constexpr size_t inline_capacity() noexcept {
+            return S;
+        }
+
+        T& operator[](size_t i) noexcept {
+            return data()[i];
+        }
+
+        const T& operator[](size_t i) const noexcept {
+            return data()[i];
+        }
+
+        T& front() noexcept {
+            return *begin();
+        }
+
+        const T& front() const noexcept {
+            return *begin();
+        }
+
+        T& back() noexcept {
+            return *(begin() + (_size - 1));
+        }
+
+        const T& back() const noexcept {
+            return *(begin() + (_size - 1));
+        }
+
+        alignas(T) char _data[sizeof(T) * S];
+        T*     _heap     = nullptr;
+        size_t _size     = 0;
+        size_t _capacity = S;
+    };
+} // namespace dtls
+
+/* Vector with inline storage for S elements, spills to the heap when it grows beyond
+ * Iterators and references are invalidated by any operation which changes capacity and by move
+ */
+template <typename T, size_t S>
+class small_vector : public dtls::small_vector_base<T, S> {
+    using ops = dtls::smv_ops<T>;
+
+public:
+    using value_type = T;
+
+    small_vector() = default;
+
+    small_vector(std::initializer_list<T> values) {
+        reserve(values.size());
+        ops::copy(this->data(), values.begin(), values.size());
+        this->_size = values.size();
+    }
+
+    template <typename I>
+    small_vector(I first, I last) {
+        for (; first != last; ++first)
+            emplace_back(*first);
+    }
+
+    ~small_vector() {
+        ops::destroy(this->data(), this->_size);
+        _free();
+    }
+
+    small_vector(const small_vector& v) {
+        reserve(v._size);
+        ops::copy(this->data(), v.data(), v._size);
+        this->_size = v._size;
+    }
+
+    small_vector(small_vector&& v) noexcept(nothrow_move_ctor<T>) {
+        _steal(v);
+    }
+
+    small_vector& operator=(const small_vector& v) {
+        if (this == &v)
+            return *this;
+
+        clear();
+        reserve(v._size);
+        ops::copy(this->data(), v.data(), v._size);
+        this->_size = v._size;
+        return *this;
+    }
+
+    small_vector& operator=(small_vector&& v) noexcept(nothrow_move_ctor<T>) {
+        if (this == &v)
+            return *this;
+
+        ops::destroy(this->data(), this->_size);
+        _free();
+        this->_size     = 0;
+        this->_capacity = S;
+        _steal(v);
+        return *this;
+    }
+
+    /* args may refer to elements of this vector */
+    T& emplace_back(auto&&... args) {
+        if (this->_size == this->_capacity) {
+            /* The new element is constructed before the old storage is released */
+            auto capacity = _new_capacity(this->_capacity * 2);
+            auto heap     = _allocate(capacity);
+            finalizer guard{[&] {
+                _deallocate(heap);
+            }};
+            ::new (heap + this->_size) T(fwd(args)...);
+            guard.dismiss();
+
+            _adopt(heap, capacity);
+            return heap[this->_size++];
+        }
+
+        auto p = this->data() + this->_size;
+        if constexpr (trivial_ctor<T, decltype(args)...> && trivial_move_ctor<T>)
+            *p = T(fwd(args)...);
+        else
+            ::new (p) T(fwd(args)...);
+        ++this->_size;
+        return *p;
+    }
+
+    void push_back(const T& value) {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value) {
+        emplace_back(mov(value));
+    }
+
+    /* Bulk append, copies with memcpy for trivial types. values may point into this vector */
+    void append(const T* values, size_t count) {
+        if (this->_size + count > this->_capacity) {
+            auto needed   = this->_size + count;
+            auto capacity = _new_capacity(needed > this->_capacity * 2 ? needed : this->_capacity * 2);
+            auto heap     = _allocate(capacity);
+            finalizer guard{[&] {
+                _deallocate(heap);
+            }};
+            ops::copy(heap + this->_size, values, count);
+            guard.dismiss();
+
+            _adopt(heap, capacity);
+        }
+        else
+            ops::copy(this->data() + this->_size, values, count);
+        this->_size += count;
+    }
+
+    void pop_back() noexcept {
+        --this->_size;
+        ops::destroy(this->data() + this->_size, 1);
+    }
+
+    T* erase(T* pos) {
+        auto e = this->end();
+        for (auto p = pos; p + 1 != e; ++p)
+            *p = mov(*(p + 1));
+        pop_back();
+        return pos;
+    }
+
+    void clear() noexcept {
+        ops::destroy(this->data(), this->_size);
+        this->_size = 0;
+    }
+
+    void reserve(size_t capacity) {
+        if (capacity > this->_capacity)
+            _grow(capacity);
+    }
+
+    void resize(size_t size) {
+        if (size < this->_size) {
+            ops::destroy(this->data() + size, this->_size - size);
+            this->_size = size;
+            return;
+        }
+
+        reserve(size);
+        for (auto p = this->data() + this->_size, e = this->data() + size; p != e; ++p)
+            ::new (p) T();
+        this->_size = size;
+    }
+
+    bool operator==(const small_vector& v) const {
+        if (this->_size != v._size)
+            return false;
+        for (size_t i = 0; i < this->_size; ++i)
+            if (!((*this)[i] == v[i]))
+                return false;
+        return true;
+    }
+
+private:
+    static constexpr size_t _new_capacity(size_t capacity) noexcept {
+        return capacity < S * 2 ? S * 2 : capacity;
+    }
+
+    static T* _allocate(size_t capacity) {
+        return static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    static void _deallocate(T* heap) noexcept {
+        ::operator delete(heap, std::align_val_t(alignof(T)));
+    }
+
+    /* Moves the elements to heap and releases the old storage */
+    void _adopt(T* heap, size_t capacity) noexcept(nothrow_move_ctor<T>) {
+        ops::relocate(heap, this->data(), this->_size);
+        _free();
+        this->_heap     = heap;
+        this->_capacity = capacity;
+    }
+
+    void _grow(size_t capacity) {
+        capacity = _new_capacity(capacity);
+        _adopt(_allocate(capacity), capacity);
+    }
+
+    void _free() noexcept {
+        if (this->_heap) {
+            _deallocate(this->_heap);
+            this->_heap = nullptr;
+        }
+    }
+
+    /* Expects empty inline state of this */
+    void _steal(small_vector& v) noexcept(nothrow_move_ctor<T>) {
+        if (v._heap) {
+            this->_heap     = v._heap;
+            this->_capacity = v._capacity;
+            v._heap         = nullptr;
+            v._capacity     = S;
+        }
+        else {
+            ops::relocate(this->data(), v.data(), v._size);
+        }
+        this->_size = v._size;
+        v._size     = 0;
+    }
+};
+} // namespace core
+
+#undef fwd
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <atomic>
+#include <new>
+
+#include <core/basic_types.hpp>
+#include <core/event_count.hpp>
+#include <core/traits/conditional.hpp>
+#include <core/utility/move.hpp>
+
+#define fwd(...) static_cast<decltype(__VA_ARGS__)>(__VA_ARGS__)
+
+namespace core {
+namespace dtls {
+    inline u32 ring_capacity(u32 capacity) {
+        u32 result = 2;
+        while (result < capacity)
+            result <<= 1;
+        return result;
+    }
+} // namespace dtls
+
+/* Lock-free single-producer single-consumer ring
+ * Capacity is rounded up to a power of two.
+ * If Waitable is true push()/pop() block on futex while the ring is full/empty
+ * and every successful try_* operation notifies the other side.
+ */
+template <typename T, bool Waitable = false>
+class spsc_ring {
+public:
+    explicit spsc_ring(u32 capacity):
+        _mask(dtls::ring_capacity(capacity) - 1),
+        _data(static_cast<T*>(::operator new(sizeof(T) * (_mask + 1), std::align_val_t(alignof(T))))) {}
+
+    ~spsc_ring() {
+        for (auto i = _head.load(std::memory_order_relaxed), e = _tail.load(std::memory_order_relaxed); i != e; ++i)
+            _data[i & _mask].~T();
+        ::operator delete(_data, std::align_val_t(alignof(T)));
+    }
+
+    spsc_ring(const spsc_ring&)            = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    /* Producer side */
+
+    bool try_push(auto&& value) {
+        return try_emplace(fwd(value));
+    }
+
+    bool try_emplace(auto&&... args) {
+        auto tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _cached_head > _mask) {
+            _cached_head = _head.load(std::memory_order_acquire);
+            if (tail - _cached_head > _mask)
+                return false;
+        }
+
+        ::new (_data + (tail & _mask)) T(fwd(args)...);
+        _tail.store(tail + 1, std::memory_order_release);
+        if constexpr (Waitable)
+            _not_empty.notify_one();
+        return true;
+    }
+
+    /* Copies up to count values, returns number of pushed values */
+    size_t try_push(const T* values, size_t count) {
+        auto tail = _tail.load(std::memory_order_relaxed);
+        auto free = _mask + 1 - (tail - _cached_head);
+        if (free < count) {
+            _cached_head = _head.load(std::memory_order_acquire);
+            free         = _mask + 1 - (tail - _cached_head);
+        }
+
+        auto n = count < free ? u32(count) : free;
+        for (u32 i = 0; i < n; ++i)
+            ::new (_data + ((tail + i) & _mask)) T(values[i]);
+
+        if (n) {
+            _tail.store(tail + n, std::memory_order_release);
+            if constexpr (Waitable)
+                _not_empty.notify_one();
+        }
+        return n;
+    }
+
+    void push(auto&& value) requires Waitable {
+        while (!try_push(fwd(value))) {
+            auto key = _not_full.prepare_wait();
+            if (!full())
+                _not_full.cancel_wait();
+            else
+                _not_full.wait(key);
+        }
+    }
+
+    /* Consumer side */
+
+    bool try_pop(T& output) {
+        auto head = _head.load(std::memory_order_relaxed);
+        if (head == _cached_tail) {
+            _cached_tail = _tail.load(std::memory_order_acquire);
+            if (head == _cached_tail)
+                return false;
+        }
+
+        auto& slot = _data[head & _mask];
+        output     = mov(slot);
+        slot.~T();
+        _head.store(head + 1, std::memory_order_release);
+        if constexpr (Waitable)
+            _not_full.notify_one();
+        return true;
+    }
+
+    /* Moves up to max values to output, returns number of popped values */
+    size_t try_pop(T* output, size_t max) {
+        auto head  = _head.load(std::memory_order_relaxed);
+        auto avail = _cached_tail - head;
+        if (avail < max) {
+            _cached_tail = _tail.load(std::memory_order_acquire);
+            avail        = _cached_tail - head;
+        }
+
+        auto n = max < avail ? u32(max) : avail;
+        for (u32 i = 0; i < n; ++i) {
+            auto& slot = _data[(head + i) & _mask];
+            output[i]  = mov(slot);
+            slot.~T();
+        }
+
+        if (n) {
+            _head.store(head + n, std::memory_order_release);
+            if constexpr (Waitable)
+                _not_full.notify_one();
+        }
+        return n;
+    }
+
+    T pop() requires Waitable {
+        T result;
+        wait_not_empty();
+        try_pop(result);
+        return result;
+    }
+
+    /* Blocks until at least one value is available */
+    size_t pop(T* output, size_t max) requires Waitable {
+        wait_not_empty();
+        return try_pop(output, max);
+    }
+
+    /* Approximate if called concurrently with push or pop */
+    [[nodiscard]]
+    size_t size() const noexcept {
+        return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]]
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    [[nodiscard]]
+    bool full() const noexcept {
+        return size() > _mask;
+    }
+
+    [[nodiscard]]
+    size_t capacity() const noexcept {
+        return _mask + 1;
+    }
+
+private:
+    void wait_not_empty() requires Waitable {
+        while (empty()) {
+            auto key = _not_empty.prepare_wait();
+            if (!empty())
+                _not_empty.cancel_wait();
+            else
+                _not_empty.wait(key);
+        }
+    }
+
+    struct empty_t {};
+    using event_t = conditional<Waitable, event_count, empty_t>;
+
+    alignas(cache_line_size) std::atomic<u32> _head        = 0;
+    u32                                       _cached_tail = 0;
+    [[no_unique_address]] event_t             _not_full;
+
+    alignas(cache_line_size) std::atomic<u32> _tail        = 0;
+    u32                                       _cached_head = 0;
+    [[no_unique_address]] event_t             _not_empty;
+
+    alignas(cache_line_size) u32 _mask;
+    T*                           _data;
+};
+} // namespace core
+
+#undef fwd
@@ -1,19 +1,57 @@
 #pragma once
 
 #include "../int_const.hpp"
+#include "int_seq.hpp"
 
 namespace core::dtls {
+template <size_t I, typename R, typename F>
+constexpr R _idx_table_entry(F&& func) {
+    return static_cast<F&&>(func)(int_const<I>{});
+}
+
+template <typename R, typename F, size_t B, typename Seq>
+struct _idx_table;
+
+template <typename R, typename F, size_t B, size_t... Is>
+struct _idx_table<R, F, B, idx_seq<Is...>> {
+    static constexpr R (*table[])(F&&) = {&_idx_table_entry<B + Is, R, F>...};
+};
+
+#define case_flat(I)                                                                   \
+    case I:                                                                            \
+        if constexpr (I < S)                                                           \
+            return static_cast<decltype(func)>(func)(int_const<B + I>{});              \
+        else                                                                           \
+            __builtin_unreachable();
+
+#define case_flat8(N)                                                                  \
+    case_flat(N * 8 + 0) case_flat(N * 8 + 1) case_flat(N * 8 + 2) case_flat(N * 8 + 3) \
+    case_flat(N * 8 + 4) case_flat(N * 8 + 5) case_flat(N * 8 + 6) case_flat(N * 8 + 7)
+
+/* Dispatch for more than 16 indices without nesting:
+ * one switch up to 64 indices, constexpr table of function pointers above
+ */
 template <size_t S>
 struct _idx_dispatch {
     template <size_t B>
     static constexpr decltype(auto) call(size_t i, auto&& func) {
-        if (i < S / 2)
-            return _idx_dispatch<S / 2>::template call<B>(i, static_cast<decltype(func)>(func));
-        else
-            return _idx_dispatch<S - S / 2>::template call<B + S / 2>(i - S / 2, static_cast<decltype(func)>(func));
+        if constexpr (S <= 64) {
+            switch (i) {
+                case_flat8(0) case_flat8(1) case_flat8(2) case_flat8(3)
+                case_flat8(4) case_flat8(5) case_flat8(6) case_flat8(7)
+                default: __builtin_unreachable();
+            }
+        }
+        else {
+            using return_t = decltype(static_cast<decltype(func)>(func)(int_const<B>{}));
+            return _idx_table<return_t, decltype(func), B, make_idx_seq<S>>::table[i](static_cast<decltype(func)>(func));
+        }
     }
 };
 
+#undef case_flat8
+#undef case_flat
+
 template <>
 struct _idx_dispatch<0> {};
 
@@ -919,23 +919,33 @@ struct var : dtls::var_impl<Ts...> {
 /* Visit */
 
 namespace dtls {
-constexpr decltype(auto) _visit(auto&& function, auto&& var) {
-    return idx_dispatch<remove_cvref<decltype(var)>::size()>(var.index(), [&](auto i) -> decltype(auto) {
-        return fwd(function)(fwd(var)._get(i));
-    });
+/* Index of K-th variant in flattened index I of variants with sizes Ss... */
+template <size_t I, size_t K, size_t... Ss>
+constexpr size_t _visit_unflatten() {
+    constexpr size_t sizes[] = {Ss...};
+    size_t           stride  = 1;
+    for (size_t j = K + 1; j < sizeof...(Ss); ++j)
+        stride *= sizes[j];
+    return I / stride % sizes[K];
 }
 
-constexpr decltype(auto) _visit(auto&& function, auto&& var1, auto&& var2, auto&&... vars) {
-    return idx_dispatch<remove_cvref<decltype(var1)>::size()>(var1.index(), [&](auto i1) -> decltype(auto) {
-        return _visit(
-            [&](auto&&... a) -> decltype(auto) {
-                return fwd(function)(fwd(var1)._get(i1), fwd(a)...);
-            },
-            fwd(var2),
-            fwd(vars)...);
+/* Combines indices of all variants into one and dispatches once */
+template <size_t... Ks>
+constexpr decltype(auto) _visit_flat(idx_seq<Ks...>, auto&& function, auto&&... vars) {
+    size_t idx = 0;
+    ((idx = idx * remove_cvref<decltype(vars)>::size() + vars.index()), ...);
+
+    return idx_dispatch<(remove_cvref<decltype(vars)>::size() * ...)>(idx, [&](auto i) -> decltype(auto) {
+        return fwd(function)(
+            fwd(vars)._get(int_c<_visit_unflatten<decltype(i)::value, Ks, remove_cvref<decltype(vars)>::size()...>()>)...
+        );
     });
 }
 
+constexpr decltype(auto) _visit(auto&& function, auto&&... vars) {
+    return _visit_flat(make_idx_seq<sizeof...(vars)>{}, fwd(function), fwd(vars)...);
+}
+
 template <typename F, typename... Ts>
 struct _visit_caller {
     constexpr _visit_caller(type_list_t<F, Ts...>) {}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <span>
+
+#include <core/opt.hpp>
+#include <core/utility/move.hpp>
+#include <sys/chrono.hpp>
+#include <sys/event.hpp>
+
+namespace inp {
+
+/**
+ * @brief Coalesces an input event stream into batches for sending over the network
+ *
+ * Consecutive reports (events up to SYN_REPORT) which contain only relative events are merged into one report,
+ * values of the same code are summed. A high polling rate mouse which only moves produces one report per batch.
+ * Other events are kept as is and end the merging.
+ *
+ * The pending events are passed to the sink when the next event would not fit MaxBytes or when the first of them
+ * is older than max_delay. Every batch is stamped with a sequence number.
+ *
+ * The batcher does no I/O itself. With the poller: poller.poll_once(batcher.timeout()) and then batcher.expire().
+ * With the uring runtime: a task awaiting async::sleep(*batcher.timeout()) and then calling expire().
+ *
+ * @tparam Sink - callable with (std::span<const sys::event> events, sys::u32 seq)
+ * @tparam MaxBytes - batch size limit, 1472 is the UDP payload of a 1500 bytes MTU
+ */
+template <typename Sink, size_t MaxBytes = 1472>
+class event_batcher {
+public:
+    using clock = std::chrono::steady_clock;
+
+    static inline constexpr size_t capacity = MaxBytes / sizeof(sys::event);
+    static_assert(capacity > 1);
+
+    event_batcher(Sink sink, sys::nanoseconds max_delay = sys::microseconds(250)): _sink(core::mov(sink)), _max_delay(max_delay) {}
+
+    void push(std::span<const sys::event> events, clock::time_point now = clock::now()) {
+        for (auto&& event : events)
+            push(event, now);
+    }
+
+    void push(const sys::event& event, clock::time_point now = clock::now()) {
+        if (_size == capacity)
+            flush_reports();
+        if (_size == 0)
+            _deadline = now + _max_delay;
+        if (_size == _open)
+            _open_deadline = now + _max_delay;
+
+        _events[_size++] = event;
+        if (event.type == sys::event_type::synchronize && event.code.raw == SYN_REPORT)
+            end_report();
+    }
+
+    /* Time left until the pending events must be flushed, null if there are none */
+    core::opt<sys::nanoseconds> timeout(clock::time_point now = clock::now()) const {
+        if (_size == 0)
+            return core::null;
+        return _deadline > now ? _deadline - now : sys::nanoseconds{0};
+    }
+
+    /* Flushes the pending events if their deadline has passed */
+    bool expire(clock::time_point now = clock::now()) {
+        if (_size == 0 || now < _deadline)
+            return false;
+        flush();
+        return true;
+    }
+
+    void flush() {
+        if (_size == 0)
+            return;
+        _sink(std::span<const sys::event>{_events, _size}, _seq++);
+        _size      = _last = _open = 0;
+        _mergeable = false;
+    }
+
+    /* Sequence number of the next batch */
+    sys::u32 sequence() const {
+        return _seq;
+    }
+
+    size_t pending() const {
+        return _size;
+    }
+
+private:
+    /* Flushes the complete reports only and keeps the incomplete one, everything if there are no complete reports.
+     * The kept events are due when their first one is.
+     */
+    void flush_reports() {
+        if (_open == 0) {
+            flush();
+            return;
+        }
+
+        auto tail = _size - _open;
+        _sink(std::span<const sys::event>{_events, _open}, _seq++);
+        for (size_t i = 0; i < tail; ++i)
+            _events[i] = _events[_open + i];
+        _size      = tail;
+        _last      = _open = 0;
+        _mergeable = false;
+        _deadline  = _open_deadline;
+    }
+
+    /* [_open, _size - 1) is the report closed by the SYN_REPORT at _size - 1, [_last, _open) is the previous one */
+    void end_report() {
+        auto syn           = _size - 1;
+        bool relative_only = _open < syn;
+        for (auto i = _open; relative_only && i < syn; ++i)
+            relative_only = _events[i].type == sys::event_type::relative;
+
+        if (relative_only && _mergeable) {
+            auto end = _open - 1; /* SYN_REPORT of the previous report */
+            for (auto i = _open; i < syn; ++i) {
+                auto& event = _events[i];
+                auto  found = false;
+                for (auto j = _last; j < end && !found; ++j) {
+                    if (_events[j].code.rel == event.code.rel) {
+                        _events[j].value += event.value;
+                        _events[j].time   = event.time;
+                        found             = true;
+                    }
+                }
+                if (!found)
+                    _events[end++] = event;
+            }
+            _events[end++] = _events[syn];
+            _size          = end;
+        }
+        else {
+            _last      = _open;
+            _mergeable = relative_only;
+        }
+        _open = _size;
+    }
+
+    Sink              _sink;
+    sys::nanoseconds  _max_delay;
+    clock::time_point _deadline;
+    clock::time_point _open_deadline; /* Deadline of the first event of the incomplete report */
+    sys::event        _events[capacity];
+    size_t            _size      = 0;
+    size_t            _last      = 0; /* Start of the last complete report */
+    size_t            _open      = 0; /* Start of the incomplete report */
+    bool              _mergeable = false;
+    sys::u32          _seq       = 0;
+};
+
+} // namespace inp
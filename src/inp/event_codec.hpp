@@ -0,0 +1,231 @@
+#pragma once
+
+#include <span>
+
+#include <core/opt.hpp>
+#include <sys/event.hpp>
+
+namespace inp {
+
+/**
+ * @brief Compact wire format for sys::event batches
+ *
+ * A batch is the magic byte, varint sequence number, varint event count and the zigzag varint time of the first
+ * event in microseconds. Every event is the zigzag varint time delta from the previous event in microseconds,
+ * the varint (code << 5 | type) (types above 30 are escaped with 31 and follow as a separate varint) and the zigzag
+ * varint value. A relative move is 3 bytes instead of 24.
+ *
+ * Capture files are a sequence of batches each prefixed with its size as varint.
+ */
+namespace event_codec {
+    inline constexpr sys::u8  magic        = 0xEC;
+    inline constexpr size_t   header_bound = 1 + 5 + 5 + 10;
+    inline constexpr size_t   event_bound  = 10 + 3 + 3 + 5;
+    inline constexpr sys::u16 type_escape  = 31;
+    inline constexpr sys::i64 usec_per_sec = 1000000;
+
+    namespace dtls {
+        inline sys::u8* write_varint(sys::u8* p, sys::u64 v) {
+            while (v >= 0x80) {
+                *p++ = sys::u8(v | 0x80);
+                v >>= 7;
+            }
+            *p++ = sys::u8(v);
+            return p;
+        }
+
+        inline sys::u8* write_zigzag(sys::u8* p, sys::i64 v) {
+            return write_varint(p, (sys::u64(v) << 1) ^ sys::u64(v >> 63));
+        }
+
+        inline core::opt<sys::u64> read_varint(const sys::u8*& p, const sys::u8* e) {
+            sys::u64 v = 0;
+            for (int shift = 0; p != e && shift < 64; shift += 7) {
+                auto b  = *p++;
+                v      |= sys::u64(b & 0x7F) << shift;
+                if (!(b & 0x80))
+                    return v;
+            }
+            return core::null;
+        }
+
+        inline core::opt<sys::i64> read_zigzag(const sys::u8*& p, const sys::u8* e) {
+            auto v = read_varint(p, e);
+            if (!v)
+                return core::null;
+            return sys::i64(*v >> 1) ^ -sys::i64(*v & 1);
+        }
+
+        inline sys::i64 to_usec(const sys::event_time& t) {
+            return sys::i64(t.sec) * usec_per_sec + sys::i64(t.usec);
+        }
+
+        inline sys::event_time from_usec(sys::i64 usec) {
+            auto sec = usec / usec_per_sec;
+            auto rem = usec % usec_per_sec;
+            if (rem < 0) {
+                --sec;
+                rem += usec_per_sec;
+            }
+            return {.sec = time_t(sec), .usec = suseconds_t(rem)};
+        }
+    } // namespace dtls
+
+    inline constexpr size_t encoded_bound(size_t count) {
+        return header_bound + count * event_bound;
+    }
+
+    /* Size of the framed batch is at most this */
+    inline constexpr size_t framed_bound(size_t count) {
+        return 10 + encoded_bound(count);
+    }
+
+    /* Writes the batch to out which must have encoded_bound(events.size()) bytes, returns the batch size */
+    inline size_t encode(std::span<const sys::event> events, sys::u32 seq, sys::u8* out) {
+        auto p = out;
+        *p++   = magic;
+        p      = dtls::write_varint(p, seq);
+        p      = dtls::write_varint(p, events.size());
+
+        auto prev = events.empty() ? sys::i64(0) : dtls::to_usec(events[0].time);
+        p         = dtls::write_zigzag(p, prev);
+
+        for (auto&& event : events) {
+            auto time = dtls::to_usec(event.time);
+            p         = dtls::write_zigzag(p, time - prev);
+            prev      = time;
+
+            auto type = sys::u16(event.type);
+            if (type < type_escape)
+                p = dtls::write_varint(p, sys::u64(event.code.raw) << 5 | type);
+            else {
+                p = dtls::write_varint(p, sys::u64(event.code.raw) << 5 | type_escape);
+                p = dtls::write_varint(p, type);
+            }
+            p = dtls::write_zigzag(p, event.value);
+        }
+        return size_t(p - out);
+    }
+
+    /* Writes the batch prefixed with its size to out which must have framed_bound(events.size()) bytes */
+    inline size_t encode_framed(std::span<const sys::event> events, sys::u32 seq, sys::u8* out) {
+        /* The size prefix is written after the batch, the batch is moved if the prefix is longer than a byte */
+        sys::u8 prefix[10];
+        auto    size = encode(events, seq, out + 1);
+        auto    len  = size_t(dtls::write_varint(prefix, size) - prefix);
+        if (len > 1)
+            __builtin_memmove(out + len, out + 1, size);
+        __builtin_memcpy(out, prefix, len);
+        return len + size;
+    }
+
+    struct batch {
+        sys::u32              seq;
+        std::span<sys::event> events;
+    };
+
+    /* Decodes the batch into buff, null if the data is malformed or has more events than buff.size() */
+    inline core::opt<batch> decode(std::span<const sys::u8> data, std::span<sys::event> buff) {
+        auto p = data.data();
+        auto e = p + data.size();
+        if (p == e || *p++ != magic)
+            return core::null;
+
+        auto seq   = dtls::read_varint(p, e);
+        auto count = dtls::read_varint(p, e);
+        auto base  = dtls::read_zigzag(p, e);
+        if (!seq || !count || !base || *count > buff.size())
+            return core::null;
+
+        auto time = *base;
+        for (size_t i = 0; i < *count; ++i) {
+            auto delta = dtls::read_zigzag(p, e);
+            auto code  = dtls::read_varint(p, e);
+            if (!delta || !code)
+                return core::null;
+
+            auto type = *code & type_escape;
+            if (type == type_escape) {
+                auto t = dtls::read_varint(p, e);
+                if (!t)
+                    return core::null;
+                type = *t;
+            }
+
+            auto value = dtls::read_zigzag(p, e);
+            if (!value)
+                return core::null;
+
+            time += *delta;
+
+            auto& event    = buff[i];
+            event.time     = dtls::from_usec(time);
+            event.type     = sys::event_type(type);
+            event.code.raw = sys::u16(*code >> 5);
+            event.value    = sys::i32(*value);
+        }
+
+        if (p != e)
+            return core::null;
+        return batch{sys::u32(*seq), buff.subspan(0, *count)};
+    }
+
+    /* Pops the next framed batch from data, null at the end or if the frame is truncated */
+    inline core::opt<std::span<const sys::u8>> next_frame(std::span<const sys::u8>& data) {
+        auto p    = data.data();
+        auto e    = p + data.size();
+        auto size = dtls::read_varint(p, e);
+        if (!size || *size > size_t(e - p))
+            return core::null;
+
+        auto frame = std::span{p, size_t(*size)};
+        data       = std::span{p + *size, e};
+        return frame;
+    }
+} // namespace event_codec
+
+/**
+ * @brief Decodes batches of one stream and detects lost ones by the sequence numbers
+ *
+ * Batches which come after a newer one are still decoded and counted as reordered.
+ */
+class event_decoder {
+public:
+    core::opt<event_codec::batch> decode(std::span<const sys::u8> data, std::span<sys::event> buff) {
+        auto res = event_codec::decode(data, buff);
+        if (!res)
+            return core::null;
+
+        if (!_next)
+            _next = res->seq + 1;
+        else {
+            auto gap = sys::i32(res->seq - *_next);
+            if (gap >= 0) {
+                _lost += sys::u32(gap);
+                _next  = res->seq + 1;
+            }
+            else {
+                ++_reordered;
+                if (_lost)
+                    --_lost;
+            }
+        }
+        return res;
+    }
+
+    /* Batches skipped in the sequence numbers and not received later */
+    sys::u64 lost() const {
+        return _lost;
+    }
+
+    sys::u64 reordered() const {
+        return _reordered;
+    }
+
+private:
+    core::opt<sys::u32> _next;
+    sys::u64            _lost      = 0;
+    sys::u64            _reordered = 0;
+};
+
+} // namespace inp
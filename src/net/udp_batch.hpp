@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstring>
+#include <span>
+
+#include <netinet/udp.h>
+#include <sys/socket.h>
+
+#include <net/full_addr_any.hpp>
+
+namespace core::net {
+/* Storage for a batch of up to N datagrams for udp_socket::send_batch/recv_batch
+ * Holds the mmsghdr, iovec, peer address and control buffer of every datagram, the payload buffers belong to the
+ * caller and must stay alive until the batch is sent or received.
+ */
+template <size_t N>
+class udp_batch {
+public:
+    static constexpr size_t control_size = CMSG_SPACE(sizeof(int));
+
+    udp_batch() = default;
+
+    udp_batch(const udp_batch&)            = delete;
+    udp_batch& operator=(const udp_batch&) = delete;
+
+    static constexpr size_t capacity() noexcept {
+        return N;
+    }
+
+    [[nodiscard]]
+    size_t size() const noexcept {
+        return count;
+    }
+
+    [[nodiscard]]
+    bool empty() const noexcept {
+        return count == 0;
+    }
+
+    [[nodiscard]]
+    bool full() const noexcept {
+        return count == N;
+    }
+
+    void clear() noexcept {
+        count = 0;
+    }
+
+    /* Adds a datagram to send to destination, false if the batch is full */
+    bool push(const full_addr_any& destination, const void* buf, size_t size) noexcept {
+        if (full())
+            return false;
+        auto i   = count++;
+        addrs[i] = destination.native();
+        set(i, const_cast<void*>(buf), size, false);
+        return true;
+    }
+
+    template <typename T>
+        requires requires(const T& v) {
+            { v.size() } -> std::convertible_to<size_t>;
+            { v.data() } -> std::convertible_to<const void*>;
+        }
+    bool push(const full_addr_any& destination, const T& data) noexcept {
+        return push(destination, data.data(), data.size() * sizeof(*data.data()));
+    }
+
+    /* Adds a buffer for a datagram to receive, false if the batch is full */
+    bool push(void* buf, size_t max_size) noexcept {
+        if (full())
+            return false;
+        set(count++, buf, max_size, true);
+        return true;
+    }
+
+    /* Size of the i-th received datagram */
+    [[nodiscard]]
+    size_t received(size_t i) const noexcept {
+        return msgs[i].msg_len;
+    }
+
+    [[nodiscard]]
+    full_addr_any source(size_t i) const noexcept {
+        return {addrs[i]};
+    }
+
+    [[nodiscard]]
+    std::span<const char> data(size_t i) const noexcept {
+        return {static_cast<const char*>(iovs[i].iov_base), msgs[i].msg_len};
+    }
+
+    /* With UDP_GRO several datagrams of one flow may be received as one, every segment except the last one has
+     * this size. Equal to the received size otherwise.
+     */
+    [[nodiscard]]
+    size_t segment_size(size_t i) const noexcept {
+        auto& hdr = msgs[i].msg_hdr;
+        for (auto cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(const_cast<msghdr*>(&hdr), cmsg)) {
+            if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+                int size;
+                std::memcpy(&size, CMSG_DATA(cmsg), sizeof(size));
+                return size_t(size);
+            }
+        }
+        return msgs[i].msg_len;
+    }
+
+    /* Headers of the pushed datagrams, starting from the first one */
+    [[nodiscard]]
+    std::span<mmsghdr> headers(size_t first = 0) noexcept {
+        return {msgs + first, count - first};
+    }
+
+    /* The kernel overwrites the address and control lengths on receive */
+    void reset_for_recv() noexcept {
+        for (size_t i = 0; i < count; ++i) {
+            msgs[i].msg_hdr.msg_namelen    = sizeof(addrs[i]);
+            msgs[i].msg_hdr.msg_controllen = control_size;
+            msgs[i].msg_len                = 0;
+        }
+    }
+
+private:
+    void set(size_t i, void* buf, size_t size, bool recv) noexcept {
+        iovs[i] = {.iov_base = buf, .iov_len = size};
+        msgs[i] = {
+            .msg_hdr =
+                {
+                    .msg_name       = &addrs[i],
+                    .msg_namelen    = sizeof(addrs[i]),
+                    .msg_iov        = &iovs[i],
+                    .msg_iovlen     = 1,
+                    .msg_control    = recv ? control[i] : nullptr,
+                    .msg_controllen = recv ? control_size : 0,
+                    .msg_flags      = 0,
+                },
+            .msg_len = 0,
+        };
+    }
+
+    mmsghdr          msgs[N];
+    iovec            iovs[N];
+    sockaddr_storage addrs[N];
+    alignas(cmsghdr) char control[N][control_size];
+    size_t           count = 0;
+};
+} // namespace core::net
@@ -6,6 +6,7 @@
 #include <core/finalizer.hpp>
 #include <net/net_error.hpp>
 #include <net/full_addr_any.hpp>
+#include <net/udp_batch.hpp>
 
 namespace core::net
 {
@@ -19,6 +20,11 @@ public:
     socket_set_blocking_error(int errc): net_error("Cannot setup blocking for socket: errc=" + std::to_string(errc)) {}
 };
 
+class socket_option_error : public net_error {
+public:
+    socket_option_error(int errc): net_error("Cannot set socket option: errno=" + std::to_string(errc)) {}
+};
+
 class address_already_in_use : public net_error {
 public:
     address_already_in_use(const std::string& address): net_error("Socket " + address + " already in use") {}
@@ -87,6 +93,23 @@ public:
             throw socket_set_blocking_error(errno);
     }
 
+    void set_option(int level, int option, int value) {
+        if (::setsockopt(fd, level, option, &value, sizeof(value)) == -1)
+            throw socket_option_error(errno);
+    }
+
+    /* UDP_SEGMENT (GSO): every sent datagram larger than size is split by the kernel (or the NIC) into datagrams of
+     * size bytes, up to 64 segments per send. 0 disables it.
+     */
+    void set_gso_segment(uint16_t size) {
+        set_option(SOL_UDP, UDP_SEGMENT, size);
+    }
+
+    /* UDP_GRO: datagrams of one flow may be received coalesced, see udp_batch::segment_size() */
+    void set_gro(bool enable) {
+        set_option(SOL_UDP, UDP_GRO, enable);
+    }
+
     [[nodiscard]]
     full_addr_any address() const noexcept {
         return {addr};
@@ -122,11 +145,44 @@ public:
 
     recv_result recv(void* buf, size_t max_size) const noexcept {
         sockaddr_storage addr;
-        socklen_t socklen;
+        socklen_t socklen = sizeof(addr);
         auto size = recvfrom(fd, buf, max_size, 0, (struct sockaddr*)&addr, &socklen);
         return {.src = {addr}, .buf = buf, .size = size};
     }
 
+    /* Sends the datagrams with one sendmmsg, returns how many were sent or -1 */
+    int send_batch(std::span<mmsghdr> msgs) const noexcept {
+        return ::sendmmsg(fd, msgs.data(), unsigned(msgs.size()), 0);
+    }
+
+    /* Sends the whole batch, sendmmsg may stop early if the socket buffer is full
+     * Returns the number of sent datagrams, -1 if nothing was sent
+     */
+    template <size_t N>
+    int send_batch(udp_batch<N>& batch) const noexcept {
+        size_t sent = 0;
+        while (sent < batch.size()) {
+            auto rc = send_batch(batch.headers(sent));
+            if (rc <= 0)
+                return sent ? int(sent) : rc;
+            sent += size_t(rc);
+        }
+        return int(sent);
+    }
+
+    /* Receives up to msgs.size() datagrams with one recvmmsg, by default it blocks only until the first one
+     * Returns how many were received or -1
+     */
+    int recv_batch(std::span<mmsghdr> msgs, int flags = MSG_WAITFORONE) const noexcept {
+        return ::recvmmsg(fd, msgs.data(), unsigned(msgs.size()), flags, nullptr);
+    }
+
+    template <size_t N>
+    int recv_batch(udp_batch<N>& batch, int flags = MSG_WAITFORONE) const noexcept {
+        batch.reset_for_recv();
+        return recv_batch(batch.headers(), flags);
+    }
+
     [[nodiscard]]
     int native() const noexcept {
         return fd;
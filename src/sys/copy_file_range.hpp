@@ -0,0 +1,11 @@
+#pragma once
+
+#include <sys/syscall.hpp>
+
+namespace sys
+{
+/* Both fds must be regular files, offsets are nullptr to use the file positions */
+inline auto copy_file_range(fd_t fd_in, off_t* off_in, fd_t fd_out, off_t* off_out, size_t len) {
+    return syscall<size_t>(SYS_copy_file_range, fd_in, off_in, fd_out, off_out, len, 0u);
+}
+} // namespace sys
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <linux/futex.h>
+
+#include <sys/syscall.hpp>
+
+namespace sys {
+/* Sleeps while *addr == expected, returns EAGAIN immediately if it differs */
+inline auto futex_wait(const u32* addr, u32 expected) {
+    return syscall<void>(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, nullptr);
+}
+
+/* Wakes up to count waiters, returns the number of woken waiters */
+inline auto futex_wake(const u32* addr, u32 count) {
+    return syscall<u32>(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count);
+}
+} // namespace sys
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include <sys/map_prot.hpp>
 #include <sys/map_flags.hpp>
 #include <sys/open_flags.hpp>
@@ -59,9 +62,40 @@ inline auto munmap(void* addr, size_t size) {
     return syscall<void>(SYS_munmap, addr, size);
 }
 
+enum class madvise_advice : int {
+    normal     = MADV_NORMAL,
+    random     = MADV_RANDOM,
+    sequential = MADV_SEQUENTIAL,
+    willneed   = MADV_WILLNEED,
+    dontneed   = MADV_DONTNEED,
+    free       = MADV_FREE,
+    hugepage   = MADV_HUGEPAGE,
+    nohugepage = MADV_NOHUGEPAGE,
+};
+
+enum class msync_flag : int {
+    async      = MS_ASYNC,
+    invalidate = MS_INVALIDATE,
+    sync       = MS_SYNC,
+};
+
+inline auto madvise(void* addr, size_t len, madvise_advice advice) {
+    return syscall<void>(SYS_madvise, addr, len, int(advice));
+}
+
+inline auto msync(void* addr, size_t len, msync_flag flag = msync_flag::sync) {
+    return syscall<void>(SYS_msync, addr, len, int(flag));
+}
+
 inline auto mremap(void* old_addr, size_t old_len, size_t new_len, remap_flags flags = {}, void* new_addr = nullptr) {
     return syscall<void*>(SYS_mremap, old_addr, old_len, new_len, flags.value, new_addr);
 }
+
+/* Alignment required by madvise/msync, not always 4096 (e.g. 16K or 64K pages on arm64) */
+inline size_t page_size() noexcept {
+    static const size_t size = size_t(::sysconf(_SC_PAGESIZE));
+    return size;
+}
 } // namespace sys
 
 #undef fwd
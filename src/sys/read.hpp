@@ -1,5 +1,8 @@
 #pragma once
 
+#include <span>
+#include <sys/uio.h>
+
 #include <core/array.hpp>
 #include <core/concepts/trivial_span_like.hpp>
 #include <sys/syscall.hpp>
@@ -11,6 +14,15 @@ struct read_provider {
         return syscall<size_t, Trap>(SYS_read, fd, output, size);
     }
 
+    /* Reads at offset without changing the file position */
+    auto pread(fd_t fd, void* output, size_t size, off_t offset) {
+        return syscall<size_t, Trap>(SYS_pread64, fd, output, size, offset);
+    }
+
+    auto preadv(fd_t fd, std::span<const iovec> iov, off_t offset) {
+        return syscall<size_t, Trap>(SYS_preadv, fd, iov.data(), iov.size(), offset, 0);
+    }
+
     /* Return ENAVAIL if read() returns less than sizeof(T) */
     template <typename T> requires core::trivial<T>
     auto read(fd_t fd) {
@@ -76,6 +88,15 @@ auto read(fd_t fd, core::trivial_span_like auto& output) {
     return read_provider<trap_async_cancel>{}.read(fd, output);
 }
 
+template <typename T>
+auto pread(fd_t fd, T* output, size_t size, off_t offset) {
+    return read_provider<trap_async_cancel>{}.pread(fd, output, size, offset);
+}
+
+inline auto preadv(fd_t fd, std::span<const iovec> iov, off_t offset) {
+    return read_provider<trap_async_cancel>{}.preadv(fd, iov, offset);
+}
+
 template <typename T>
 auto read_no_cp(fd_t fd, T* output, size_t size) {
     return read_provider<void>{}.read(fd, output, size);
@@ -96,4 +117,13 @@ auto read_no_cp(fd_t fd, T (&output)[S]) {
 auto read_no_cp(fd_t fd, core::trivial_span_like auto& output) {
     return read_provider<void>{}.read(fd, output);
 }
+
+template <typename T>
+auto pread_no_cp(fd_t fd, T* output, size_t size, off_t offset) {
+    return read_provider<void>{}.pread(fd, output, size, offset);
+}
+
+inline auto preadv_no_cp(fd_t fd, std::span<const iovec> iov, off_t offset) {
+    return read_provider<void>{}.preadv(fd, iov, offset);
+}
 } // namespace sys
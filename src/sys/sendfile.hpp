@@ -0,0 +1,11 @@
+#pragma once
+
+#include <sys/syscall.hpp>
+
+namespace sys
+{
+/* in_fd must support mmap-like operations (regular file), offset is nullptr to use the file position */
+inline auto sendfile(fd_t out_fd, fd_t in_fd, off_t* offset, size_t count) {
+    return syscall<size_t>(SYS_sendfile, out_fd, in_fd, offset, count);
+}
+} // namespace sys
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <sys/splice_flags.hpp>
+#include <sys/syscall.hpp>
+
+namespace sys
+{
+/* One of fds must be a pipe, offsets are nullptr for pipes and to use the file position */
+inline auto splice(fd_t fd_in, off_t* off_in, fd_t fd_out, off_t* off_out, size_t len, splice_flags flags = {}) {
+    return syscall<size_t>(SYS_splice, fd_in, off_in, fd_out, off_out, len, flags.value);
+}
+} // namespace sys
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+
+#include <core/array.hpp>
+#include <core/tuple.hpp>
+#include <sys/basic_types.hpp>
+
+namespace sys
+{
+/*
+ * [[[codegen start]]]
+ * Generated with:
+ * ./build-deb/codegen/flags splice_flag splice_flags uint move=0x1 nonblock=0x2 more=0x4 gift=0x8
+ */
+
+enum class splice_flag : uint {
+    move     = 0x1,
+    nonblock = 0x2,
+    more     = 0x4,
+    gift     = 0x8,
+};
+
+struct splice_flags {
+    using enum splice_flag;
+
+    constexpr splice_flags() = default;
+    constexpr splice_flags(splice_flag ivalue): value(uint(ivalue)) {}
+
+    constexpr splice_flags operator|(splice_flags flag) const {
+        return splice_flag(uint(value | flag.value));
+    }
+
+    constexpr splice_flags operator&(splice_flags flag) const {
+        return splice_flag(uint(value & flag.value));
+    }
+
+    constexpr splice_flags& operator|=(splice_flags flag) {
+        value = uint(value | flag.value);
+        return *this;
+    }
+
+    constexpr bool test(splice_flags flags) const {
+        return value & flags.value;
+    }
+
+    explicit constexpr operator bool() const {
+        return value;
+    }
+
+    constexpr void unset(splice_flags flags) {
+        value &= uint(~flags.value);
+    }
+
+    constexpr std::string to_string() const {
+        constexpr core::array flags = {
+            core::tuple{splice_flag::move, std::string_view("move")},
+            core::tuple{splice_flag::nonblock, std::string_view("nonblock")},
+            core::tuple{splice_flag::more, std::string_view("more")},
+            core::tuple{splice_flag::gift, std::string_view("gift")},
+        };
+        std::string res;
+        for (auto&& [f, s] : flags) {
+            if (uint(value) & uint(f)) {
+                res.append(s);
+                res.append(" | ");
+            }
+        }
+        if (res.size() > 2)
+            res.resize(res.size() - 2);
+        return res;
+    }
+
+    uint value;
+};
+
+inline constexpr splice_flags operator|(splice_flag lhs, splice_flag rhs) {
+    return splice_flag(uint(lhs) | uint(rhs));
+}
+
+/* [[[codegen end]]] */
+} // namespace sys
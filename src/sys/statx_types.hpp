@@ -302,6 +302,9 @@ struct statx_info {
     u32             rdev_minor;
     u32             dev_major;
     u32             dev_minor;
-    u64             __pad1[14];
+    u64             mnt_id;
+    u32             dio_mem_align;    /* Buffer alignment for O_DIRECT, 0 if unsupported */
+    u32             dio_offset_align; /* Offset and length alignment for O_DIRECT */
+    u64             __pad1[12];
 };
 } // namespace sys
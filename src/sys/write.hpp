@@ -1,5 +1,8 @@
 #pragma once
 
+#include <span>
+#include <sys/uio.h>
+
 #include <core/concepts/trivial_span_like.hpp>
 #include <sys/syscall.hpp>
 
@@ -11,6 +14,19 @@ struct write_provider {
         return syscall<size_t, Trap>(SYS_write, fd, data, size);
     }
 
+    /* Writes at offset without changing the file position */
+    auto pwrite(fd_t fd, const void* data, size_t size, off_t offset) {
+        return syscall<size_t, Trap>(SYS_pwrite64, fd, data, size, offset);
+    }
+
+    auto writev(fd_t fd, std::span<const iovec> iov) {
+        return syscall<size_t, Trap>(SYS_writev, fd, iov.data(), iov.size());
+    }
+
+    auto pwritev(fd_t fd, std::span<const iovec> iov, off_t offset) {
+        return syscall<size_t, Trap>(SYS_pwritev, fd, iov.data(), iov.size(), offset, 0);
+    }
+
     /* Return ENAVAIL if write returns size less then sizeof(data) */
     auto write(fd_t fd, const core::trivial auto& data) {
         auto res = write(fd, &data, sizeof(data));
@@ -45,6 +61,19 @@ auto write(fd_t fd, const core::trivial_span_like auto& data) {
     return write_provider<trap_async_cancel>{}.write(fd, data);
 }
 
+template <typename T>
+auto pwrite(fd_t fd, const T* data, size_t size, off_t offset) {
+    return write_provider<trap_async_cancel>{}.pwrite(fd, data, size, offset);
+}
+
+inline auto writev(fd_t fd, std::span<const iovec> iov) {
+    return write_provider<trap_async_cancel>{}.writev(fd, iov);
+}
+
+inline auto pwritev(fd_t fd, std::span<const iovec> iov, off_t offset) {
+    return write_provider<trap_async_cancel>{}.pwritev(fd, iov, offset);
+}
+
 template <typename T>
 auto write_no_cp(fd_t fd, const T* data, size_t size) {
     return write_provider<void>{}.write(fd, data, size);
@@ -57,4 +86,17 @@ auto write_no_cp(fd_t fd, const core::trivial auto& data) {
 auto write_no_cp(fd_t fd, const core::trivial_span_like auto& data) {
     return write_provider<void>{}.write(fd, data);
 }
+
+template <typename T>
+auto pwrite_no_cp(fd_t fd, const T* data, size_t size, off_t offset) {
+    return write_provider<void>{}.pwrite(fd, data, size, offset);
+}
+
+inline auto writev_no_cp(fd_t fd, std::span<const iovec> iov) {
+    return write_provider<void>{}.writev(fd, iov);
+}
+
+inline auto pwritev_no_cp(fd_t fd, std::span<const iovec> iov, off_t offset) {
+    return write_provider<void>{}.pwritev(fd, iov, offset);
+}
 } // namespace sys
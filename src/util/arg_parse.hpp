@@ -1,5 +1,6 @@
 #pragma once
 
+#include <iterator>
 #include <list>
 #include <string>
 #include <vector>
@@ -10,6 +11,7 @@
 #include <core/ct_str.hpp>
 #include <core/enum_introspect.hpp>
 #include <core/opt.hpp>
+#include <core/parse_many.hpp>
 #include <core/var.hpp>
 #include <core/ston.hpp>
 
@@ -381,6 +383,43 @@ namespace details
         }
     };
 
+    /* Comma separated list: --ids=1,2,3
+     * Plain decimal lists go through parse_many, lists with 0x, 0b or 0 prefixed elements are parsed element by
+     * element as the number arg. Empty elements are rejected.
+     */
+    template <number T>
+    struct arg_cast<std::vector<T>> {
+        std::vector<T> operator()(const opt<std::string_view>& value, std::string& log) {
+            if (!value)
+                throw missing_arg_error(build_str("Missing number list: ", log, " <-- HERE"));
+
+            std::vector<std::string_view> items;
+            bool                          prefixed = false;
+            for (size_t start = 0;; start += items.back().size() + 1) {
+                auto end = value->find(',', start);
+                items.push_back(value->substr(start, end == std::string_view::npos ? end : end - start));
+                if (items.back().empty())
+                    throw missing_arg_error(build_str("Empty list element at ", start, ": ", log, " <-- HERE"));
+                if constexpr (!floating_point<T>)
+                    prefixed = prefixed || (items.back().size() > 1 && items.back()[0] == '0');
+                if (end == std::string_view::npos)
+                    break;
+            }
+
+            std::vector<T> result;
+            if (prefixed) {
+                for (auto item : items)
+                    result.push_back(arg_cast<T>{}(item, log));
+                return result;
+            }
+
+            auto res = core::parse_many<T>(*value, std::back_inserter(result), core::array{','});
+            if (!res)
+                throw missing_arg_error(build_str("Invalid number at ", res.errors.front().pos, ": ", log, " <-- HERE"));
+            return result;
+        }
+    };
+
     template <typename... Ts>
     void parse_commands_var(std::list<std::string_view>& args,
                             var<Ts...>&                  result,
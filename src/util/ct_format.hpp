@@ -0,0 +1,362 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include <core/concepts/any_of.hpp>
+#include <core/concepts/convertible_to.hpp>
+#include <core/concepts/floating_point.hpp>
+#include <core/ct_str.hpp>
+#include <core/traits/conditional.hpp>
+#include <core/traits/decay.hpp>
+#include <core/traits/remove_cv.hpp>
+#include <core/utility/int_seq.hpp>
+
+#include "basic_types.hpp"
+#include "print.hpp"
+
+/* Format strings parsed at compile time
+ *
+ * Placeholders:
+ *   {}      default representation
+ *   {x} {X} lowercase/uppercase hex (integers, pointers, floats), fallback types are printed with std::hex
+ *   {b} {o} binary/octal (integers)
+ *   {.N}    fixed notation with N digits after the point (floats)
+ *   {e} {f} {g} scientific/fixed/general notation, may be combined with precision: {.3e}
+ *   {{ }}   escaped braces
+ *
+ * Arguments are written with std::to_chars directly into the output buffer.
+ * The maximum output size is computed before writing, so the buffer grows at most once.
+ * Types which have no ct_formatter specialization are printed with util::print_any into a temporary string.
+ */
+
+namespace util {
+struct ct_fmt_spec {
+    char type      = 0;
+    int  precision = -1;
+};
+
+/* Specialize with
+ *   static size_t max_size(const T& value, ct_fmt_spec spec);
+ *   static char*  write(char* out, const T& value, ct_fmt_spec spec);
+ * write() must not produce more than max_size() chars
+ */
+template <typename T>
+struct ct_formatter;
+
+template <typename T>
+concept ct_formattable = requires(const T& v, char* out, ct_fmt_spec spec) {
+    { ct_formatter<T>::max_size(v, spec) } -> core::convertible_to<size_t>;
+    { ct_formatter<T>::write(out, v, spec) } -> core::convertible_to<char*>;
+};
+
+/* Runtime string or core::ct_str */
+template <typename T>
+concept format_string = core::convertible_to<T, std::string_view>;
+
+template <typename T>
+concept format_buffer = requires(T& buf, size_t size) {
+    { buf.data() } -> core::convertible_to<char*>;
+    { buf.size() } -> core::convertible_to<size_t>;
+    buf.resize(size);
+};
+
+template <>
+struct ct_formatter<std::string_view> {
+    static size_t max_size(std::string_view value, ct_fmt_spec) {
+        return value.size();
+    }
+
+    static char* write(char* out, std::string_view value, ct_fmt_spec) {
+        std::memcpy(out, value.data(), value.size());
+        return out + value.size();
+    }
+};
+
+template <>
+struct ct_formatter<bool> {
+    static size_t max_size(bool, ct_fmt_spec) {
+        return 5;
+    }
+
+    static char* write(char* out, bool value, ct_fmt_spec) {
+        return value ? ct_formatter<std::string_view>::write(out, "true", {}) : ct_formatter<std::string_view>::write(out, "false", {});
+    }
+};
+
+namespace dtls {
+    template <typename T>
+    concept ct_fmt_char = core::any_of<core::remove_cv<T>, char, signed char, unsigned char>;
+
+    /* Integers supported by std::to_chars */
+    template <typename T>
+    concept ct_fmt_int = ct_fmt_char<T> || core::any_of<core::remove_cv<T>,
+                                                        short,
+                                                        unsigned short,
+                                                        int,
+                                                        unsigned int,
+                                                        long,
+                                                        unsigned long,
+                                                        long long,
+                                                        unsigned long long>;
+
+    inline char* ct_fmt_upper(char* begin, char* end) {
+        for (auto p = begin; p != end; ++p)
+            if (*p >= 'a' && *p <= 'f')
+                *p = char(*p - 'a' + 'A');
+        return end;
+    }
+
+    constexpr int ct_fmt_base(char type) {
+        switch (type) {
+        case 'x':
+        case 'X': return 16;
+        case 'b': return 2;
+        case 'o': return 8;
+        default: return 10;
+        }
+    }
+} // namespace dtls
+
+/* Chars are printed as is, unless a numeric spec is given */
+template <dtls::ct_fmt_int T>
+struct ct_formatter<T> {
+    static size_t max_size(T, ct_fmt_spec spec) {
+        constexpr size_t bits = sizeof(T) * 8;
+        switch (dtls::ct_fmt_base(spec.type)) {
+        case 16: return bits / 4 + 1;
+        case 2: return bits + 1;
+        case 8: return bits / 3 + 2;
+        default: return std::numeric_limits<T>::digits10 + 2;
+        }
+    }
+
+    static char* write(char* out, T value, ct_fmt_spec spec) {
+        if constexpr (dtls::ct_fmt_char<T>) {
+            if (spec.type == 0) {
+                *out = char(value);
+                return out + 1;
+            }
+        }
+
+        auto base = dtls::ct_fmt_base(spec.type);
+        auto end  = std::to_chars(out, out + max_size(value, spec), value, base).ptr;
+        return spec.type == 'X' ? dtls::ct_fmt_upper(out, end) : end;
+    }
+};
+
+/* Default is the same as std::ostream: general notation with 6 significant digits */
+template <core::floating_point T>
+struct ct_formatter<T> {
+    static size_t max_size(T, ct_fmt_spec spec) {
+        auto precision = size_t(spec.precision < 0 ? 6 : spec.precision);
+        switch (spec.type) {
+        case 'x':
+        case 'X': return precision + 32;
+        case 0:
+            if (spec.precision < 0)
+                return 32;
+            [[fallthrough]];
+        case 'f': return size_t(std::numeric_limits<T>::max_exponent10) + precision + 4;
+        default: return precision + 32;
+        }
+    }
+
+    static char* write(char* out, T value, ct_fmt_spec spec) {
+        auto last = out + max_size(value, spec);
+        auto prec = spec.precision < 0 ? 6 : spec.precision;
+
+        switch (spec.type) {
+        case 'e': return std::to_chars(out, last, value, std::chars_format::scientific, prec).ptr;
+        case 'f': return std::to_chars(out, last, value, std::chars_format::fixed, prec).ptr;
+        case 'g': return std::to_chars(out, last, value, std::chars_format::general, prec).ptr;
+        case 'x':
+        case 'X': {
+            auto end = spec.precision < 0 ? std::to_chars(out, last, value, std::chars_format::hex).ptr
+                                          : std::to_chars(out, last, value, std::chars_format::hex, prec).ptr;
+            return spec.type == 'X' ? dtls::ct_fmt_upper(out, end) : end;
+        }
+        default:
+            return spec.precision < 0 ? std::to_chars(out, last, value, std::chars_format::general, 6).ptr
+                                      : std::to_chars(out, last, value, std::chars_format::fixed, prec).ptr;
+        }
+    }
+};
+
+template <typename T>
+struct ct_formatter<T*> {
+    static size_t max_size(const T*, ct_fmt_spec) {
+        return sizeof(void*) * 2 + 2;
+    }
+
+    static char* write(char* out, const T* value, ct_fmt_spec) {
+        out[0] = '0';
+        out[1] = 'x';
+        return std::to_chars(out + 2, out + max_size(value, {}), reinterpret_cast<uintptr_t>(value), 16).ptr;
+    }
+};
+
+namespace dtls {
+    void ct_format_error(const char* message); /* Not constexpr: calling it from the parser fails compilation */
+
+    template <size_t N>
+    struct ct_fmt_parsed {
+        char        text[N + 1]{};     /* Unescaped literal text */
+        size_t      lit_end[N + 1]{};  /* Literal i is text[lit_end[i - 1]..lit_end[i]) */
+        ct_fmt_spec specs[N + 1]{};    /* Spec of the placeholder after literal i */
+        size_t      text_size = 0;
+        size_t      args      = 0;
+    };
+
+    constexpr bool ct_fmt_digit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    constexpr ct_fmt_spec ct_fmt_parse_spec(const char* begin, const char* end) {
+        ct_fmt_spec spec;
+        auto        p = begin;
+
+        if (p != end && *p == '.') {
+            ++p;
+            if (p == end || !ct_fmt_digit(*p))
+                ct_format_error("precision expected after '.'");
+            spec.precision = 0;
+            while (p != end && ct_fmt_digit(*p))
+                spec.precision = spec.precision * 10 + (*p++ - '0');
+        }
+
+        if (p != end) {
+            switch (*p) {
+            case 'x':
+            case 'X':
+            case 'b':
+            case 'o':
+            case 'e':
+            case 'f':
+            case 'g': spec.type = *p++; break;
+            default: ct_format_error("unknown format spec");
+            }
+        }
+
+        if (p != end)
+            ct_format_error("unexpected chars after format spec");
+
+        return spec;
+    }
+
+    template <size_t N>
+    constexpr ct_fmt_parsed<N> ct_fmt_parse(const char* str) {
+        ct_fmt_parsed<N> res;
+
+        for (size_t i = 0; i < N; ++i) {
+            auto c = str[i];
+            if (c == '{') {
+                if (i + 1 < N && str[i + 1] == '{') {
+                    res.text[res.text_size++] = '{';
+                    ++i;
+                    continue;
+                }
+
+                auto spec_start = i + 1;
+                while (++i < N && str[i] != '}')
+                    if (str[i] == '{')
+                        ct_format_error("'{' inside of placeholder");
+                if (i == N)
+                    ct_format_error("unterminated placeholder");
+
+                res.lit_end[res.args] = res.text_size;
+                res.specs[res.args]   = ct_fmt_parse_spec(str + spec_start, str + i);
+                ++res.args;
+            }
+            else if (c == '}') {
+                if (i + 1 == N || str[i + 1] != '}')
+                    ct_format_error("unmatched '}', use '}}'");
+                res.text[res.text_size++] = '}';
+                ++i;
+            }
+            else
+                res.text[res.text_size++] = c;
+        }
+
+        res.lit_end[res.args] = res.text_size;
+        return res;
+    }
+
+    template <char... Cs>
+    inline constexpr auto ct_fmt = ct_fmt_parse<sizeof...(Cs)>(core::ct_str<Cs...>::_storage);
+
+    /* Turns an argument into something ct_formatter can write */
+    template <ct_fmt_spec Spec, typename T>
+    decltype(auto) ct_fmt_prepare(const T& value) {
+        if constexpr (core::convertible_to<const T&, std::string_view>)
+            return std::string_view(value);
+        else if constexpr (ct_formattable<T>)
+            return (value);
+        else {
+            std::ostringstream ss;
+            if constexpr (Spec.type == 'x' || Spec.type == 'X')
+                ss << std::hex;
+            print_any(ss, value);
+            return ss.str();
+        }
+    }
+
+    template <typename T>
+    using ct_fmt_arg_t = core::conditional<core::convertible_to<const T&, std::string_view>, std::string_view, T>;
+
+    template <auto& P, size_t I>
+    char* ct_fmt_put_literal(char* out) {
+        constexpr auto begin = I == 0 ? 0 : P.lit_end[I - 1];
+        constexpr auto size  = P.lit_end[I] - begin;
+        if constexpr (size != 0)
+            std::memcpy(out, P.text + begin, size);
+        return out + size;
+    }
+
+    template <auto& P, size_t... Is>
+    char* ct_fmt_write(char* out, core::idx_seq<Is...>, const auto&... args) {
+        ((out = ct_fmt_put_literal<P, Is>(out), out = ct_formatter<ct_fmt_arg_t<core::decay<decltype(args)>>>::write(out, args, P.specs[Is])), ...);
+        return ct_fmt_put_literal<P, sizeof...(Is)>(out);
+    }
+
+    template <auto& P, size_t... Is>
+    void ct_fmt_append(format_buffer auto& buf, core::idx_seq<Is...> idxs, const auto&... args) {
+        auto pos = size_t(buf.size());
+        auto max = P.text_size + (size_t(0) + ... + ct_formatter<ct_fmt_arg_t<core::decay<decltype(args)>>>::max_size(args, P.specs[Is]));
+
+        if constexpr (requires { buf.resize_and_overwrite(size_t(0), [](char*, size_t) { return size_t(0); }); }) {
+            buf.resize_and_overwrite(pos + max, [&](char* data, size_t) { return size_t(ct_fmt_write<P>(data + pos, idxs, args...) - data); });
+        }
+        else {
+            buf.resize(pos + max);
+            auto end = ct_fmt_write<P>(buf.data() + pos, idxs, args...);
+            buf.resize(size_t(end - buf.data()));
+        }
+    }
+
+    template <auto& P, size_t... Is>
+    void ct_fmt_to(format_buffer auto& buf, core::idx_seq<Is...> idxs, const auto&... args) {
+        ct_fmt_append<P>(buf, idxs, ct_fmt_prepare<P.specs[Is]>(args)...);
+    }
+} // namespace dtls
+
+/* Appends formatted string to buf */
+template <char... Cs, typename... Ts>
+void format_to(format_buffer auto& buf, core::ct_str<Cs...>, Ts&&... args) {
+    constexpr auto& parsed = dtls::ct_fmt<Cs...>;
+    static_assert(parsed.args == sizeof...(Ts), "Number of placeholders does not match number of arguments");
+    dtls::ct_fmt_to<parsed>(buf, core::make_idx_seq<sizeof...(Ts)>(), args...);
+}
+
+template <char... Cs, typename... Ts>
+std::string format(core::ct_str<Cs...> format_str, Ts&&... args) {
+    std::string result;
+    format_to(result, format_str, args...);
+    return result;
+}
+} // namespace util
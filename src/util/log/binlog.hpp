@@ -0,0 +1,495 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <core/byteconv.hpp>
+#include <core/concepts/floating_point.hpp>
+#include <core/concepts/same_as.hpp>
+#include <core/ct_str.hpp>
+#include <core/io/file.hpp>
+#include <core/io/mmap.hpp>
+#include <core/small_vector.hpp>
+
+#include <util/ct_format.hpp>
+#include <util/log/log_handler_base.hpp>
+
+/* Binary log
+ *
+ * Records keep an id of the format string and raw argument bytes, text is produced offline by binlog_reader.
+ * Format strings with argument types are registered once per process and stored in the dictionary section of the log.
+ *
+ * Layout:
+ *   binlog_header
+ *   dictionary: entries of {u16 format size, u8 args count, binlog_arg types[args count], format chars}
+ *   ring of 64-byte slots: {u64 start, 56 bytes of payload}
+ *
+ * Record payload: {u32 payload size, u32 format id, u64 time in ns, u8 level, arguments serialized with core::to_bytes}
+ * Record occupies one or more consecutive slots, each slot keeps the absolute index of the first slot of its record.
+ * Reader accepts only records whose slots all have the same start, so records overwritten by
+ * the ring or not completed (crash in the middle of a write) are skipped.
+ */
+
+namespace util {
+enum class binlog_arg : u8 { i8 = 0, u8, i16, u16, i32, u32, i64, u64, f32, f64, boolean, chr, ptr, str };
+
+struct binlog_header {
+    static constexpr char magic_value[8] = {'t', 'b', 'c', 'b', 'l', 'o', 'g', '\0'};
+    static constexpr u32  version_value  = 1;
+
+    char magic[8];
+    u32  version;
+    u32  slot_size;
+    u64  slots;
+    u64  dict_size;
+    u64  dict_used;  /* Bytes of the dictionary in use */
+    u64  dict_count; /* Number of formats in the dictionary */
+    u64  write_slot; /* Absolute index of the next slot */
+};
+
+struct binlog_record {
+    std::chrono::system_clock::time_point time;
+    log_level                             level;
+    std::string                           msg;
+};
+
+namespace dtls {
+    inline constexpr size_t binlog_slot_size    = 64;
+    inline constexpr size_t binlog_slot_payload = binlog_slot_size - sizeof(u64);
+    inline constexpr size_t binlog_header_size  = (sizeof(binlog_header) + binlog_slot_size - 1) / binlog_slot_size * binlog_slot_size;
+    inline constexpr u64    binlog_no_start     = ~u64(0);
+
+    template <typename T>
+    constexpr binlog_arg binlog_arg_of() {
+        using U = core::decay<T>;
+        if constexpr (core::same_as<U, bool>)
+            return binlog_arg::boolean;
+        else if constexpr (core::same_as<U, char>)
+            return binlog_arg::chr;
+        else if constexpr (core::same_as<U, float>)
+            return binlog_arg::f32;
+        else if constexpr (core::floating_point<U>)
+            return binlog_arg::f64;
+        else if constexpr (ct_fmt_int<U>) {
+            constexpr bool s = U(-1) < U(0);
+            if constexpr (sizeof(U) == 1)
+                return s ? binlog_arg::i8 : binlog_arg::u8;
+            else if constexpr (sizeof(U) == 2)
+                return s ? binlog_arg::i16 : binlog_arg::u16;
+            else if constexpr (sizeof(U) == 4)
+                return s ? binlog_arg::i32 : binlog_arg::u32;
+            else
+                return s ? binlog_arg::i64 : binlog_arg::u64;
+        }
+        else if constexpr (core::convertible_to<const U&, std::string_view>)
+            return binlog_arg::str;
+        else if constexpr (requires(U v) { static_cast<const void*>(v); })
+            return binlog_arg::ptr;
+        else
+            return binlog_arg::str; /* Formatted with print_any */
+    }
+
+    void binlog_serialize(const auto& value, auto& out) {
+        using U         = core::decay<decltype(value)>;
+        constexpr auto arg = binlog_arg_of<U>();
+
+        if constexpr (arg == binlog_arg::f64 && !core::same_as<U, double>)
+            core::to_bytes(f64(value), out);
+        else if constexpr (arg == binlog_arg::ptr)
+            core::to_bytes(u64(reinterpret_cast<uintptr_t>(static_cast<const void*>(value))), out);
+        else if constexpr (arg == binlog_arg::str && core::convertible_to<const U&, std::string_view>)
+            core::to_bytes(std::string_view(value), out);
+        else if constexpr (arg == binlog_arg::str)
+            core::to_bytes(std::string_view(util::format(CT_STR("{}"), value)), out);
+        else
+            core::to_bytes(value, out);
+    }
+
+    struct binlog_format {
+        std::string_view        format;
+        std::vector<binlog_arg> args;
+    };
+
+    struct binlog_registry {
+        std::mutex                 mtx;
+        std::vector<binlog_format> formats;
+
+        static binlog_registry& instance() {
+            static binlog_registry registry;
+            return registry;
+        }
+
+        u32 add(std::string_view format, std::vector<binlog_arg> args) {
+            std::lock_guard lock{mtx};
+            formats.push_back({format, core::mov(args)});
+            return u32(formats.size() - 1);
+        }
+    };
+
+    /* Process-wide id of the format string with argument types */
+    template <typename Format, typename... Ts>
+    u32 binlog_format_id() {
+        static const u32 id = binlog_registry::instance().add(Format{}, {binlog_arg_of<Ts>()...});
+        return id;
+    }
+} // namespace dtls
+
+/* Writes records into memory prepared by the constructor, usually a shared file mapping */
+class binlog_writer {
+public:
+    binlog_writer(std::span<char> memory, size_t dict_size): _memory(memory) {
+        if (memory.size() < dtls::binlog_header_size + dict_size + dtls::binlog_slot_size)
+            throw std::invalid_argument("binlog_writer: memory is too small");
+
+        auto slots = (memory.size() - dtls::binlog_header_size - dict_size) / dtls::binlog_slot_size;
+        std::memset(memory.data(), 0, dtls::binlog_header_size + dict_size);
+        std::memset(memory.data() + dtls::binlog_header_size + dict_size, 0xff, slots * dtls::binlog_slot_size);
+
+        auto& h = header();
+        std::memcpy(h.magic, binlog_header::magic_value, sizeof(h.magic));
+        h.version   = binlog_header::version_value;
+        h.slot_size = u32(dtls::binlog_slot_size);
+        h.slots     = slots;
+        h.dict_size = dict_size;
+        _slots      = memory.data() + dtls::binlog_header_size + dict_size;
+    }
+
+    binlog_writer(const binlog_writer&)            = delete;
+    binlog_writer& operator=(const binlog_writer&) = delete;
+
+    template <char... Cs, typename... Ts>
+    void write(log_level level, core::ct_str<Cs...>, const Ts&... args) {
+        static_assert(dtls::ct_fmt<Cs...>.args == sizeof...(Ts), "Number of placeholders does not match number of arguments");
+
+        auto id = dtls::binlog_format_id<core::ct_str<Cs...>, core::decay<Ts>...>();
+        if (id >= _dict_count.load(std::memory_order_acquire) && !sync_dictionary(id)) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        core::small_vector<char, 192> payload;
+        core::to_bytes(u32(0), payload);
+        core::to_bytes(id, payload);
+        core::to_bytes(u64(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count()), payload);
+        core::to_bytes(u8(level), payload);
+        (dtls::binlog_serialize(args, payload), ...);
+
+        auto size = u32(payload.size());
+        std::memcpy(payload.data(), &size, sizeof(size));
+        commit(payload.data(), payload.size());
+    }
+
+    /* Runtime format strings are formatted immediately */
+    template <typename... Ts>
+    void write(log_level level, std::string_view format_str, const Ts&... args) {
+        write(level, CT_STR("{}"), util::format(format_str, args...));
+    }
+
+    /* Number of records which did not fit into the ring or the dictionary */
+    [[nodiscard]]
+    u64 dropped() const {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    binlog_header& header() const {
+        return *reinterpret_cast<binlog_header*>(_memory.data());
+    }
+
+    /* Returns false if the dictionary is full */
+    bool sync_dictionary(u32 id) {
+        auto& registry = dtls::binlog_registry::instance();
+
+        std::lock_guard dict_lock{_dict_mtx};
+        std::lock_guard registry_lock{registry.mtx};
+
+        auto& h    = header();
+        auto  dict = _memory.data() + dtls::binlog_header_size;
+        for (auto i = _dict_count.load(std::memory_order_relaxed); i <= id; ++i) {
+            auto& [format, args] = registry.formats[i];
+            auto entry_size      = sizeof(u16) + sizeof(u8) + args.size() + format.size();
+            if (h.dict_used + entry_size > h.dict_size)
+                return false;
+
+            auto p = dict + h.dict_used;
+            auto n = u16(format.size());
+            std::memcpy(p, &n, sizeof(n));
+            p[2] = char(args.size());
+            std::memcpy(p + 3, args.data(), args.size());
+            std::memcpy(p + 3 + args.size(), format.data(), format.size());
+            h.dict_used += entry_size;
+        }
+
+        h.dict_count = id + 1;
+        _dict_count.store(id + 1, std::memory_order_release);
+        return true;
+    }
+
+    void commit(const char* data, size_t size) {
+        auto& h      = header();
+        auto  nslots = (size + dtls::binlog_slot_payload - 1) / dtls::binlog_slot_payload;
+        if (nslots > h.slots) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        auto start = std::atomic_ref(h.write_slot).fetch_add(nslots, std::memory_order_relaxed);
+
+        for (size_t i = 0; i < nslots; ++i) {
+            auto slot  = _slots + ((start + i) % h.slots) * dtls::binlog_slot_size;
+            auto chunk = std::min(size - i * dtls::binlog_slot_payload, dtls::binlog_slot_payload);
+
+            std::atomic_ref(*reinterpret_cast<u64*>(slot)).store(dtls::binlog_no_start, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            std::memcpy(slot + sizeof(u64), data + i * dtls::binlog_slot_payload, chunk);
+            std::atomic_ref(*reinterpret_cast<u64*>(slot)).store(start, std::memory_order_release);
+        }
+    }
+
+    std::span<char>  _memory;
+    char*            _slots;
+    std::mutex       _dict_mtx;
+    std::atomic<u64> _dict_count = 0;
+    std::atomic<u64> _dropped    = 0;
+};
+
+/* Binary log in a file, size of the file is fixed */
+class binlog {
+public:
+    static constexpr size_t default_size      = 64 * 1024 * 1024;
+    static constexpr size_t default_dict_size = 1024 * 1024;
+
+    binlog(const std::string& path, size_t size = default_size, size_t dict_size = default_dict_size):
+        _map(core::io::file::open(path, sys::openflag::read_write | sys::openflag::create | sys::openflag::trunc),
+             size,
+             core::io::map_flags::shared,
+             core::io::map_prots::read | core::io::map_prots::write),
+        _writer(std::span(_map.data<char>(), _map.size()), dict_size) {}
+
+    void write(log_level level, format_string auto format_str, const auto&... args) {
+        _writer.write(level, format_str, args...);
+    }
+
+    [[nodiscard]]
+    u64 dropped() const {
+        return _writer.dropped();
+    }
+
+private:
+    core::io::mmap<core::io::file> _map;
+    binlog_writer                  _writer;
+};
+
+/* Decodes records written by binlog_writer */
+class binlog_reader {
+public:
+    binlog_reader(std::span<const char> memory): _memory(memory) {
+        if (memory.size() < dtls::binlog_header_size)
+            throw std::invalid_argument("binlog_reader: not a binary log");
+
+        std::memcpy(&_header, memory.data(), sizeof(_header));
+        if (std::memcmp(_header.magic, binlog_header::magic_value, sizeof(_header.magic)) != 0 || _header.version != binlog_header::version_value ||
+            _header.slot_size != dtls::binlog_slot_size || dtls::binlog_header_size + _header.dict_size + _header.slots * dtls::binlog_slot_size > memory.size())
+            throw std::invalid_argument("binlog_reader: not a binary log or unsupported version");
+
+        auto dict = memory.subspan(dtls::binlog_header_size, _header.dict_used);
+        while (dict.size() >= 3) {
+            u16 format_size;
+            std::memcpy(&format_size, dict.data(), sizeof(format_size));
+            size_t nargs = u8(dict[2]);
+            if (dict.size() < 3 + nargs + format_size)
+                break;
+
+            auto& fmt = _formats.emplace_back();
+            for (size_t i = 0; i < nargs; ++i)
+                fmt.args.push_back(binlog_arg(dict[3 + i]));
+            fmt.format = std::string_view(dict.data() + 3 + nargs, format_size);
+            dict       = dict.subspan(3 + nargs + format_size);
+        }
+
+        _slots = memory.data() + dtls::binlog_header_size + _header.dict_size;
+    }
+
+    /* Calls handler(const binlog_record&) for every complete record from the oldest one */
+    void foreach(auto&& handler) const {
+        auto end = std::atomic_ref(const_cast<u64&>(reinterpret_cast<const binlog_header*>(_memory.data())->write_slot)).load(std::memory_order_acquire);
+        auto pos = end > _header.slots ? end - _header.slots : 0;
+
+        binlog_record       record;
+        std::vector<char>   payload;
+        while (pos < end) {
+            auto nslots = read_record(pos, end, payload);
+            if (nslots == 0) {
+                ++pos;
+                continue;
+            }
+            pos += nslots;
+
+            if (decode(payload, record))
+                handler(std::as_const(record));
+        }
+    }
+
+    [[nodiscard]]
+    std::vector<binlog_record> records() const {
+        std::vector<binlog_record> result;
+        foreach([&](const binlog_record& record) { result.push_back(record); });
+        return result;
+    }
+
+private:
+    u64 slot_start(u64 pos) const {
+        auto slot = _slots + (pos % _header.slots) * dtls::binlog_slot_size;
+        return std::atomic_ref(*const_cast<u64*>(reinterpret_cast<const u64*>(slot))).load(std::memory_order_acquire);
+    }
+
+    const char* slot_payload(u64 pos) const {
+        return _slots + (pos % _header.slots) * dtls::binlog_slot_size + sizeof(u64);
+    }
+
+    /* Returns number of slots of the record at pos or 0 if there is no complete record */
+    size_t read_record(u64 pos, u64 end, std::vector<char>& payload) const {
+        if (slot_start(pos) != pos)
+            return 0;
+
+        u32 size;
+        std::memcpy(&size, slot_payload(pos), sizeof(size));
+        auto nslots = (size_t(size) + dtls::binlog_slot_payload - 1) / dtls::binlog_slot_payload;
+        if (size < 17 || pos + nslots > end || nslots > _header.slots)
+            return 0;
+
+        payload.resize(size);
+        for (size_t i = 0; i < nslots; ++i) {
+            auto chunk = std::min(size - i * dtls::binlog_slot_payload, dtls::binlog_slot_payload);
+            std::memcpy(payload.data() + i * dtls::binlog_slot_payload, slot_payload(pos + i), chunk);
+        }
+
+        /* The record may be overwritten while it was copied */
+        std::atomic_thread_fence(std::memory_order_acquire);
+        for (size_t i = 0; i < nslots; ++i)
+            if (slot_start(pos + i) != pos)
+                return 0;
+
+        return nslots;
+    }
+
+    template <typename T>
+    static void decode_arg(std::span<const char>& bytes, std::string& out, ct_fmt_spec spec) {
+        T value;
+        bytes = bytes.subspan(core::from_bytes(bytes, value));
+        if constexpr (core::same_as<T, std::string>) {
+            out += value;
+        }
+        else {
+            auto pos = out.size();
+            out.resize(pos + ct_formatter<T>::max_size(value, spec));
+            auto end = ct_formatter<T>::write(out.data() + pos, value, spec);
+            out.resize(size_t(end - out.data()));
+        }
+    }
+
+    static void decode_arg(binlog_arg arg, std::span<const char>& bytes, std::string& out, ct_fmt_spec spec) {
+        switch (arg) {
+        case binlog_arg::i8: decode_arg<signed char>(bytes, out, spec); break;
+        case binlog_arg::u8: decode_arg<unsigned char>(bytes, out, spec); break;
+        case binlog_arg::i16: decode_arg<i16>(bytes, out, spec); break;
+        case binlog_arg::u16: decode_arg<u16>(bytes, out, spec); break;
+        case binlog_arg::i32: decode_arg<i32>(bytes, out, spec); break;
+        case binlog_arg::u32: decode_arg<u32>(bytes, out, spec); break;
+        case binlog_arg::i64: decode_arg<i64>(bytes, out, spec); break;
+        case binlog_arg::u64: decode_arg<u64>(bytes, out, spec); break;
+        case binlog_arg::f32: decode_arg<f32>(bytes, out, spec); break;
+        case binlog_arg::f64: decode_arg<f64>(bytes, out, spec); break;
+        case binlog_arg::boolean: decode_arg<bool>(bytes, out, spec); break;
+        case binlog_arg::chr: decode_arg<char>(bytes, out, spec); break;
+        case binlog_arg::ptr: {
+            u64 value;
+            bytes = bytes.subspan(core::from_bytes(bytes, value));
+            decode_arg_ptr(reinterpret_cast<const void*>(uintptr_t(value)), out);
+        } break;
+        case binlog_arg::str: decode_arg<std::string>(bytes, out, spec); break;
+        }
+    }
+
+    static void decode_arg_ptr(const void* value, std::string& out) {
+        auto pos = out.size();
+        out.resize(pos + ct_formatter<const void*>::max_size(value, {}));
+        auto end = ct_formatter<const void*>::write(out.data() + pos, value, {});
+        out.resize(size_t(end - out.data()));
+    }
+
+    /* Format strings were validated at compile time, so only specs produced by ct_fmt_parse_spec are expected here */
+    static ct_fmt_spec parse_spec(std::string_view str) {
+        ct_fmt_spec spec;
+        size_t      i = 0;
+        if (i < str.size() && str[i] == '.') {
+            spec.precision = 0;
+            while (++i < str.size() && str[i] >= '0' && str[i] <= '9')
+                spec.precision = spec.precision * 10 + (str[i] - '0');
+        }
+        if (i < str.size())
+            spec.type = str[i];
+        return spec;
+    }
+
+    bool decode(std::span<const char> payload, binlog_record& record) const {
+        u32 id;
+        u64 time;
+        u8  level;
+        std::memcpy(&id, payload.data() + 4, sizeof(id));
+        std::memcpy(&time, payload.data() + 8, sizeof(time));
+        std::memcpy(&level, payload.data() + 16, sizeof(level));
+        if (id >= _formats.size())
+            return false;
+
+        record.time  = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(time)));
+        record.level = log_level(level);
+        record.msg.clear();
+
+        auto& [format, args] = _formats[id];
+        auto   bytes         = payload.subspan(17);
+        size_t arg           = 0;
+
+        try {
+            for (size_t i = 0; i < format.size(); ++i) {
+                auto c = format[i];
+                if ((c == '{' || c == '}') && i + 1 < format.size() && format[i + 1] == c) {
+                    record.msg += c;
+                    ++i;
+                }
+                else if (c == '{') {
+                    auto close = format.find('}', i);
+                    if (close == std::string_view::npos || arg == args.size())
+                        return false;
+                    decode_arg(args[arg++], bytes, record.msg, parse_spec(format.substr(i + 1, close - i - 1)));
+                    i = close;
+                }
+                else
+                    record.msg += c;
+            }
+        }
+        catch (const core::from_bytes_out_of_range&) {
+            return false;
+        }
+
+        return true;
+    }
+
+    struct format_info {
+        std::string_view        format;
+        std::vector<binlog_arg> args;
+    };
+
+    std::span<const char>    _memory;
+    binlog_header            _header;
+    const char*              _slots;
+    std::vector<format_info> _formats;
+};
+} // namespace util
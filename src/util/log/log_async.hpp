@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <core/mpmc_ring.hpp>
+#include <core/small_string.hpp>
+
+#include <util/log/log_handler_base.hpp>
+
+namespace util {
+/* What to do when the async log queue is full */
+enum class log_overflow {
+    drop,  /* Discard the record, number of discarded records is reported later */
+    block, /* Wait until the writer thread frees a slot */
+};
+
+struct log_async_options {
+    u32          queue_size = 4096;
+    u32          batch_size = 256; /* Max records written between handler flushes */
+    log_overflow overflow   = log_overflow::drop;
+};
+
+/* Formatted record passed from a logging thread to the writer thread */
+struct log_async_record {
+    enum class kind : u8 { log = 0, update, targeted, flush, stop };
+
+    kind                                  type      = kind::log;
+    log_level                             level     = log_level::info;
+    u16                                   update_id = 0;
+    std::chrono::system_clock::time_point time;
+    core::small_string<191>               msg;
+    std::string                           target; /* Handler name for kind::targeted */
+    bool*                                 done = nullptr; /* Set by the writer thread under log_async_state::flush_mtx for kind::flush */
+};
+
+struct log_async_state {
+    log_async_state(log_async_options opts): options(opts), queue(opts.queue_size) {}
+
+    log_async_options                       options;
+    core::mpmc_ring<log_async_record, true> queue;
+    std::atomic<u64>                        dropped = 0;
+    std::mutex                              flush_mtx;
+    std::condition_variable                 flush_cv;
+    std::thread                             thread;
+};
+} // namespace util
@@ -18,6 +18,23 @@ public:
 
     virtual void write_handler(log_level level, write_type wt, std::string_view time, std::string_view msg, u64 times) = 0;
 
+    /* Writes out records kept by a buffered handler */
+    virtual void flush() {}
+
+    /* Buffered handler may keep records in memory until flush()
+     * Used by the async logger, which calls the handler from a single thread only.
+     */
+    void buffered(bool value) {
+        _buffered = value;
+        if (!value)
+            flush();
+    }
+
+    [[nodiscard]]
+    bool buffered() const {
+        return _buffered;
+    }
+
     void write(log_level level, std::string_view time, std::string_view msg, u64 msg_hash) {
         auto comphash   = u32((msg_hash & 0x00000000ffffffff) ^ (msg_hash >> 32));
         u64  d          = data.load(std::memory_order_acquire);
@@ -73,6 +90,7 @@ private:
     }
 
 private:
-    std::atomic<u64> data = 0;
+    std::atomic<u64> data      = 0;
+    bool             _buffered = false;
 };
 } // namespace util
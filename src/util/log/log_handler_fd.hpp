@@ -1,5 +1,8 @@
 #pragma once
 
+#include <charconv>
+#include <cstring>
+
 #include <core/box.hpp>
 #include <core/io/helpers.hpp>
 
@@ -31,56 +34,102 @@ public:
             "\033[0;38;5;1m",
         };
 
-        std::string record;
+        /* Pieces of the record are written with one writev, nothing is copied in unbuffered mode */
+        static constexpr size_t max_parts = 9;
+
+        std::string_view parts[max_parts];
+        size_t           count = 0;
+        auto             add   = [&](std::string_view part) {
+            parts[count++] = part;
+        };
 
-        if (wt != write_type::new_record && is_fifo)
-            record += '\r';
-        else
-            record += '\n';
+        add(wt != write_type::new_record && is_fifo ? "\r"sv : "\n"sv);
 
         /* Setup color for log level */
         if (is_tty)
-            record += level_color[size_t(level)];
+            add(level_color[size_t(level)]);
 
-        record += time;
+        add(time);
 
         /* Enable bold */
         if (is_tty)
-            record += "\033[1m";
+            add("\033[1m"sv);
 
+        char times_buf[32];
         if (times > 1 && wt == write_type::write_same) {
             if (times != std::numeric_limits<u16>::max()) {
-                record += " (";
-                record += std::to_string(times);
-                record += " times)";
+                auto end = std::to_chars(times_buf + 2, times_buf + sizeof(times_buf) - 7, times).ptr;
+                std::memcpy(times_buf, " (", 2);
+                std::memcpy(end, " times)", 7);
+                add(std::string_view(times_buf, size_t(end + 7 - times_buf)));
             } else {
-                record += " (repeats infinitely)";
+                add(" (repeats infinitely)"sv);
             }
         }
-        record += level_str[size_t(level)];
+        add(level_str[size_t(level)]);
 
         /* Disable bold */
         if (is_tty)
-            record += "\033[22m";
+            add("\033[22m"sv);
 
-        record += msg;
+        add(msg);
 
         /* Reset colors */
         if (is_tty)
-            record += "\033[0m";
+            add("\033[0m"sv);
+
+        size_t record_size = 0;
+        for (size_t i = 0; i < count; ++i)
+            record_size += parts[i].size();
 
         /* XXX: racy */
-        size_t prev_len = prev_record_len.exchange(record.size());
-        if (wt != write_type::new_record && !is_fifo)
+        size_t prev_len = prev_record_len.exchange(record_size);
+        bool   rewrite  = wt != write_type::new_record && !is_fifo;
+
+        if (buffered()) {
+            /* Previous record is not written yet, just replace it */
+            if (rewrite && pending.size() >= prev_len)
+                pending.resize(pending.size() - prev_len);
+            else if (rewrite) {
+                flush();
+                sys::lseek(ofd, -off_t(prev_len), sys::seek_whence::cur);
+            }
+
+            for (size_t i = 0; i < count; ++i)
+                pending += parts[i];
+            if (pending.size() >= max_pending)
+                flush();
+            return;
+        }
+
+        if (rewrite)
             sys::lseek(ofd, -off_t(prev_len), sys::seek_whence::cur);
-        sys::write(ofd, record.data(), record.size());
+
+        iovec iov[max_parts];
+        for (size_t i = 0; i < count; ++i)
+            iov[i] = {const_cast<char*>(parts[i].data()), parts[i].size()};
+        sys::writev(ofd, std::span<const iovec>{iov, count});
+    }
+
+    void flush() final {
+        size_t pos = 0;
+        while (pos < pending.size()) {
+            auto written = sys::write(ofd, pending.data() + pos, pending.size() - pos);
+            if (!written || *written == 0)
+                break;
+            pos += *written;
+        }
+        pending.clear();
     }
 
 private:
+    static constexpr size_t max_pending = 64 * 1024;
+
     Fd                  ofd;
     const bool          is_fifo;
     const bool          is_tty;
     std::atomic<size_t> prev_record_len = 0;
+    std::string         pending;
 };
 
 template <core::convertible_to<sys::fd_t> Fd>
@@ -1,215 +1,240 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <memory>
 #include <mutex>
-#include <shared_mutex>
 #include <string>
 #include <vector>
 
 #include <core/box.hpp>
-#include <core/ranges/split.hpp>
-#include <core/ring_buffer.hpp>
+#include <core/small_string.hpp>
 
 #include <util/log/log_handler_base.hpp>
 
 namespace util {
-template <typename T>
-class log_records {
-public:
-    template <typename I>
-    log_records(I ibegin, I iend, size_t start_pos, size_t end_pos, size_t max_pos): mstart_pos(start_pos), mend_pos(end_pos), mmax_pos(max_pos) {
-        records.resize(end_pos - start_pos);
-        size_t i = 0;
-        for (auto iter = ibegin; iter != iend; ++iter)
-            records[i++] = *iter;
-    }
-
-    [[nodiscard]]
-    auto begin() const {
-        return records.begin();
-    }
+/* Entry of log_handler_ring passed to readers, strings point into the ring */
+struct log_ring_view {
+    u64                          seq;
+    log_level                    lvl;
+    log_handler_base::write_type wt;
+    u64                          times;
+    std::string_view             time;
+    std::string_view             msg;
+};
 
-    [[nodiscard]]
-    auto end() const {
-        return records.end();
-    }
+struct log_ring_read_result {
+    u64  next;         /* Sequence number to resume from */
+    u64  lost = 0;     /* Entries overwritten before they were read */
+    bool torn = false; /* The last entry passed to the handler was overwritten while it was handled */
+};
 
-    [[nodiscard]]
-    size_t start_pos() const {
-        return mstart_pos;
-    }
+/* Keeps the latest records in a byte ring, every write_handler() call appends one entry with the next sequence number
+ * Records with write_type::write_same or write_type::update replace the previous entry for viewers.
+ * Writers are serialized with a mutex, readers never block them: an entry is validated against the sequence number
+ * of the oldest live entry after it was read (seqlock), overwritten entries are skipped and reported as lost.
+ */
+class log_handler_ring : public log_handler_base {
+public:
+    /* Copy of an entry returned by records() */
+    struct record {
+        u64                    seq;
+        core::small_string<15> time;
+        std::string            msg;
+        u64                    times;
+        log_level              lvl;
+        write_type             wt;
+    };
 
-    [[nodiscard]]
-    size_t end_pos() const {
-        return mend_pos;
-    }
+    log_handler_ring(size_t capacity):
+        _capacity(std::bit_ceil(std::max(capacity, min_capacity))),
+        _index_size(std::bit_ceil(_capacity / header_size)),
+        _data(std::make_unique<char[]>(_capacity)),
+        _index(std::make_unique<std::atomic<u64>[]>(_index_size)) {}
 
-    [[nodiscard]]
-    size_t max_pos() const {
-        return mmax_pos;
+    static core::box<log_handler_ring> create(size_t capacity) {
+        return core::boxed<log_handler_ring>(capacity);
     }
 
-private:
-    std::vector<T> records;
-    size_t         mstart_pos;
-    size_t         mend_pos;
-    size_t         mmax_pos;
-};
-
-template <typename I>
-log_records(I i, I, size_t, size_t, size_t) -> log_records<std::decay_t<decltype(*i)>>;
+    void write_handler(log_level level, write_type wt, std::string_view time, std::string_view msg, u64 times) final {
+        time = time.substr(0, std::min(time.size(), max_time_size));
+        msg  = msg.substr(0, std::min(msg.size(), _capacity / 2 - header_size - time.size()));
+
+        std::lock_guard lock{_write_mtx};
+
+        auto size = align(header_size + time.size() + msg.size());
+        auto pos  = _head_pos;
+        if ((pos & (_capacity - 1)) + size > _capacity)
+            pos = align_to_capacity(pos);
+        release(pos, pos + size);
+
+        auto seq = _head_seq.load(std::memory_order_relaxed);
+        header h{
+            .seq       = seq,
+            .times     = times,
+            .msg_size  = u32(msg.size()),
+            .time_size = u16(time.size()),
+            .lvl       = u8(level),
+            .wt        = u8(wt),
+        };
+
+        auto p = _data.get() + (pos & (_capacity - 1));
+        std::memcpy(p, &h, header_size);
+        std::memcpy(p + header_size, time.data(), time.size());
+        std::memcpy(p + header_size + time.size(), msg.data(), msg.size());
+
+        _index[seq & (_index_size - 1)].store(pos, std::memory_order_relaxed);
+        _head_pos = pos + size;
+        _head_seq.store(seq + 1, std::memory_order_release);
+    }
+
+    /* Calls handler(const log_ring_view&) for entries starting from the sequence number from
+     * The view must not be used after the handler returns. The handler may see a torn entry if a writer overwrote it
+     * in the meantime, in that case reading stops and result.torn is set.
+     */
+    log_ring_read_result read(u64 from, auto&& handler, u64 max_entries = ~u64(0)) const {
+        log_ring_read_result result{.next = from};
+
+        auto end = _head_seq.load(std::memory_order_acquire);
+        while (result.next < end && max_entries) {
+            auto seq = result.next;
+            if (auto tail = _tail_seq.load(std::memory_order_acquire); seq < tail) {
+                result.lost += tail - seq;
+                result.next = tail;
+                continue;
+            }
 
-template <typename I>
-class locked_log_range {
-public:
-    locked_log_range(I ibegin, I iend, size_t start_pos, size_t end_pos, size_t max_pos, std::shared_mutex& imtx):
-        b(ibegin), e(iend), mstart_pos(start_pos), mend_pos(end_pos), mmax_pos(max_pos), mtx(imtx) {}
+            auto   pos = _index[seq & (_index_size - 1)].load(std::memory_order_relaxed);
+            auto   p   = _data.get() + (pos & (_capacity - 1));
+            header h;
+            std::memcpy(&h, p, header_size);
+
+            if (!validate(seq))
+                continue;
+
+            const log_ring_view view{
+                .seq   = seq,
+                .lvl   = log_level(h.lvl),
+                .wt    = write_type(h.wt),
+                .times = h.times,
+                .time  = std::string_view(p + header_size, h.time_size),
+                .msg   = std::string_view(p + header_size + h.time_size, h.msg_size),
+            };
+            handler(view);
+
+            if (!validate(seq)) {
+                result.torn = true;
+                return result;
+            }
+            ++result.next;
+            --max_entries;
+        }
 
-    ~locked_log_range() {
-        mtx.unlock_shared();
+        return result;
     }
 
-    [[nodiscard]]
-    I begin() const {
-        return b;
+    /* Copies up to max_entries entries starting from the sequence number from */
+    std::vector<record> records(u64 from, u64 max_entries = ~u64(0)) const {
+        std::vector<record> result;
+        while (true) {
+            auto res = read(
+                from,
+                [&](const log_ring_view& v) {
+                    result.push_back({v.seq, v.time, std::string(v.msg), v.times, v.lvl, v.wt});
+                },
+                max_entries - result.size());
+            if (!res.torn)
+                break;
+
+            result.pop_back();
+            from = res.next;
+        }
+        return result;
     }
 
+    /* Sequence number of the oldest entry */
     [[nodiscard]]
-    I end() const {
-        return e;
+    u64 first_seq() const {
+        return _tail_seq.load(std::memory_order_acquire);
     }
 
+    /* Sequence number of the next entry to be written */
     [[nodiscard]]
-    size_t start_pos() const {
-        return mstart_pos;
+    u64 next_seq() const {
+        return _head_seq.load(std::memory_order_acquire);
     }
 
     [[nodiscard]]
-    size_t end_pos() const {
-        return mend_pos;
+    size_t size() const {
+        auto head = next_seq();
+        return size_t(head - std::min(head, first_seq()));
     }
 
     [[nodiscard]]
-    size_t max_pos() const {
-        return mmax_pos;
+    size_t capacity() const {
+        return _capacity;
     }
 
-    [[nodiscard]]
-    auto copy_records() const {
-        return log_records(b, e, mstart_pos, mend_pos, mmax_pos);
+    /* Drops all entries, sequence numbers are not reset */
+    void clear() {
+        std::lock_guard lock{_write_mtx};
+        _tail_seq.store(_head_seq.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        _tail_pos = _head_pos;
     }
 
 private:
-    I                  b, e;
-    size_t             mstart_pos;
-    size_t             mend_pos;
-    size_t             mmax_pos;
-    std::shared_mutex& mtx;
-};
-
-class log_handler_ring : public log_handler_base {
-public:
-    struct record {
-        std::string time;
-        std::string msg;
-        u64         times;
-        log_level   lvl;
-        write_type  wt;
+    struct header {
+        u64 seq;
+        u64 times;
+        u32 msg_size;
+        u16 time_size;
+        u8  lvl;
+        u8  wt;
     };
 
-    log_handler_ring(size_t max_records): records(max_records) {}
-    static core::box<log_handler_ring> create(size_t max_records) {
-        return core::boxed<log_handler_ring>(max_records);
-    }
-
-    void write_handler(log_level level, write_type wt, std::string_view time, std::string_view msg, u64 times) final {
-        std::unique_lock lock{mtx};
-
-        if (wt == write_type::new_record || records.empty()) {
-            std::string tm{time};
-            last_lines_count = 0;
-            for (auto line : msg | core::views::split('\n', '\r')) {
-                /* Specify time in first line only */
-                records.push({std::move(tm), {line.begin(), line.end()}, times, level, wt});
-                ++last_lines_count;
-            }
-        } else if (last_lines_count <= records.size()) {
-            auto offset = records.size() - last_lines_count;
-            auto b      = records.begin() + ssize_t(offset);
-
-            b->lvl   = level;
-            b->time  = time;
-            b->wt    = wt;
-            b->times = times;
-
-            if (wt == write_type::update) {
-                size_t lines_count = 0;
-                for (auto line : msg | core::views::split('\n', '\r')) {
-                    if (b != records.end())
-                        b->msg = std::string(line.begin(), line.end());
-                    else
-                        records.push({{}, {line.begin(), line.end()}, times, level, wt});
-                    ++lines_count;
-                    ++b;
-                }
-
-                while (lines_count < last_lines_count) {
-                    records.pop();
-                    --lines_count;
-                }
-
-                last_lines_count = lines_count;
-            }
-        }
-    }
+    static constexpr size_t header_size   = sizeof(header);
+    static constexpr size_t min_capacity  = 4096;
+    static constexpr size_t max_time_size = 255;
 
-    auto read_lock(size_t preferred_start, size_t max_records) const {
-        mtx.lock_shared();
-        if (records.size() < max_records) {
-            return locked_log_range(records.begin(), records.end(), 0, records.size(), records.size(), mtx);
-        } else if (preferred_start + max_records > records.size()) {
-            preferred_start = records.size() - max_records;
-            return locked_log_range(records.begin() + ssize_t(preferred_start), records.end(), preferred_start, records.size(), records.size(), mtx);
-        } else {
-            return locked_log_range(
-                records.begin() + ssize_t(preferred_start),
-                records.begin() + ssize_t(preferred_start + max_records),
-                preferred_start,
-                preferred_start + max_records,
-                records.size(),
-                mtx
-            );
-        }
+    static size_t align(size_t size) {
+        return (size + alignof(header) - 1) & ~(alignof(header) - 1);
     }
 
-    auto get_records(size_t preferred_start, size_t max_records) const {
-        return read_lock(preferred_start, max_records).copy_records();
+    u64 align_to_capacity(u64 pos) const {
+        return (pos + _capacity - 1) & ~u64(_capacity - 1);
     }
 
-    [[nodiscard]]
-    size_t size() const {
-        std::shared_lock lock{mtx};
-        return records.size();
-    }
+    /* Drops the oldest entries overlapping with the new entry at [pos, end) */
+    void release(u64 pos, u64 end) {
+        auto tail = _tail_seq.load(std::memory_order_relaxed);
+        auto head = _head_seq.load(std::memory_order_relaxed);
+        if (tail == head)
+            _tail_pos = pos;
 
-    [[nodiscard]]
-    size_t max_size() const {
-        std::shared_lock lock{mtx};
-        return records.max_size();
-    }
+        while (_tail_pos + _capacity < end) {
+            ++tail;
+            _tail_pos = tail != head ? _index[tail & (_index_size - 1)].load(std::memory_order_relaxed) : pos;
+        }
 
-    void max_size(size_t value) {
-        std::unique_lock lock{mtx};
-        records.resize(value);
+        _tail_seq.store(tail, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
     }
 
-    void clear() {
-        std::unique_lock lock{mtx};
-        records.clear();
+    bool validate(u64 seq) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return _tail_seq.load(std::memory_order_relaxed) <= seq;
     }
 
-private:
-    core::ring_buffer<record> records;
-    size_t                    last_lines_count = 0;
-    mutable std::shared_mutex mtx;
+    size_t                              _capacity;
+    size_t                              _index_size;
+    std::unique_ptr<char[]>             _data;
+    std::unique_ptr<std::atomic<u64>[]> _index; /* Byte position of the entry by sequence number */
+    std::atomic<u64>                    _head_seq = 0;
+    std::atomic<u64>                    _tail_seq = 0;
+    u64                                 _head_pos = 0;
+    u64                                 _tail_pos = 0;
+    std::mutex                          _write_mtx;
 };
 } // namespace util
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <string_view>
+
+#include <core/concepts/floating_point.hpp>
+#include <core/concepts/same_as.hpp>
+#include <core/ct_str.hpp>
+
+#include <util/ct_format.hpp>
+
+/* Structured records: message followed by key-value pairs
+ *
+ *   logfmt: msg="connection closed" fd=17 latency_us=250
+ *   json:   {"msg":"connection closed","fd":17,"latency_us":250}
+ *
+ * Keys are core::ct_str, their encoded form (with separators and quotes) is built at compile time.
+ * Values are written directly into the output buffer, which grows at most once.
+ * Strings are quoted and escaped when needed, types without ct_formatter are printed with util::print_any.
+ */
+
+namespace util {
+enum class log_kv_format { logfmt = 0, json };
+
+namespace dtls {
+    template <log_kv_format F, bool First, char... Cs>
+    struct log_kv_key {
+        static constexpr auto make() {
+            constexpr char key[] = {Cs..., '\0'};
+            for (auto c : std::string_view(key, sizeof...(Cs)))
+                if (c <= ' ' || c == '=' || c == '"' || c == '\\' || c == 0x7f)
+                    ct_format_error("invalid char in log key");
+            if (sizeof...(Cs) == 0)
+                ct_format_error("empty log key");
+
+            struct {
+                char   text[sizeof...(Cs) + 4]{};
+                size_t size = 0;
+            } res;
+
+            auto put = [&](char c) {
+                res.text[res.size++] = c;
+            };
+
+            if constexpr (F == log_kv_format::json) {
+                put(First ? '{' : ',');
+                put('"');
+                (put(Cs), ...);
+                put('"');
+                put(':');
+            }
+            else {
+                if (!First)
+                    put(' ');
+                (put(Cs), ...);
+                put('=');
+            }
+            return res;
+        }
+
+        static constexpr auto value = make();
+    };
+
+    template <typename T>
+    decltype(auto) log_kv_prepare(const T& value) {
+        if constexpr (core::is_ct_str<T>)
+            return (value);
+        else if constexpr (core::convertible_to<const T&, std::string_view>)
+            return std::string_view(value);
+        else if constexpr (ct_fmt_char<T>)
+            return std::string_view(reinterpret_cast<const char*>(&value), 1);
+        else if constexpr (ct_formattable<T>)
+            return (value);
+        else {
+            std::ostringstream ss;
+            print_any(ss, value);
+            return ss.str();
+        }
+    }
+
+    /* 1 - value must be quoted in logfmt, 2 - char must be escaped */
+    inline constexpr auto log_kv_char_class = [] {
+        std::array<u8, 256> res{};
+        for (size_t c = 0; c < 256; ++c) {
+            if (c < 0x20 || c == '"' || c == '\\')
+                res[c] = 3;
+            else if (c == ' ' || c == '=')
+                res[c] = 1;
+        }
+        return res;
+    }();
+
+    constexpr bool log_kv_escaped(char c) {
+        return log_kv_char_class[u8(c)] & 2;
+    }
+
+    /* logfmt values are quoted only when they contain spaces, quotes, '=' or control chars */
+    inline bool log_kv_needs_quotes(std::string_view str) {
+        u8 mask = str.empty();
+        for (auto c : str)
+            mask |= log_kv_char_class[u8(c)];
+        return mask;
+    }
+
+    inline char* log_kv_write_quoted(char* out, std::string_view str) {
+        static constexpr char hex[] = "0123456789abcdef";
+
+        *out++     = '"';
+        auto begin = str.data();
+        auto end   = begin + str.size();
+        while (begin != end) {
+            auto p = begin;
+            while (p != end && !log_kv_escaped(*p))
+                ++p;
+            std::memcpy(out, begin, size_t(p - begin));
+            out += p - begin;
+            if (p == end)
+                break;
+
+            *out++ = '\\';
+            switch (*p) {
+            case '"': *out++ = '"'; break;
+            case '\\': *out++ = '\\'; break;
+            case '\n': *out++ = 'n'; break;
+            case '\r': *out++ = 'r'; break;
+            case '\t': *out++ = 't'; break;
+            default:
+                std::memcpy(out, "u00", 3);
+                out[3] = hex[u8(*p) >> 4];
+                out[4] = hex[u8(*p) & 0xf];
+                out += 5;
+            }
+            begin = p + 1;
+        }
+        *out++ = '"';
+        return out;
+    }
+
+    template <log_kv_format F, typename T>
+    size_t log_kv_max_size(const T& value) {
+        if constexpr (core::convertible_to<const T&, std::string_view>) {
+            std::string_view str     = value;
+            size_t           escaped = 0;
+            for (auto c : str)
+                escaped += log_kv_char_class[u8(c)] >> 1;
+            return 2 + str.size() + escaped * 5;
+        }
+        else if constexpr (core::floating_point<T>)
+            return std::max<size_t>(ct_formatter<T>::max_size(value, {}), 4);
+        else if constexpr (ct_fmt_int<T> || core::same_as<T, bool>)
+            return ct_formatter<T>::max_size(value, {});
+        else
+            return ct_formatter<T>::max_size(value, {}) + 2;
+    }
+
+    template <log_kv_format F, typename T>
+    char* log_kv_write(char* out, const T& value) {
+        if constexpr (core::convertible_to<const T&, std::string_view>) {
+            std::string_view str = value;
+            if (F == log_kv_format::json || log_kv_needs_quotes(str))
+                return log_kv_write_quoted(out, str);
+            return ct_formatter<std::string_view>::write(out, str, {});
+        }
+        else if constexpr (core::floating_point<T>) {
+            if (F == log_kv_format::json && !std::isfinite(value))
+                return ct_formatter<std::string_view>::write(out, "null", {});
+            return ct_formatter<T>::write(out, value, {});
+        }
+        else if constexpr (ct_fmt_int<T> || core::same_as<T, bool>)
+            return ct_formatter<T>::write(out, value, {});
+        else {
+            /* Other formattable types (pointers) are strings in json */
+            if constexpr (F == log_kv_format::json)
+                *out++ = '"';
+            out = ct_formatter<T>::write(out, value, {});
+            if constexpr (F == log_kv_format::json)
+                *out++ = '"';
+            return out;
+        }
+    }
+
+    template <log_kv_format F, bool First>
+    size_t log_kv_size() {
+        return F == log_kv_format::json ? (First ? 2 : 1) : 0;
+    }
+
+    template <log_kv_format F, bool First, typename K, typename T, typename... Ts>
+    size_t log_kv_size(const K&, const T& value, const Ts&... rest) {
+        static_assert(core::is_ct_str<K>, "log keys must be core::ct_str");
+        return []<char... Cs>(core::ct_str<Cs...>) {
+            return log_kv_key<F, First, Cs...>::value.size;
+        }(K{}) + log_kv_max_size<F>(value) + log_kv_size<F, false>(rest...);
+    }
+
+    template <log_kv_format F, bool First>
+    char* log_kv_write_pairs(char* out) {
+        if constexpr (F == log_kv_format::json) {
+            if constexpr (First)
+                *out++ = '{';
+            *out++ = '}';
+        }
+        return out;
+    }
+
+    template <log_kv_format F, bool First, typename K, typename T, typename... Ts>
+    char* log_kv_write_pairs(char* out, const K&, const T& value, const Ts&... rest) {
+        out = []<char... Cs>(char* o, core::ct_str<Cs...>) {
+            constexpr auto& key = log_kv_key<F, First, Cs...>::value;
+            std::memcpy(o, key.text, key.size);
+            return o + key.size;
+        }(out, K{});
+        out = log_kv_write<F>(out, value);
+        return log_kv_write_pairs<F, false>(out, rest...);
+    }
+
+    template <log_kv_format F>
+    void log_kv_append(format_buffer auto& buf, const auto&... kvs) {
+        auto pos = size_t(buf.size());
+        auto max = log_kv_size<F, true>(kvs...);
+
+        if constexpr (requires { buf.resize_and_overwrite(size_t(0), [](char*, size_t) { return size_t(0); }); }) {
+            buf.resize_and_overwrite(pos + max, [&](char* data, size_t) { return size_t(log_kv_write_pairs<F, true>(data + pos, kvs...) - data); });
+        }
+        else {
+            buf.resize(pos + max);
+            auto end = log_kv_write_pairs<F, true>(buf.data() + pos, kvs...);
+            buf.resize(size_t(end - buf.data()));
+        }
+    }
+
+    template <log_kv_format F>
+    void log_kv_to(format_buffer auto& buf, const auto&... kvs) {
+        log_kv_append<F>(buf, log_kv_prepare(kvs)...);
+    }
+} // namespace dtls
+
+/* Appends msg and key-value pairs to buf: log_kv_to(buf, log_kv_format::json, "accepted", "fd"_ctstr, fd) */
+template <typename... Ts>
+void log_kv_to(format_buffer auto& buf, log_kv_format format, std::string_view msg, const Ts&... kvs) {
+    static_assert(sizeof...(Ts) % 2 == 0, "Keys and values must come in pairs");
+    if (format == log_kv_format::json)
+        dtls::log_kv_to<log_kv_format::json>(buf, core::ct_str<'m', 's', 'g'>{}, msg, kvs...);
+    else
+        dtls::log_kv_to<log_kv_format::logfmt>(buf, core::ct_str<'m', 's', 'g'>{}, msg, kvs...);
+}
+} // namespace util
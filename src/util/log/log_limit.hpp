@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <ctime>
+#include <mutex>
+#include <source_location>
+
+#include <core/intrusive_list.hpp>
+
+#include <util/basic_types.hpp>
+
+namespace util {
+struct log_limit_options {
+    u32 per_second   = 0; /* Max records per second, 0 - unlimited */
+    u32 sample_every = 1; /* Only every Nth call is considered */
+};
+
+class log_limiter;
+
+struct log_limit_registry {
+    static log_limit_registry& instance() {
+        static log_limit_registry registry;
+        return registry;
+    }
+
+    std::mutex                        mtx;
+    core::intrusive_list<log_limiter> limiters;
+};
+
+/* Per-callsite state of a rate-limited log record, normally a static created by TBC_LOG_LIMITED
+ * allow() is checked by logger::log_limited() before the message is formatted. Rejected calls are counted
+ * and reported later as a single summary record by logger::log_limited() or logger::flush_limits().
+ */
+class log_limiter : public core::intrusive_list_hook<> {
+public:
+    log_limiter(log_limit_options opts, std::source_location loc = std::source_location::current()): options(opts), location(loc) {
+        if (options.sample_every == 0)
+            options.sample_every = 1;
+
+        auto&           registry = log_limit_registry::instance();
+        std::lock_guard lock{registry.mtx};
+        registry.limiters.push_back(*this);
+    }
+
+    ~log_limiter() {
+        auto&           registry = log_limit_registry::instance();
+        std::lock_guard lock{registry.mtx};
+        unlink();
+    }
+
+    log_limiter(const log_limiter&)            = delete;
+    log_limiter& operator=(const log_limiter&) = delete;
+
+    bool allow() {
+        if (options.sample_every != 1 && calls.fetch_add(1, std::memory_order_relaxed) % options.sample_every != 0)
+            return reject();
+
+        if (options.per_second) {
+            auto second = current_second();
+            auto prev   = window.load(std::memory_order_relaxed);
+            if (prev != second && window.compare_exchange_strong(prev, second, std::memory_order_relaxed))
+                window_count.store(0, std::memory_order_relaxed);
+            if (window_count.fetch_add(1, std::memory_order_relaxed) >= options.per_second)
+                return reject();
+        }
+
+        return true;
+    }
+
+    /* Returns the number of rejected calls since the previous call */
+    u64 take_suppressed() {
+        if (suppressed.load(std::memory_order_relaxed) == 0)
+            return 0;
+        return suppressed.exchange(0, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]]
+    const std::source_location& where() const {
+        return location;
+    }
+
+private:
+    bool reject() {
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    /* CLOCK_MONOTONIC_COARSE is served by vDSO, its resolution is enough for one second windows */
+    static u64 current_second() {
+        timespec ts;
+        ::clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+        return u64(ts.tv_sec);
+    }
+
+    log_limit_options    options;
+    std::source_location location;
+    std::atomic<u64>     calls        = 0;
+    std::atomic<u64>     window       = 0;
+    std::atomic<u32>     window_count = 0;
+    std::atomic<u64>     suppressed   = 0;
+};
+} // namespace util
+
+/* Logs at most per_second records per second from every sample_every-th call of this callsite
+ * TBC_LOG_LIMITED(logger, warn, 10, 1, "bad packet from {}"_ctstr, addr);
+ */
+#define TBC_LOG_LIMITED(logger, level, per_second, sample_every, ...)                                                               \
+    do {                                                                                                                            \
+        static ::util::log_limiter _tbc_log_limiter{::util::log_limit_options{::util::u32(per_second), ::util::u32(sample_every)}}; \
+        (logger).log_limited(_tbc_log_limiter, ::util::log_level::level, __VA_ARGS__);                                              \
+    } while (0)
@@ -1,14 +1,21 @@
 #pragma once
 
+#include <atomic>
 #include <map>
 #include <mutex>
 #include <shared_mutex>
+#include <span>
+#include <vector>
 
 #include <core/box.hpp>
 #include <core/compact_hashes.hpp>
 
+#include <util/ct_format.hpp>
+#include <util/log/binlog.hpp>
+#include <util/log/log_async.hpp>
 #include <util/log/log_handler_fd.hpp>
-#include <util/print.hpp>
+#include <util/log/log_kv.hpp>
+#include <util/log/log_limit.hpp>
 #include <util/time.hpp>
 
 namespace util {
@@ -24,22 +31,20 @@ public:
 
     ~logger() {
         info("******* log close {} *******\n", handler_names());
+        stop_async();
     }
 
     void add_handler(const std::string& name, core::box<log_handler_base> log_handler) {
         {
             std::unique_lock lock{mtx};
+            log_handler->buffered(bool(async));
             handlers.insert_or_assign(name, std::move(log_handler));
         }
         log_to_handler(name, log_level::info, "******* handler [{}] attached *******", name);
     }
 
     void add_handler(const std::string& name, core::convertible_to<sys::fd_t> auto ofd) {
-        {
-            std::unique_lock lock{mtx};
-            handlers.insert_or_assign(name, create_log_handler(core::mov(ofd)));
-        }
-        log_to_handler(name, log_level::info, "******* handler [{}] attached *******", name);
+        add_handler(name, core::box<log_handler_base>(create_log_handler(core::mov(ofd))));
     }
 
     void remove_handler(const std::string& name) {
@@ -49,11 +54,15 @@ public:
     }
 
     core::box<log_handler_base> take_handler(const std::string& name) {
+        /* Deliver queued records before the handler is detached */
+        flush();
+
         std::unique_lock lock{mtx};
         auto             found = handlers.find(name);
         if (found != handlers.end()) {
             auto res = std::move(found->second);
             handlers.erase(found);
+            res->buffered(false);
             return res;
         }
         return {};
@@ -72,21 +81,25 @@ public:
     }
 
     template <typename... Ts>
-    static void log_to_handler(log_handler_base& handler, log_level level, std::string_view format_str, Ts&&... args) {
+    static void log_to_handler(log_handler_base& handler, log_level level, format_string auto format_str, Ts&&... args) {
         auto msg  = util::format(format_str, std::forward<Ts>(args)...);
         auto hash = core::fnv1a64(msg.data(), msg.size());
-        auto time = current_datetime(time_format);
-        handler.write(level, time, msg, hash);
+        handler.write(level, timestamp(std::chrono::system_clock::now()), msg, hash);
     }
 
     template <typename... Ts>
-    void log_to_handler(const std::string& handler_name, log_level level, std::string_view format_str, Ts&&... args) {
+    void log_to_handler(const std::string& handler_name, log_level level, format_string auto format_str, Ts&&... args) {
         if (!check_level(level))
             return;
 
+        if (async) {
+            async_push(log_async_record::kind::targeted, level, 0, handler_name, format_str, std::forward<Ts>(args)...);
+            return;
+        }
+
         auto msg  = util::format(format_str, std::forward<Ts>(args)...);
         auto hash = core::fnv1a64(msg.data(), msg.size());
-        auto time = current_datetime(time_format);
+        auto time = timestamp(now());
 
         std::shared_lock lock{mtx};
         auto             found = handlers.find(handler_name);
@@ -95,32 +108,157 @@ public:
     }
 
     template <typename... Ts>
-    void log(log_level level, std::string_view format_str, Ts&&... args) {
+    void log(log_level level, format_string auto format_str, Ts&&... args) {
         if (!check_level(level))
             return;
 
-        auto msg  = util::format(format_str, std::forward<Ts>(args)...);
-        auto hash = core::fnv1a64(msg.data(), msg.size());
-        auto time = current_datetime(time_format);
+        if (bin) {
+            bin->write(level, format_str, args...);
+            return;
+        }
 
-        std::shared_lock lock{mtx};
-        for (auto& [_, handler] : handlers)
-            handler->write(level, time, msg, hash);
+        if (async) {
+            async_push(log_async_record::kind::log, level, 0, {}, format_str, std::forward<Ts>(args)...);
+            return;
+        }
+
+        write_all(level, util::format(format_str, std::forward<Ts>(args)...));
+    }
+
+    /* Structured record: info_kv("accepted", "fd"_ctstr, fd, "peer"_ctstr, addr)
+     * Encoded with the format set by set_kv_format() directly into the record buffer.
+     */
+    template <typename... Ts>
+    void log_kv(log_level level, std::string_view msg, const Ts&... kvs) {
+        if (!check_level(level))
+            return;
+
+        if (bin) {
+            core::small_string<255> buf;
+            log_kv_to(buf, kv_format, msg, kvs...);
+            bin->write(level, CT_STR("{}"), std::string_view(buf));
+            return;
+        }
+
+        if (async) {
+            log_async_record record{.level = level, .time = now()};
+            log_kv_to(record.msg, kv_format, msg, kvs...);
+            async_enqueue(core::mov(record));
+            return;
+        }
+
+        core::small_string<255> buf;
+        log_kv_to(buf, kv_format, msg, kvs...);
+        write_all(level, buf);
     }
 
     template <typename... Ts>
-    void log_update(log_level level, u16 update_id, std::string_view format_str, Ts&&... args) {
+    void log_update(log_level level, u16 update_id, format_string auto format_str, Ts&&... args) {
         if (!check_level(level))
             return;
 
+        if (bin) {
+            bin->write(level, format_str, args...);
+            return;
+        }
+
+        if (async) {
+            async_push(log_async_record::kind::update, level, update_id, {}, format_str, std::forward<Ts>(args)...);
+            return;
+        }
+
         auto msg  = util::format(format_str, std::forward<Ts>(args)...);
-        auto time = current_datetime(time_format);
+        auto time = timestamp(now());
 
         std::shared_lock lock{mtx};
         for (auto& [_, handler] : handlers)
             handler->write_update(update_id, level, time, msg);
     }
 
+    /* Logs the record only if the limiter allows it, rejected calls are not formatted
+     * Calls suppressed since the previous allowed record are reported right after it.
+     */
+    template <typename... Ts>
+    void log_limited(log_limiter& limiter, log_level level, format_string auto format_str, Ts&&... args) {
+        if (!check_level(level) || !limiter.allow())
+            return;
+
+        log(level, format_str, std::forward<Ts>(args)...);
+        if (auto suppressed = limiter.take_suppressed())
+            log_suppressed(limiter, level, suppressed);
+    }
+
+    /* Reports calls suppressed by all limiters which were not followed by an allowed record
+     * Should be called periodically, e.g. from a timer.
+     */
+    void flush_limits(log_level level = log_level::warn) {
+        auto&           registry = log_limit_registry::instance();
+        std::lock_guard lock{registry.mtx};
+        for (auto& limiter : registry.limiters)
+            if (auto suppressed = limiter.take_suppressed())
+                log_suppressed(limiter, level, suppressed);
+    }
+
+    /* Switches to async mode: records are formatted on the calling thread, queued
+     * and written by a background thread in batches.
+     * Must not be called concurrently with logging.
+     */
+    void start_async(log_async_options options = {}) {
+        if (async)
+            return;
+
+        {
+            std::unique_lock lock{mtx};
+            for (auto& [_, handler] : handlers)
+                handler->buffered(true);
+        }
+
+        async         = core::boxed<log_async_state>(options);
+        async->thread = std::thread([this] { async_loop(); });
+    }
+
+    /* Writes all queued records and switches back to sync mode
+     * Must not be called concurrently with logging.
+     */
+    void stop_async() {
+        if (!async)
+            return;
+
+        async->queue.push(log_async_record{.type = log_async_record::kind::stop});
+        async->thread.join();
+        async = {};
+
+        std::unique_lock lock{mtx};
+        for (auto& [_, handler] : handlers)
+            handler->buffered(false);
+    }
+
+    /* Waits until all records logged by this thread before the call are written */
+    void flush() {
+        if (!async)
+            return;
+
+        bool done = false;
+        async->queue.push(log_async_record{.type = log_async_record::kind::flush, .done = &done});
+
+        std::unique_lock lock{async->flush_mtx};
+        async->flush_cv.wait(lock, [&] { return done; });
+    }
+
+    /* Switches to binary mode: log() and log_update() write records to the binary log instead of handlers,
+     * text is produced later by binlog_reader. Empty box switches back to text mode.
+     * Must not be called concurrently with logging.
+     */
+    void set_binlog(core::box<binlog> binary_log) {
+        bin = core::mov(binary_log);
+    }
+
+    /* Number of records discarded because the async queue was full */
+    [[nodiscard]]
+    u64 dropped() const {
+        return async ? async->dropped.load(std::memory_order_relaxed) : 0;
+    }
+
     void set_level(log_level value) {
         level = value;
     }
@@ -131,12 +269,16 @@ public:
 
 #define def_log_func(level)                                                             \
     template <typename... Ts>                                                           \
-    void level(std::string_view format_str, Ts&&... args) {                             \
+    void level(format_string auto format_str, Ts&&... args) {                           \
         log(log_level::level, format_str, std::forward<Ts>(args)...);                   \
     }                                                                                   \
     template <typename... Ts>                                                           \
-    void level##_update(u16 update_id, std::string_view format_str, Ts&&... args) {     \
+    void level##_update(u16 update_id, format_string auto format_str, Ts&&... args) {   \
         log_update(log_level::level, update_id, format_str, std::forward<Ts>(args)...); \
+    }                                                                                   \
+    template <typename... Ts>                                                           \
+    void level##_kv(std::string_view msg, const Ts&... kvs) {                           \
+        log_kv(log_level::level, msg, kvs...);                                          \
     }
 
     def_log_func(debug)
@@ -146,12 +288,138 @@ public:
     def_log_func(error)
 #undef def_log_func
 
-    private : bool check_level(log_level target_level) {
+    void set_kv_format(log_kv_format value) {
+        kv_format = value;
+    }
+
+    /* Timestamps are taken from CLOCK_REALTIME_COARSE: cheaper, but with a resolution of a few milliseconds */
+    void coarse_clock(bool value) {
+        coarse.store(value, std::memory_order_relaxed);
+    }
+
+private:
+    std::chrono::system_clock::time_point now() const {
+        return coarse.load(std::memory_order_relaxed) ? coarse_now() : std::chrono::system_clock::now();
+    }
+
+    /* Valid until the next call on the same thread */
+    static std::string_view timestamp(std::chrono::system_clock::time_point time) {
+        thread_local datetime_format formatter{time_format};
+        return formatter(time);
+    }
+
+    void log_suppressed(const log_limiter& limiter, log_level lvl, u64 suppressed) {
+        auto& where = limiter.where();
+        log(lvl, CT_STR("******* {}:{}: {} records suppressed *******"), std::string_view(where.file_name()), where.line(), suppressed);
+    }
+
+    void write_all(log_level lvl, std::string_view msg) {
+        auto hash = core::fnv1a64(msg.data(), msg.size());
+        auto time = timestamp(now());
+
+        std::shared_lock lock{mtx};
+        for (auto& [_, handler] : handlers)
+            handler->write(lvl, time, msg, hash);
+    }
+
+    bool check_level(log_level target_level) {
         return target_level >= level;
     }
 
+    template <typename... Ts>
+    static void format_msg(auto& output, format_string auto format_str, Ts&&... args) {
+        if constexpr (core::is_ct_str<decltype(format_str)>)
+            util::format_to(output, format_str, std::forward<Ts>(args)...);
+        else
+            output = util::format(format_str, std::forward<Ts>(args)...);
+    }
+
+    template <typename... Ts>
+    void async_push(log_async_record::kind type, log_level lvl, u16 update_id, std::string_view target, format_string auto format_str, Ts&&... args) {
+        log_async_record record{.type = type, .level = lvl, .update_id = update_id, .time = now()};
+        format_msg(record.msg, format_str, std::forward<Ts>(args)...);
+        if (!target.empty())
+            record.target = target;
+        async_enqueue(core::mov(record));
+    }
+
+    void async_enqueue(log_async_record&& record) {
+        if (async->options.overflow == log_overflow::block)
+            async->queue.push(core::mov(record));
+        else if (!async->queue.try_push(core::mov(record)))
+            async->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /* Called with shared lock of mtx */
+    void async_write(const log_async_record& record) {
+        std::string_view msg = record.msg;
+        switch (record.type) {
+        case log_async_record::kind::log: {
+            auto hash = core::fnv1a64(msg.data(), msg.size());
+            auto time = timestamp(record.time);
+            for (auto& [_, handler] : handlers)
+                handler->write(record.level, time, msg, hash);
+        } break;
+        case log_async_record::kind::update: {
+            auto time = timestamp(record.time);
+            for (auto& [_, handler] : handlers)
+                handler->write_update(record.update_id, record.level, time, msg);
+        } break;
+        case log_async_record::kind::targeted: {
+            auto found = handlers.find(record.target);
+            if (found != handlers.end())
+                found->second->write(record.level, timestamp(record.time), msg, core::fnv1a64(msg.data(), msg.size()));
+        } break;
+        case log_async_record::kind::flush:
+        case log_async_record::kind::stop: break;
+        }
+    }
+
+    void async_loop() {
+        std::vector<log_async_record> batch(async->options.batch_size);
+        u64                           reported_drops = 0;
+        bool                          stop           = false;
+
+        while (!stop) {
+            auto records = std::span(batch.data(), async->queue.pop(batch.data(), batch.size()));
+
+            std::shared_lock lock{mtx};
+            if (auto drops = async->dropped.load(std::memory_order_relaxed); drops != reported_drops) {
+                log_async_record record{.level = log_level::warn, .time = now()};
+                format_msg(record.msg, CT_STR("******* {} records dropped *******"), drops - reported_drops);
+                async_write(record);
+                reported_drops = drops;
+            }
+
+            for (auto& record : records) {
+                async_write(record);
+                stop = stop || record.type == log_async_record::kind::stop;
+            }
+
+            for (auto& [_, handler] : handlers)
+                handler->flush();
+            lock.unlock();
+
+            bool notify = false;
+            for (auto& record : records) {
+                if (record.done) {
+                    std::lock_guard flush_lock{async->flush_mtx};
+                    *record.done = true;
+                    record.done  = nullptr;
+                    notify       = true;
+                }
+            }
+            if (notify)
+                async->flush_cv.notify_all();
+        }
+    }
+
     std::map<std::string, core::box<log_handler_base>> handlers;
     mutable std::shared_mutex                          mtx;
-    log_level                                          level = log_level::debug;
+    log_level                                          level     = log_level::debug;
+    log_kv_format                                      kv_format = log_kv_format::logfmt;
+    std::atomic<bool>                                  coarse    = false;
+    core::box<log_async_state>                         async;
+    core::box<binlog>                                  bin;
 };
 } // namespace util
@@ -82,7 +82,7 @@ void print_any(std::ostream& os, const T(&value)[S]) {
     }
 }
 
-void print_any(std::ostream& os, printable_range auto&& value) {
+void print_any(std::ostream& os, const printable_range auto& value) {
     auto i = value.begin();
     if (i == value.end()) {
         os << "{}";
@@ -1,10 +1,14 @@
 #pragma once
 
-#include <sstream>
+#include <algorithm>
 #include <chrono>
-#include <iomanip>
+#include <ctime>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
 
-#include <core/basic_types.hpp>
+#include <util/basic_types.hpp>
 
 namespace util
 {
@@ -17,11 +21,11 @@ struct time_info_t {
     std::chrono::nanoseconds  nanosecond;
 };
 
-inline time_info_t get_current_time() {
+inline time_info_t get_time_info(std::chrono::system_clock::time_point time) {
     namespace chr = std::chrono;
     using namespace std::chrono_literals;
 
-    auto        now = chr::system_clock::now().time_since_epoch();
+    auto        now = time.time_since_epoch();
     time_info_t t; // NOLINT
 
     auto acc = 0ns + chr::floor<chr::days>(now);
@@ -41,61 +45,155 @@ inline time_info_t get_current_time() {
     return t;
 }
 
-inline std::string current_datetime(std::string_view format) {
-    namespace chr = std::chrono;
+inline time_info_t get_current_time() {
+    return get_time_info(std::chrono::system_clock::now());
+}
+
+/* Datetime pattern parsed once
+ * Runs of h, m, s, x, u, n are replaced with hours, minutes, seconds, milliseconds, microseconds
+ * and nanoseconds padded with zeros to the length of the run, other chars are copied (D, M, Y are ignored).
+ * The part before the first sub-second field is cached and reformatted only when the second changes.
+ * Not thread-safe, use one instance per thread.
+ */
+class datetime_format {
+public:
+    static constexpr size_t max_size = 64;
+
+    explicit datetime_format(std::string_view format) {
+        size_t bound = 0;
+        for (size_t i = 0; i < format.size();) {
+            auto c = format[i];
+            auto n = size_t(1);
+            if (is_field(c))
+                while (i + n < format.size() && format[i + n] == c)
+                    ++n;
+
+            if (_count == std::size(_items) || n > 255)
+                throw std::invalid_argument("datetime_format: format is too long");
+
+            auto& item = _items[_count++];
+            item.type  = is_field(c) ? c : '\0';
+            item.c     = c;
+            item.width = u8(n);
+            bound += is_field(c) ? std::max<size_t>(n, 3) : 1;
+
+            if (_subsec == none && (c == 'x' || c == 'u' || c == 'n'))
+                _subsec = _count - 1;
+
+            i += n;
+        }
 
-    /* TODO: remove stringstream */
-    std::stringstream ss;
+        if (_subsec == none)
+            _subsec = _count;
+        if (bound > max_size)
+            throw std::invalid_argument("datetime_format: format is too long");
+    }
+
+    /* Returned view is valid until the next call */
+    std::string_view operator()(std::chrono::system_clock::time_point time) {
+        auto ns      = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+        auto seconds = ns / 1000000000;
+        auto subsec  = ns % 1000000000;
+        if (subsec < 0) {
+            --seconds;
+            subsec += 1000000000;
+        }
 
-    auto time = get_current_time();
+        if (seconds != _cached_second) {
+            auto day_second = u32(((seconds % 86400) + 86400) % 86400);
+            _values[0]      = day_second / 3600;
+            _values[1]      = day_second / 60 % 60;
+            _values[2]      = day_second % 60;
+            _prefix_size    = size_t(write(_buf, 0, _subsec) - _buf);
+            _cached_second  = seconds;
+        }
+
+        _values[3] = u32(subsec / 1000000);
+        _values[4] = u32(subsec / 1000 % 1000);
+        _values[5] = u32(subsec % 1000);
+
+        auto end = write(_buf + _prefix_size, _subsec, _count);
+        return {_buf, size_t(end - _buf)};
+    }
 
-    std::array<bool, 256> charmap = {false};
-    charmap['D'] = charmap['M'] = charmap['Y'] = charmap['h'] = charmap['m'] = charmap['s'] =
-        charmap['x'] = charmap['u'] = charmap['n'] = true;
+private:
+    static constexpr size_t none = ~size_t(0);
 
-    static constexpr auto padprint = [](std::stringstream& ss, int c, auto v) {
-        ss << std::setfill('0') << std::setw(c) << v;
+    struct item {
+        char type; /* '\0' for literal */
+        char c;
+        u8   width;
     };
 
-    int counter = 0;
-
-    auto printtm = [&](char f) {
-        if (counter) {
-            switch (f) {
-            // case 'D': padprint(ss, counter, u32(ymd.day)); break;
-            // case 'M': padprint(ss, counter, u32(ymd.month)); break;
-            // case 'Y': padprint(ss, counter, int(ymd.year)); break;
-            case 'h': padprint(ss, counter, time.hour.count()); break;
-            case 'm': padprint(ss, counter, time.minute.count()); break;
-            case 's': padprint(ss, counter, time.second.count()); break;
-            case 'x': padprint(ss, counter, time.millisecond.count()); break;
-            case 'u': padprint(ss, counter, time.microsecond.count()); break;
-            case 'n': padprint(ss, counter, time.nanosecond.count()); break;
+    static constexpr bool is_field(char c) {
+        switch (c) {
+        case 'D':
+        case 'M':
+        case 'Y':
+        case 'h':
+        case 'm':
+        case 's':
+        case 'x':
+        case 'u':
+        case 'n': return true;
+        default: return false;
+        }
+    }
+
+    static char* write_padded(char* out, u32 value, u8 width) {
+        char digits[10];
+        auto n = size_t(0);
+        do {
+            digits[n++] = char('0' + value % 10);
+            value /= 10;
+        } while (value);
+
+        for (auto i = n; i < width; ++i)
+            *out++ = '0';
+        while (n)
+            *out++ = digits[--n];
+        return out;
+    }
+
+    char* write(char* out, size_t begin, size_t end) const {
+        for (auto i = begin; i != end; ++i) {
+            auto& it = _items[i];
+            switch (it.type) {
+            case '\0': *out++ = it.c; break;
+            case 'h': out = write_padded(out, _values[0], it.width); break;
+            case 'm': out = write_padded(out, _values[1], it.width); break;
+            case 's': out = write_padded(out, _values[2], it.width); break;
+            case 'x': out = write_padded(out, _values[3], it.width); break;
+            case 'u': out = write_padded(out, _values[4], it.width); break;
+            case 'n': out = write_padded(out, _values[5], it.width); break;
             default: break;
             }
-            counter = 0;
         }
-    };
-
-    char last_fmt = '\0';
-    for (auto c : format) {
-        auto is_fmt = charmap[static_cast<core::u8>(c)];
+        return out;
+    }
 
-        if (!is_fmt || last_fmt != c)
-            printtm(last_fmt);
+    item   _items[32];
+    size_t _count         = 0;
+    size_t _subsec        = none; /* Index of the first sub-second item */
+    size_t _prefix_size   = 0;
+    i64    _cached_second = std::numeric_limits<i64>::min();
+    u32    _values[6]     = {}; /* h m s x u n */
+    char   _buf[max_size];
+};
 
-        if (is_fmt)
-            ++counter;
-        else {
-            ss << c;
-            counter = 0;
-        }
+/* CLOCK_REALTIME_COARSE is served by vDSO without a syscall, resolution is a few milliseconds */
+inline std::chrono::system_clock::time_point coarse_now() {
+    timespec ts;
+    ::clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)));
+}
 
-        if (is_fmt && last_fmt != c)
-            last_fmt = c;
-    }
-    printtm(last_fmt);
+inline std::string format_datetime(std::string_view format, std::chrono::system_clock::time_point timepoint) {
+    return std::string(datetime_format(format)(timepoint));
+}
 
-    return ss.str();
+inline std::string current_datetime(std::string_view format) {
+    return format_datetime(format, std::chrono::system_clock::now());
 }
 } // namespace dfdh
@@ -0,0 +1,134 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <coroutine>
+#include <string>
+#include <thread>
+
+#include <core/arena.hpp>
+#include <core/pmr.hpp>
+#include <core/pool.hpp>
+
+using namespace core;
+
+TEST_CASE("arena") {
+    arena a{256};
+
+    auto p1 = a.allocate_n<u64>(4);
+    auto p2 = a.allocate(1, 1);
+    auto p3 = a.allocate_n<u64>(1);
+    CHECK(reinterpret_cast<uptr>(p3) % alignof(u64) == 0);
+    CHECK(static_cast<void*>(p1 + 4) <= p2);
+    CHECK(a.stats().allocations == 3);
+    CHECK(a.stats().chunks == 1);
+
+    /* Oversized allocation gets a dedicated chunk */
+    auto big = a.allocate(1024);
+    CHECK(big != nullptr);
+    CHECK(a.stats().chunks == 2);
+
+    auto str = a.create<std::string>("test");
+    CHECK(*str == "test");
+    str->~basic_string();
+
+    a.reset();
+    CHECK(a.stats().chunks == 1);
+    CHECK(a.stats().allocations == 0);
+
+    a.release();
+    CHECK(a.stats().bytes_reserved == 0);
+}
+
+TEST_CASE("pool") {
+    pool<std::string, 8> p;
+
+    std::vector<std::string*> ptrs;
+    for (int i = 0; i < 20; ++i)
+        ptrs.push_back(p.create(std::to_string(i)));
+    CHECK(*ptrs[13] == "13");
+    CHECK(p.stats().chunks == 3);
+
+    for (auto s : ptrs)
+        p.destroy(s);
+    CHECK(p.stats().allocations == 20);
+    CHECK(p.stats().deallocations == 20);
+
+    /* Freed blocks are reused */
+    auto s = p.create("reused");
+    CHECK(p.stats().chunks == 3);
+    p.destroy(s);
+
+    std::thread([&] {
+        for (int i = 0; i < 100; ++i)
+            p.destroy(p.create("from thread"));
+    }).join();
+    CHECK(p.stats().deallocations == 121);
+
+    /* Switching the thread cache to another pool returns the cached blocks */
+    pool<std::string, 8> q;
+    auto                 chunks = p.stats().chunks;
+    for (int i = 0; i < 100; ++i) {
+        p.destroy(p.create("p"));
+        q.destroy(q.create("q"));
+    }
+    CHECK(p.stats().chunks == chunks);
+    CHECK(q.stats().chunks == 1);
+}
+
+struct frame_test_coro {
+    struct promise_type : pmr::frame_allocated {
+        frame_test_coro get_return_object() {
+            return {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() {}
+        void unhandled_exception() {}
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+frame_test_coro frame_test(std::allocator_arg_t, pmr::allocator<>, int) {
+    co_return;
+}
+
+frame_test_coro frame_test(int) {
+    co_return;
+}
+
+TEST_CASE("pmr") {
+    pmr::arena_resource resource;
+
+    SECTION("vector") {
+        pmr::vector<int> v{&resource};
+        for (int i = 0; i < 100; ++i)
+            v.push_back(i);
+        CHECK(v[99] == 99);
+        CHECK(resource.stats().allocations > 0);
+    }
+
+    SECTION("ring_buffer") {
+        pmr::ring_buffer<int> r{4, &resource};
+        r.push(1);
+        r.resize(8);
+        CHECK(r.size() == 1);
+        CHECK(resource.stats().allocations == 2);
+    }
+
+    SECTION("coroutine frame") {
+        auto c = frame_test(std::allocator_arg, &resource, 1);
+        CHECK(resource.stats().allocations == 1);
+        c.handle.destroy();
+        CHECK(resource.stats().deallocations == 1);
+
+        frame_test(1).handle.destroy();
+        CHECK(resource.stats().allocations == 1);
+    }
+}
@@ -51,3 +51,32 @@ TEST_CASE("args") {
     std::cout << "LOL: " << a.lol.get() << std::endl;
     */
 }
+
+tbc_cmd(list) {
+    tbc_arg(ids, std::vector<core::u32>);
+};
+
+TEST_CASE("args number list") {
+    auto parse = [](const char* arg) {
+        const char* as[] = {"./programname", arg};
+        return util::parse_args<list_cmd<>>(int(std::size(as)), as);
+    };
+
+    REQUIRE(*parse("ids=1,2,3").ids == std::vector<core::u32>{1, 2, 3});
+    REQUIRE(*parse("ids=0,20").ids == std::vector<core::u32>{0, 20});
+    REQUIRE(*parse("ids=010,0x10,0b11,7").ids == std::vector<core::u32>{8, 16, 3, 7});
+    REQUIRE_THROWS_AS(parse("ids=1,,2"), util::missing_arg_error);
+    REQUIRE_THROWS_AS(parse("ids=1,"), util::missing_arg_error);
+    REQUIRE_THROWS_AS(parse("ids="), util::missing_arg_error);
+    REQUIRE_THROWS_AS(parse("ids=1,x"), util::missing_arg_error);
+
+    /* The offset of the bad element from parse_many is in the message */
+    std::string msg;
+    try {
+        parse("ids=1,2,x3");
+    }
+    catch (const util::missing_arg_error& e) {
+        msg = e.what();
+    }
+    REQUIRE(msg.starts_with("Invalid number at 4:"));
+}
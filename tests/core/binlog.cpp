@@ -0,0 +1,43 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <util/log/binlog.hpp>
+
+#include <vector>
+
+using namespace core::ct_str_literals;
+
+TEST_CASE("binlog") {
+    std::vector<char>  memory(4096 + 64 * 32);
+    util::binlog_writer writer({memory.data(), memory.size()}, 4096 - 64);
+
+    auto read = [&] {
+        return util::binlog_reader({memory.data(), memory.size()}).records();
+    };
+
+    SECTION("decode") {
+        writer.write(util::log_level::info, "int={} hex={x} float={.2} str={}"_ctstr, 42, 255u, 3.14159, "str");
+        writer.write(util::log_level::warn, "{} {} {} {{}}"_ctstr, true, 'c', std::vector<int>{1, 2});
+        writer.write(util::log_level::error, "runtime {}", 5);
+        writer.write(util::log_level::debug, "long {}"_ctstr, std::string(150, 'a'));
+
+        auto records = read();
+        REQUIRE(records.size() == 4);
+        CHECK(records[0].level == util::log_level::info);
+        CHECK(records[0].msg == "int=42 hex=ff float=3.14 str=str");
+        CHECK(records[1].msg == "true c {1, 2} {}");
+        CHECK(records[2].level == util::log_level::error);
+        CHECK(records[2].msg == "runtime 5");
+        CHECK(records[3].msg == "long " + std::string(150, 'a'));
+    }
+
+    SECTION("overwritten records are skipped") {
+        for (int i = 0; i < 100; ++i)
+            writer.write(util::log_level::info, "wrap {} {}"_ctstr, i, std::string(size_t(i % 70), 'b'));
+
+        auto records = read();
+        REQUIRE(!records.empty());
+        CHECK(records.back().msg == "wrap 99 " + std::string(29, 'b'));
+        for (auto& record : records)
+            CHECK(record.msg.starts_with("wrap "));
+    }
+}
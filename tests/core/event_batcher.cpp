@@ -0,0 +1,130 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <inp/event_batcher.hpp>
+
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+sys::event rel(sys::event_relative_code code, sys::i32 value) {
+    sys::event event{};
+    event.type     = sys::event_type::relative;
+    event.code.rel = code;
+    event.value    = value;
+    return event;
+}
+
+sys::event button(sys::i32 value) {
+    sys::event event{};
+    event.type     = sys::event_type::key;
+    event.code.btn = sys::event_button_code::left;
+    event.value    = value;
+    return event;
+}
+
+sys::event syn() {
+    sys::event event{};
+    event.type     = sys::event_type::synchronize;
+    event.code.raw = SYN_REPORT;
+    return event;
+}
+
+struct batch {
+    std::vector<sys::event> events;
+    sys::u32                seq;
+};
+
+struct sink {
+    void operator()(std::span<const sys::event> events, sys::u32 seq) const {
+        out.push_back({{events.begin(), events.end()}, seq});
+    }
+
+    std::vector<batch>& out;
+};
+
+bool same(const sys::event& a, const sys::event& b) {
+    return a.type == b.type && a.code.raw == b.code.raw && a.value == b.value;
+}
+
+bool same_events(const std::vector<sys::event>& a, const std::vector<sys::event>& b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i)
+        if (!same(a[i], b[i]))
+            return false;
+    return true;
+}
+} // namespace
+
+TEST_CASE("event_batcher") {
+    using enum sys::event_relative_code;
+    using batcher = inp::event_batcher<sink, 8 * sizeof(sys::event)>;
+
+    std::vector<batch>         out;
+    batcher                    b{sink{out}, 250us};
+    batcher::clock::time_point t0;
+
+    SECTION("merge_relative") {
+        b.push(std::vector{rel(x, 1), rel(y, 2), syn()}, t0);
+        b.push(std::vector{rel(x, 3), rel(wheel, -1), syn()}, t0);
+        REQUIRE(b.pending() == 4);
+
+        b.flush();
+        REQUIRE(out.size() == 1);
+        CHECK(same_events(out[0].events, {rel(x, 4), rel(y, 2), rel(wheel, -1), syn()}));
+    }
+
+    SECTION("button_ends_merge") {
+        b.push(std::vector{rel(x, 1), syn(), button(1), syn(), rel(x, 2), syn(), rel(x, 3), syn()}, t0);
+        b.flush();
+        REQUIRE(out.size() == 1);
+        CHECK(same_events(out[0].events, {rel(x, 1), syn(), button(1), syn(), rel(x, 5), syn()}));
+    }
+
+    SECTION("overflow") {
+        /* Complete reports are flushed, the open tail is kept with its own deadline */
+        b.push(std::vector{button(1), syn(), button(0), syn(), button(1), syn()}, t0);
+        b.push(std::vector{button(0), rel(x, 1)}, t0 + 100us);
+        b.push(rel(y, 1), t0 + 200us);
+
+        REQUIRE(out.size() == 1);
+        CHECK(same_events(out[0].events, {button(1), syn(), button(0), syn(), button(1), syn()}));
+        REQUIRE(b.pending() == 3);
+        REQUIRE(*b.timeout(t0 + 200us) == 150us);
+
+        b.push(syn(), t0 + 200us);
+        b.flush();
+        REQUIRE(out.size() == 2);
+        CHECK(same_events(out[1].events, {button(0), rel(x, 1), rel(y, 1), syn()}));
+    }
+
+    SECTION("deadline") {
+        REQUIRE(!b.timeout(t0));
+        REQUIRE(!b.expire(t0 + 1s));
+
+        b.push(std::vector{rel(x, 1), syn()}, t0);
+        b.push(std::vector{rel(x, 1), syn()}, t0 + 100us);
+        REQUIRE(*b.timeout(t0 + 100us) == 150us);
+        REQUIRE(*b.timeout(t0 + 300us) == 0us);
+
+        REQUIRE(!b.expire(t0 + 249us));
+        REQUIRE(out.empty());
+        REQUIRE(b.expire(t0 + 250us));
+        REQUIRE(out.size() == 1);
+        CHECK(same_events(out[0].events, {rel(x, 2), syn()}));
+        REQUIRE(!b.timeout(t0 + 250us));
+    }
+
+    SECTION("sequence") {
+        for (int i = 0; i < 3; ++i) {
+            b.push(std::vector{button(i & 1), syn()}, t0);
+            b.flush();
+        }
+        b.flush();
+        REQUIRE(b.sequence() == 3);
+        REQUIRE(out.size() == 3);
+        for (sys::u32 i = 0; i < 3; ++i)
+            CHECK(out[i].seq == i);
+    }
+}
@@ -0,0 +1,143 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <inp/event_codec.hpp>
+
+#include <limits>
+#include <vector>
+
+namespace {
+sys::event make_event(sys::i64 usec, sys::u16 type, sys::u16 code, sys::i32 value) {
+    sys::event event{};
+    event.time     = inp::event_codec::dtls::from_usec(usec);
+    event.type     = sys::event_type(type);
+    event.code.raw = code;
+    event.value    = value;
+    return event;
+}
+
+bool same_events(std::span<const sys::event> a, std::span<const sys::event> b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].time.sec != b[i].time.sec || a[i].time.usec != b[i].time.usec || a[i].type != b[i].type || a[i].code.raw != b[i].code.raw ||
+            a[i].value != b[i].value)
+            return false;
+    }
+    return true;
+}
+
+std::vector<sys::u8> encode(std::span<const sys::event> events, sys::u32 seq) {
+    std::vector<sys::u8> data(inp::event_codec::encoded_bound(events.size()));
+    data.resize(inp::event_codec::encode(events, seq, data.data()));
+    return data;
+}
+} // namespace
+
+TEST_CASE("event_codec") {
+    namespace codec = inp::event_codec;
+
+    /* Negative time deltas, an escaped type, extreme values and a time before the epoch */
+    std::vector<sys::event> events = {
+        make_event(1'700'000'000'000'123, EV_REL, REL_X, 3),
+        make_event(1'700'000'000'000'100, EV_REL, REL_Y, -7),
+        make_event(1'700'000'000'000'100, codec::type_escape, 5, std::numeric_limits<sys::i32>::min()),
+        make_event(1'700'000'000'500'000, 0x1234, 0xFFFF, std::numeric_limits<sys::i32>::max()),
+        make_event(-1, EV_SYN, SYN_REPORT, 0),
+    };
+    sys::event buff[8];
+
+    SECTION("round_trip") {
+        auto data = encode(events, 0xFFFFFFFF);
+        REQUIRE(data.size() <= codec::encoded_bound(events.size()));
+        REQUIRE(data[0] == codec::magic);
+
+        auto res = codec::decode(data, buff);
+        REQUIRE(res);
+        CHECK(res->seq == 0xFFFFFFFF);
+        CHECK(same_events(res->events, events));
+
+        auto empty = encode({}, 7);
+        res        = codec::decode(empty, buff);
+        REQUIRE(res);
+        CHECK(res->seq == 7);
+        CHECK(res->events.empty());
+    }
+
+    SECTION("malformed") {
+        auto data = encode(events, 1);
+        for (size_t size = 0; size < data.size(); ++size)
+            CHECK(!codec::decode(std::span{data}.subspan(0, size), buff));
+
+        auto bad_magic = data;
+        bad_magic[0]   = codec::magic + 1;
+        CHECK(!codec::decode(bad_magic, buff));
+
+        auto trailing = data;
+        trailing.push_back(0);
+        CHECK(!codec::decode(trailing, buff));
+
+        CHECK(!codec::decode(data, std::span{buff}.subspan(0, events.size() - 1)));
+    }
+
+    SECTION("framed") {
+        /* The second batch is longer than 127 bytes, so its size prefix takes two bytes */
+        std::vector<sys::event> many;
+        for (int i = 0; i < 40; ++i)
+            many.push_back(make_event(1'000'000 + i * 1000, EV_REL, REL_X, i - 20));
+
+        std::vector<sys::u8> stream(codec::framed_bound(events.size()) + codec::framed_bound(many.size()));
+        auto                 size = codec::encode_framed(events, 1, stream.data());
+        size                     += codec::encode_framed(many, 2, stream.data() + size);
+        stream.resize(size);
+
+        std::span<const sys::u8> rest = stream;
+        std::vector<sys::event>  decoded(many.size());
+
+        auto frame = codec::next_frame(rest);
+        REQUIRE(frame);
+        auto res = codec::decode(*frame, decoded);
+        REQUIRE(res);
+        CHECK(res->seq == 1);
+        CHECK(same_events(res->events, events));
+
+        frame = codec::next_frame(rest);
+        REQUIRE(frame);
+        REQUIRE(frame->size() > 127);
+        res = codec::decode(*frame, decoded);
+        REQUIRE(res);
+        CHECK(res->seq == 2);
+        CHECK(same_events(res->events, many));
+
+        CHECK(rest.empty());
+        CHECK(!codec::next_frame(rest));
+
+        /* Truncated frame */
+        std::span<const sys::u8> truncated{stream.data(), stream.size() - 1};
+        REQUIRE(codec::next_frame(truncated));
+        CHECK(!codec::next_frame(truncated));
+    }
+
+    SECTION("decoder") {
+        inp::event_decoder decoder;
+        auto               decode = [&](sys::u32 seq) {
+            return bool(decoder.decode(encode(events, seq), buff));
+        };
+
+        REQUIRE(decode(10));
+        REQUIRE(decode(11));
+        REQUIRE(decode(14));
+        CHECK(decoder.lost() == 2);
+        CHECK(decoder.reordered() == 0);
+
+        /* A late batch is not lost anymore */
+        REQUIRE(decode(12));
+        CHECK(decoder.lost() == 1);
+        CHECK(decoder.reordered() == 1);
+
+        REQUIRE(decode(15));
+        CHECK(decoder.lost() == 1);
+
+        CHECK(!decoder.decode(std::vector<sys::u8>{0}, buff));
+        CHECK(decoder.lost() == 1);
+    }
+}
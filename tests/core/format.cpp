@@ -0,0 +1,99 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <core/small_string.hpp>
+#include <util/ct_format.hpp>
+#include <util/time.hpp>
+
+#include <vector>
+
+using namespace core::ct_str_literals;
+
+TEST_CASE("ct_format") {
+    SECTION("basic") {
+        CHECK(util::format("no args"_ctstr) == "no args");
+        CHECK(util::format("{} + {} = {}"_ctstr, 2, 2u, 4ll) == "2 + 2 = 4");
+        CHECK(util::format("[{}] [{}] [{}]"_ctstr, "cstr", std::string("str"), std::string_view("sv")) == "[cstr] [str] [sv]");
+        CHECK(util::format("{}{}"_ctstr, 'a', true) == "atrue");
+        CHECK(util::format("{{{}}}"_ctstr, 1) == "{1}");
+    }
+
+    SECTION("specs") {
+        CHECK(util::format("{x} {X} {b} {o}"_ctstr, 255, 255, 5, 8) == "ff FF 101 10");
+        CHECK(util::format("{x}"_ctstr, (unsigned char)10) == "a");
+        CHECK(util::format("{.2} {e} {f}"_ctstr, 3.14159, 1e10, 2.5f) == "3.14 1.000000e+10 2.500000");
+        CHECK(util::format("{}"_ctstr, (const void*)0x1234) == "0x1234");
+    }
+
+    SECTION("limits") {
+        CHECK(util::format("{}"_ctstr, INT64_MIN) == "-9223372036854775808");
+        CHECK(util::format("{x}"_ctstr, UINT64_MAX) == "ffffffffffffffff");
+        CHECK(util::format("{.1}"_ctstr, -1e308).size() == 312);
+    }
+
+    SECTION("same output as runtime format") {
+        CHECK(util::format("{} {} {}"_ctstr, 0.1 + 0.2, 1e100, 123456789.0) == util::format("{} {} {}", 0.1 + 0.2, 1e100, 123456789.0));
+        CHECK(util::format("{} {}"_ctstr, std::vector{1, 2, 3}, -1.5f) == util::format("{} {}", std::vector{1, 2, 3}, -1.5f));
+    }
+
+    SECTION("format_to appends") {
+        core::small_string<8> buf;
+        util::format_to(buf, "x={}"_ctstr, 1);
+        util::format_to(buf, " y={}"_ctstr, 12345678901ll);
+        CHECK(std::string_view(buf) == "x=1 y=12345678901");
+
+        std::vector<char> vec;
+        util::format_to(vec, "{}!"_ctstr, 7);
+        CHECK(std::string_view(vec.data(), vec.size()) == "7!");
+    }
+}
+
+TEST_CASE("ct_format benchmark", "[.benchmark]") {
+    std::string name = "handler";
+    std::string buf;
+
+    BENCHMARK("util::format runtime") {
+        return util::format("[{}] fd={} written={} ratio={}", name, 17, 4096u, 0.75).size();
+    };
+
+    BENCHMARK("util::format ct_str") {
+        return util::format("[{}] fd={} written={} ratio={}"_ctstr, name, 17, 4096u, 0.75).size();
+    };
+
+    BENCHMARK("util::format_to ct_str") {
+        buf.clear();
+        util::format_to(buf, "[{}] fd={} written={} ratio={}"_ctstr, name, 17, 4096u, 0.75);
+        return buf.size();
+    };
+}
+
+TEST_CASE("datetime_format") {
+    using namespace std::chrono_literals;
+    auto time = std::chrono::system_clock::time_point(1h * (24 * 365) + 13h + 5min + 9s + 42ms + 7us + 3ns);
+
+    util::datetime_format format{"[hh:mm:ss.xxx]"};
+    CHECK(format(time) == "[13:05:09.042]");
+    CHECK(format(time + 900ms) == "[13:05:09.942]");
+    CHECK(format(time + 1s) == "[13:05:10.042]");
+    CHECK(format(time + 11h) == "[00:05:09.042]");
+
+    CHECK(util::format_datetime("x.uuu.nnn hh", time) == "42.007.003 13");
+    CHECK(util::format_datetime("DD.MM.YYYY h:m:s", time) == ".. 13:5:9");
+    CHECK_THROWS_AS(util::datetime_format(std::string(100, 'a')), std::invalid_argument);
+}
+
+TEST_CASE("datetime_format benchmark", "[.benchmark]") {
+    util::datetime_format format{"[hh:mm:ss.xxx]"};
+
+    BENCHMARK("util::current_datetime") {
+        return util::current_datetime("[hh:mm:ss.xxx]").size();
+    };
+
+    BENCHMARK("util::datetime_format") {
+        return format(std::chrono::system_clock::now()).size();
+    };
+
+    BENCHMARK("util::datetime_format coarse") {
+        return format(util::coarse_now()).size();
+    };
+}
@@ -0,0 +1,132 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <core/intrusive_hash_set.hpp>
+#include <core/intrusive_heap.hpp>
+#include <core/intrusive_list.hpp>
+
+using namespace core;
+
+namespace {
+struct second_list_tag {};
+
+struct item : intrusive_list_hook<>, intrusive_list_hook<second_list_tag>, intrusive_heap_hook<>, intrusive_hash_set_hook<> {
+    item(int ivalue = 0): value(ivalue) {}
+
+    int key() const {
+        return value;
+    }
+
+    bool operator<(const item& rhs) const {
+        return value < rhs.value;
+    }
+
+    int value;
+};
+} // namespace
+
+TEST_CASE("intrusive_list") {
+    intrusive_list<item>                  l;
+    intrusive_list<item, second_list_tag> l2;
+
+    item a{1}, b{2}, c{3};
+    l.push_back(b);
+    l.push_front(a);
+    l.push_back(c);
+    l2.push_back(c);
+    l2.push_back(a);
+
+    std::vector<int> values;
+    for (auto& i : l)
+        values.push_back(i.value);
+    CHECK(values == std::vector{1, 2, 3});
+    CHECK(l2.front().value == 3);
+
+    l.erase(b);
+    CHECK(l.size() == 2);
+    CHECK_FALSE(static_cast<intrusive_list_hook<>&>(b).is_linked());
+
+    {
+        item d{4};
+        l.push_back(d);
+        CHECK(l.back().value == 4);
+    }
+    /* d unlinked itself */
+    CHECK(l.back().value == 3);
+    CHECK(l2.size() == 2);
+
+    l.pop_front();
+    CHECK(l.front().value == 3);
+    l.clear();
+    CHECK(l.empty());
+    CHECK(l2.size() == 2);
+}
+
+TEST_CASE("intrusive_heap") {
+    std::vector<item> items;
+    for (int i = 0; i < 200; ++i)
+        items.emplace_back(i);
+    std::shuffle(items.begin(), items.end(), std::mt19937{42});
+
+    intrusive_heap<item> h;
+    for (auto& i : items)
+        h.push(i);
+    CHECK(h.size() == 200);
+    CHECK(h.top().value == 0);
+
+    /* Erase odd values */
+    for (auto& i : items)
+        if (i.value % 2)
+            h.erase(i);
+    CHECK(h.size() == 100);
+
+    std::vector<int> sorted;
+    while (!h.empty()) {
+        sorted.push_back(h.top().value);
+        h.pop();
+    }
+    CHECK(sorted.size() == 100);
+    CHECK(std::is_sorted(sorted.begin(), sorted.end()));
+    CHECK(sorted.front() == 0);
+
+    item x{10}, y{20};
+    h.push(x);
+    h.push(y);
+    y.value = 5;
+    h.update(y);
+    CHECK(h.top().value == 5);
+    h.clear();
+}
+
+TEST_CASE("intrusive_hash_set") {
+    std::vector<item> items;
+    for (int i = 0; i < 100; ++i)
+        items.emplace_back(i * 3);
+
+    intrusive_hash_set<item> s{4};
+    for (auto& i : items)
+        CHECK(s.insert(i));
+    CHECK(s.size() == 100);
+
+    item dup{3};
+    CHECK_FALSE(s.insert(dup));
+
+    CHECK(s.find(42) == &items[14]);
+    CHECK(s.find(43) == nullptr);
+
+    s.erase(items[14]);
+    CHECK(s.find(42) == nullptr);
+    CHECK(s.extract(3) == &items[1]);
+    CHECK(s.size() == 98);
+
+    size_t count = 0;
+    s.foreach([&](item&) { ++count; });
+    CHECK(count == 98);
+
+    s.clear();
+    CHECK(s.empty());
+    CHECK_FALSE(static_cast<intrusive_hash_set_hook<>&>(items[0]).is_linked());
+}
@@ -1,15 +1,21 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include <iostream>
+#include <sys/socket.h>
 
 
 
 #include <core/string_builder.hpp>
 
+#include <core/async/runner.hpp>
+#include <core/io/copy.hpp>
+#include <core/io/direct_file.hpp>
 #include <core/io/file.hpp>
 #include <core/io/in.hpp>
+#include <core/io/in_ahead.hpp>
 #include <core/io/mmap.hpp>
 #include <core/io/out.hpp>
+#include <core/io/out_behind.hpp>
 #include <core/utility/as_const.hpp>
 #include <sys/event.hpp>
 #include <sys/lseek.hpp>
@@ -98,6 +104,13 @@ auto pipe_with(const trivial_span_like auto& data) {
     return p;
 }
 
+/* Runs the coroutine in a new uring context and returns its result */
+auto run_async(auto&& start_coro) {
+    auto signalfd           = io::file::signalfd(sys::sigset::empty(), sys::sigfd_flag::close_exec);
+    async::current_signalfd = &signalfd;
+    return async::run_io_ctx(fwd(start_coro));
+}
+
 TEST_CASE("file") {
     SECTION("dtor_close") {
         io::fd_t fd;
@@ -221,6 +234,23 @@ TEST_CASE("in") {
         test_seek(memfd_with(b));
     }
 
+    SECTION("read_until") {
+        std::string data = "first\n\n" + std::string(20, 'x') + "\nlast";
+        io::in in{memfd_with(data), size_c<8>};
+
+        std::vector<std::string> lines;
+        while (auto line = in.read_until('\n'))
+            lines.emplace_back(*line);
+        REQUIRE(lines == std::vector<std::string>{"first", "", std::string(20, 'x'), "last"});
+        REQUIRE(!in.read_until('\n'));
+
+        io::in in2{memfd_with(std::string("a;b;;c;"))};
+        lines.clear();
+        for (auto line : in2.lines(';'))
+            lines.emplace_back(line);
+        REQUIRE(lines == std::vector<std::string>{"a", "b", "", "c"});
+    }
+
     SECTION("read_pipe_bypass") {
         std::vector data{'h', 'e', 'l', 'l', 'o', '!', '\0'};
         auto base = pipe_with(data);
@@ -396,6 +426,24 @@ TEST_CASE("out") {
         write_buff(memfd_with(std::string{}));
     }
 
+    SECTION("write_gather") {
+        auto memf = io::file::memfd("test");
+        auto big  = std::string(100, 'x');
+        {
+            io::out<io::fd_t, 16> o{memf.fd()};
+            o.write("head"sv);
+            o.write("[", big, "]", 'e');
+            REQUIRE(o.buffer_size() == 0);
+            o.write("nd");
+        }
+
+        io::in i{memf};
+        i.seek(0, io::seek_whence::set);
+        std::string s(200, ' ');
+        s.resize(i.read(s));
+        REQUIRE(s == "head[" + big + "]end");
+    }
+
     SECTION("partial_write") {
         class rw_impl_di : public io::rw_impl<io::fd_t> {
         public:
@@ -550,4 +598,422 @@ TEST_CASE("mmap") {
             REQUIRE(map.from_byteview<u64>(8) == 0xdeadbeefdeadface);
         }
     }
+
+    SECTION("mmap_backend") {
+        auto f = io::file::memfd("test");
+        {
+            io::out o{io::mmap{f, io::map_flags::shared, io::map_prots::read | io::map_prots::write, 4096}, size_c<0>};
+            o.write(std::string(5000, 'x'));
+            o.write("end");
+            o.sync();
+        }
+        REQUIRE(sys::statx(f, sys::statx_mask::size).get().size == 5003);
+
+        io::in i{io::mmap{f, io::map_flags::priv, io::map_prots::read}, size_c<0>};
+        i.advise(io::madvise_advice::sequential);
+        REQUIRE(i.read_view(5000).size() == 5000);
+        REQUIRE(std::string_view((const char*)i.view(5000, 10).data(), i.view(5000, 10).size()) == "end");
+
+        std::string s(10, ' ');
+        s.resize(i.read(s));
+        REQUIRE(s == "end");
+        REQUIRE(i.read_view(1).empty());
+    }
+
+    SECTION("mmap_backend_short_write") {
+        auto f = io::file::memfd("test");
+        {
+            io::out o{io::mmap{f, io::map_flags::shared, io::map_prots::read | io::map_prots::write, 4096}, size_c<0>};
+            o.write("abc");
+        }
+        REQUIRE(sys::statx(f, sys::statx_mask::size).get().size == 3);
+
+        {
+            io::out o{io::mmap{f, io::map_flags::shared, io::map_prots::read | io::map_prots::write, 3}, size_c<0>};
+            o.write("xy");
+        }
+        io::in i{io::mmap{f, io::map_flags::priv, io::map_prots::read}, size_c<0>};
+        REQUIRE(std::string_view((const char*)i.view(0, 10).data(), i.view(0, 10).size()) == "xy");
+    }
+
+    SECTION("mmap_backend_private_writer") {
+        auto f = io::file::memfd("test");
+        io::out{f}.write("abcdef");
+
+        bool rejected = false;
+        try {
+            io::out o{io::mmap{f, io::map_flags::priv, io::map_prots::read | io::map_prots::write}, size_c<0>};
+            o.write("xyz");
+        }
+        catch (const errc_exception& e) {
+            rejected = e.error() == errc::einval;
+        }
+        REQUIRE(rejected);
+
+        io::in i{io::mmap{f, io::map_flags::priv, io::map_prots::read}, size_c<0>};
+        REQUIRE(std::string_view((const char*)i.view(0, 10).data(), i.view(0, 10).size()) == "abcdef");
+    }
+}
+
+TEST_CASE("copy") {
+    std::string data(100000, ' ');
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = char('a' + i % 26);
+
+    auto read_back = [](io::file& f) {
+        io::in in{f};
+        in.seek(0, io::seek_whence::set);
+        std::string s(200000, ' ');
+        s.resize(in.read(s));
+        return s;
+    };
+
+    SECTION("file_to_file") {
+        auto src = memfd_with(data);
+        auto dst = io::file::memfd("test");
+        REQUIRE(io::copy(src, dst) == data.size());
+        REQUIRE(read_back(dst) == data);
+
+        src = memfd_with(data);
+        dst = io::file::memfd("test");
+        REQUIRE(io::copy(src, dst, 100) == 100);
+        REQUIRE(read_back(dst) == data.substr(0, 100));
+    }
+
+    SECTION("pipe") {
+        auto src = memfd_with("hello"sv);
+        auto p   = io::file::pipe(io::pipeflags::nonblock);
+        REQUIRE(io::copy(src, p.out) == 5);
+
+        /* Stops on the empty nonblocking pipe */
+        auto dst = io::file::memfd("test");
+        REQUIRE(io::copy(p.in, dst) == 5);
+        REQUIRE(read_back(dst) == "hello");
+    }
+
+    SECTION("socket_to_file") {
+        /* Neither side is a pipe, the data goes through an intermediate one */
+        int sv[2];
+        REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+        auto sent = std::string_view(data).substr(0, 50000);
+        for (size_t pos = 0; pos < sent.size();)
+            pos += sys::write(sys::fd_t(sv[1]), sent.data() + pos, sent.size() - pos).get();
+        sys::close(sys::fd_t(sv[1]));
+
+        auto dst = io::file::memfd("test");
+        REQUIRE(io::copy(sys::fd_t(sv[0]), dst) == sent.size());
+        sys::close(sys::fd_t(sv[0]));
+        REQUIRE(read_back(dst) == sent);
+    }
+
+    SECTION("fallback") {
+        auto src = memfd_with(data);
+        auto dst = io::file::memfd("test");
+        REQUIRE(io::details::copy_buffered(src, dst, size_t(-1)) == data.size());
+        REQUIRE(read_back(dst) == data);
+
+        src = memfd_with(data);
+        dst = io::file::memfd("test");
+        REQUIRE(io::details::copy_through_pipe(src, dst, 1000) == 1000u);
+        REQUIRE(read_back(dst) == data.substr(0, 1000));
+    }
+
+    SECTION("backends") {
+        /* The fd types cached by the backends are used */
+        auto src = memfd_with(data);
+        auto dst = io::file::memfd("test");
+        {
+            io::in  i{src};
+            io::out o{dst};
+            REQUIRE(io::copy(i, o) == data.size());
+        }
+        REQUIRE(read_back(dst) == data);
+    }
+}
+
+TEST_CASE("copy_async") {
+    std::string data(100000, ' ');
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = char('a' + i % 26);
+
+    auto read_back = [](io::file& f) {
+        io::in in{f};
+        in.seek(0, io::seek_whence::set);
+        std::string s(200000, ' ');
+        s.resize(in.read(s));
+        return s;
+    };
+
+    SECTION("file_to_file") {
+        auto src    = memfd_with(data);
+        auto dst    = io::file::memfd("test");
+        auto copied = run_async([&]() -> task<size_t> {
+            co_return co_await async::copy(src, dst);
+        });
+        REQUIRE(copied == data.size());
+        REQUIRE(read_back(dst) == data);
+    }
+
+    SECTION("pipe_backends") {
+        auto p = pipe_with("hello"sv);
+        p.out  = {};
+
+        auto dst    = io::file::memfd("test");
+        auto copied = run_async([&]() -> task<size_t> {
+            io::in  i{p.in};
+            io::out o{dst};
+            co_return co_await async::copy(i, o);
+        });
+        REQUIRE(copied == 5);
+        REQUIRE(read_back(dst) == "hello");
+    }
+}
+
+TEST_CASE("direct_file") {
+    auto f = io::direct_file::open(".", sys::openflag::temp | sys::openflag::read_write);
+    REQUIRE(f.alignment() > 0);
+
+    std::string data(3 * 65536 + 1234, ' ');
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = char('a' + i * 7 % 26);
+
+    {
+        io::direct_out<65536, 2> o{f};
+        o.write(data);
+        o.flush();
+        REQUIRE(f.size() == data.size());
+        o.write("xyz"sv);
+    }
+    REQUIRE(f.size() == data.size() + 3);
+
+    io::aligned_buffer_pool pool{data.size() + 3, 1};
+    auto buff = pool.acquire();
+    REQUIRE(pool.acquire() == nullptr);
+    REQUIRE(f.pread(buff, pool.buffer_size(), 0) == data.size() + 3);
+    REQUIRE(std::string_view((const char*)buff, data.size() + 3) == data + "xyz");
+
+    REQUIRE_THROWS_AS(f.pread(buff + 1, 4096, 0), errc_exception);
+    REQUIRE_THROWS_AS(f.pread(buff, 100, 0), errc_exception);
+    pool.release(buff);
+}
+
+TEST_CASE("direct_out_async") {
+    auto f = io::direct_file::open(".", sys::openflag::temp | sys::openflag::read_write);
+
+    std::string data(5 * 65536 + 1234, ' ');
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = char('a' + i * 7 % 26);
+
+    /* More buffers than the pool has, so the oldest writes are completed to free them */
+    auto size = run_async([&]() -> task<u64> {
+        io::direct_out<65536, 3> o{f};
+        co_await o.write_async(std::string_view(data).substr(0, 1000));
+        co_await o.write_async(std::string_view(data).substr(1000));
+        co_await o.flush_async();
+        auto flushed = f.size();
+        co_await o.write_async("xyz"sv);
+        co_await o.flush_async();
+        co_return flushed;
+    });
+    REQUIRE(size == data.size());
+    REQUIRE(f.size() == data.size() + 3);
+
+    io::aligned_buffer_pool pool{data.size() + 3, 1};
+    auto                    buff = pool.acquire();
+    REQUIRE(f.pread(buff, pool.buffer_size(), 0) == data.size() + 3);
+    REQUIRE(std::string_view((const char*)buff, data.size() + 3) == data + "xyz");
+    pool.release(buff);
+}
+
+TEST_CASE("out_behind") {
+    std::string data(5 * 4096 + 100, ' ');
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = char('a' + i * 7 % 26);
+
+    auto read_all = [](io::fd_t fd) {
+        std::string s(100000, ' ');
+        size_t      size = 0;
+        while (auto n = sys::read(fd, s.data() + size, s.size() - size).get())
+            size += n;
+        s.resize(size);
+        return s;
+    };
+
+    /* More buffers than N are submitted, so the producer waits for the oldest writes */
+    SECTION("file") {
+        auto f = io::file::memfd("test");
+        run_async([&]() -> task<> {
+            io::out_behind<io::fd_t, 4096, 3> o{f.fd()};
+            co_await o.write_async(std::string_view(data).substr(0, 10));
+            co_await o.write_async(std::string_view(data).substr(10), "end");
+            co_await o.flush_async();
+        });
+        REQUIRE(size_t(sys::lseek(f, 0, sys::seek_whence::cur).get()) == data.size() + 3);
+        sys::lseek(f, 0, sys::seek_whence::set).throw_if_error();
+        REQUIRE(read_all(f) == data + "end");
+    }
+
+    SECTION("pipe") {
+        auto p = io::file::pipe();
+        run_async([&]() -> task<> {
+            io::out_behind<io::fd_t, 4096, 3> o{p.out.fd()};
+            co_await o.write_async(data);
+            co_await o.flush_async();
+        });
+        p.out = {};
+        REQUIRE(read_all(p.in) == data);
+    }
+
+    SECTION("dtor_writes_unsubmitted") {
+        auto f = io::file::memfd("test");
+        run_async([&]() -> task<> {
+            io::out_behind<io::fd_t, 4096, 3> o{f.fd()};
+            co_await o.write_async("tail");
+        });
+        sys::lseek(f, 0, sys::seek_whence::set).throw_if_error();
+        REQUIRE(read_all(f) == "tail");
+    }
+
+    SECTION("write_error") {
+        auto f      = io::file::open("/dev/full", sys::openflag::write_only);
+        int  errors = 0;
+        auto left   = run_async([&]() -> task<size_t> {
+            io::out_behind<io::fd_t, 4096, 3> o{f.fd()};
+            try {
+                co_await o.write_async(data);
+            }
+            catch (const errc_exception&) {
+                ++errors;
+            }
+
+            /* Completes the remaining writes and drops the rest, so the writer can be destroyed */
+            try {
+                co_await o.flush_async();
+            }
+            catch (const errc_exception&) {
+                ++errors;
+            }
+            co_return o.inflight_size() + o.buffer_size();
+        });
+        REQUIRE(errors == 2);
+        REQUIRE(left == 0);
+    }
+}
+
+TEST_CASE("in_ahead") {
+    constexpr size_t bs = 4096;
+    using reader        = io::in_ahead<io::fd_t, bs, 4>;
+
+    std::string data(10 * bs, ' ');
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = char('a' + i * 7 % 26);
+
+    auto read_rest = [](reader& in) -> task<std::string> {
+        std::string res;
+        while (true) {
+            auto view = co_await in.read_view_async();
+            if (view.empty())
+                co_return res;
+            res.append((const char*)view.data(), view.size());
+        }
+    };
+
+    SECTION("file") {
+        auto f    = memfd_with(data);
+        auto read = run_async([&]() -> task<std::string> {
+            reader in{f.fd()};
+            auto   res = co_await read_rest(in);
+            co_await in.drain_async();
+            co_return res;
+        });
+        REQUIRE(read == data);
+    }
+
+    SECTION("short_read_mid_window") {
+        /* The read of the third buffer is short, the file is appended after it completed */
+        auto f    = memfd_with(std::string_view(data).substr(0, 2 * bs + bs / 2));
+        auto read = run_async([&]() -> task<std::string> {
+            reader      in{f.fd()};
+            std::string res;
+            for (int i = 0; i < 2; ++i) {
+                auto view = co_await in.read_view_async(bs);
+                res.append((const char*)view.data(), view.size());
+            }
+            sys::pwrite(f, data.data() + res.size() + bs / 2, data.size() - res.size() - bs / 2, off_t(res.size() + bs / 2)).throw_if_error();
+            res += co_await read_rest(in);
+            co_await in.drain_async();
+            co_return res;
+        });
+        REQUIRE(read == data);
+    }
+
+    SECTION("eof_with_queued_reads") {
+        /* The window is larger than the rest of the file, the reads behind the end are dropped */
+        auto f   = memfd_with(std::string_view(data).substr(0, 6 * bs));
+        auto res = run_async([&]() -> task<bool> {
+            reader in{f.fd()};
+            auto   read = co_await read_rest(in);
+            auto   ok   = read == data.substr(0, 6 * bs) && in.window() > 1;
+            ok          = ok && (co_await in.read_view_async()).empty();
+            co_await in.drain_async();
+            co_return ok;
+        });
+        REQUIRE(res);
+    }
+
+    SECTION("seek_after_start") {
+        auto f    = memfd_with(data);
+        auto read = run_async([&]() -> task<std::string> {
+            reader in{f.fd()};
+            co_await in.read_view_async(100);
+            co_await in.read_view_async(bs);
+            co_await in.seek_async(off_t(3 * bs + 5));
+
+            std::string res(bs, ' ');
+            res.resize(co_await in.read_async(res));
+            co_await in.seek_async(1);
+            res += co_await read_rest(in);
+            co_await in.drain_async();
+            co_return res;
+        });
+        REQUIRE(read == data.substr(3 * bs + 5, bs) + data.substr(1));
+    }
+
+    SECTION("pipe") {
+        /* Pipes have a window of one read, short reads are not treated as the end of input */
+        auto p = io::file::pipe();
+        sys::write(p.out, data.data(), 3 * bs + 10).throw_if_error();
+        p.out = {};
+
+        bool seek_failed = false;
+        auto read        = run_async([&]() -> task<std::string> {
+            reader in{p.in.fd()};
+            auto   res = co_await read_rest(in);
+            try {
+                co_await in.seek_async(0);
+            }
+            catch (const errc_exception& e) {
+                seek_failed = e.error() == errc::espipe;
+            }
+            co_return res;
+        });
+        REQUIRE(seek_failed);
+        REQUIRE(read == data.substr(0, 3 * bs + 10));
+    }
+
+    SECTION("pipe_read_error") {
+        /* The write end of a pipe is not readable, the error is not taken for the end of input */
+        auto p     = io::file::pipe();
+        auto error = run_async([&]() -> task<errc> {
+            reader in{p.out.fd()};
+            try {
+                co_await in.read_view_async();
+            }
+            catch (const errc_exception& e) {
+                co_return e.error();
+            }
+            co_return errc{};
+        });
+        REQUIRE(error == errc::ebadf);
+    }
 }
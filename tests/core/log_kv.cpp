@@ -0,0 +1,127 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <core/small_string.hpp>
+#include <util/log/binlog.hpp>
+#include <util/log/log_kv.hpp>
+#include <util/log/logger.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace core::ct_str_literals;
+
+namespace {
+std::string encode(util::log_kv_format format, std::string_view msg, const auto&... kvs) {
+    std::string result;
+    util::log_kv_to(result, format, msg, kvs...);
+    return result;
+}
+
+struct capture_handler : util::log_handler_base {
+    capture_handler(std::vector<std::string>& output): out(output) {}
+
+    void write_handler(util::log_level, write_type, std::string_view, std::string_view msg, util::u64) override {
+        out.emplace_back(msg);
+    }
+
+    std::vector<std::string>& out;
+};
+} // namespace
+
+TEST_CASE("log_kv") {
+    using enum util::log_kv_format;
+
+    SECTION("logfmt") {
+        CHECK(encode(logfmt, "closed") == "msg=closed");
+        CHECK(encode(logfmt, "connection closed", "fd"_ctstr, 17, "latency_us"_ctstr, 250u, "ok"_ctstr, true) ==
+              "msg=\"connection closed\" fd=17 latency_us=250 ok=true");
+        CHECK(encode(logfmt, "m", "path"_ctstr, std::string("/tmp/a b"), "empty"_ctstr, "", "c"_ctstr, 'x') == "msg=m path=\"/tmp/a b\" empty=\"\" c=x");
+        CHECK(encode(logfmt, "m", "q"_ctstr, "say \"hi\"\n", "ratio"_ctstr, 0.5) == "msg=m q=\"say \\\"hi\\\"\\n\" ratio=0.5");
+        CHECK(encode(logfmt, "m", "v"_ctstr, std::vector{1, 2}) == "msg=m v=\"{1, 2}\"");
+    }
+
+    SECTION("json") {
+        CHECK(encode(json, "closed") == "{\"msg\":\"closed\"}");
+        CHECK(encode(json, "connection closed", "fd"_ctstr, 17, "ok"_ctstr, false, "name"_ctstr, "a\tb\x01") ==
+              "{\"msg\":\"connection closed\",\"fd\":17,\"ok\":false,\"name\":\"a\\tb\\u0001\"}");
+        CHECK(encode(json, "m", "nan"_ctstr, std::numeric_limits<double>::quiet_NaN(), "x"_ctstr, -1.25) == "{\"msg\":\"m\",\"nan\":null,\"x\":-1.25}");
+    }
+
+    SECTION("appends") {
+        core::small_string<15> buf{"> "};
+        util::log_kv_to(buf, logfmt, "long message to spill", "n"_ctstr, 1);
+        CHECK(std::string_view(buf) == "> msg=\"long message to spill\" n=1");
+    }
+}
+
+TEST_CASE("log_kv logger") {
+    std::vector<std::string> out;
+    util::logger             log{false};
+    log.add_handler("capture", core::box<util::log_handler_base>(core::boxed<capture_handler>(out)));
+    out.clear();
+
+    SECTION("async") {
+        log.start_async();
+        log.info_kv("closed", "fd"_ctstr, 17);
+        log.stop_async();
+        REQUIRE(out.size() == 1);
+        CHECK(out[0] == "msg=closed fd=17");
+    }
+
+    SECTION("binlog") {
+        /* Binary log takes precedence over async mode as in log() */
+        auto path = (std::filesystem::temp_directory_path() / "tbc_log_kv_test.binlog").string();
+        log.set_binlog(core::boxed<util::binlog>(path, 4096 + 64 * 32, 4096 - 64));
+        log.start_async();
+        log.info_kv("closed", "fd"_ctstr, 17);
+        log.stop_async();
+        log.set_binlog({});
+        CHECK(out.empty());
+
+        std::ifstream     file{path, std::ios::binary};
+        std::vector<char> memory{std::istreambuf_iterator<char>{file}, {}};
+        std::filesystem::remove(path);
+
+        auto records = util::binlog_reader({memory.data(), memory.size()}).records();
+        REQUIRE(records.size() == 1);
+        CHECK(records[0].level == util::log_level::info);
+        CHECK(records[0].msg == "msg=closed fd=17");
+    }
+
+    log.take_handler("capture");
+}
+
+TEST_CASE("log_kv benchmark", "[.benchmark]") {
+    std::string        peer = "10.0.0.1:4242";
+    std::string        buf;
+    core::small_string<255> sbuf;
+
+    BENCHMARK("util::format text") {
+        buf.clear();
+        util::format_to(buf, "connection closed fd={} peer={} latency_us={} ratio={}"_ctstr, 17, peer, 250u, 0.75);
+        return buf.size();
+    };
+
+    BENCHMARK("log_kv_to logfmt") {
+        buf.clear();
+        util::log_kv_to(buf, util::log_kv_format::logfmt, "connection closed", "fd"_ctstr, 17, "peer"_ctstr, peer, "latency_us"_ctstr, 250u, "ratio"_ctstr, 0.75);
+        return buf.size();
+    };
+
+    BENCHMARK("log_kv_to json") {
+        buf.clear();
+        util::log_kv_to(buf, util::log_kv_format::json, "connection closed", "fd"_ctstr, 17, "peer"_ctstr, peer, "latency_us"_ctstr, 250u, "ratio"_ctstr, 0.75);
+        return buf.size();
+    };
+
+    BENCHMARK("log_kv_to json small_string") {
+        sbuf.clear();
+        util::log_kv_to(sbuf, util::log_kv_format::json, "connection closed", "fd"_ctstr, 17, "peer"_ctstr, peer, "latency_us"_ctstr, 250u, "ratio"_ctstr, 0.75);
+        return sbuf.size();
+    };
+}
@@ -0,0 +1,88 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <util/log/logger.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace core::ct_str_literals;
+
+namespace {
+struct capture_handler : util::log_handler_base {
+    capture_handler(std::vector<std::string>& output): out(output) {}
+
+    void write_handler(util::log_level, write_type, std::string_view, std::string_view msg, util::u64) override {
+        out.emplace_back(msg);
+    }
+
+    std::vector<std::string>& out;
+};
+
+struct counted {
+    int& formatted;
+};
+} // namespace
+
+template <>
+struct util::ct_formatter<counted> {
+    static util::size_t max_size(const counted&, ct_fmt_spec) {
+        return 1;
+    }
+
+    static char* write(char* out, const counted& v, ct_fmt_spec) {
+        ++v.formatted;
+        *out = 'c';
+        return out + 1;
+    }
+};
+
+TEST_CASE("log_limit") {
+    SECTION("limiter") {
+        util::log_limiter per_second{{.per_second = 3}};
+        int               allowed = 0;
+        for (int i = 0; i < 10; ++i)
+            allowed += per_second.allow();
+        CHECK(allowed == 3);
+        CHECK(per_second.take_suppressed() == 7);
+        CHECK(per_second.take_suppressed() == 0);
+
+        util::log_limiter sampled{{.sample_every = 4}};
+        allowed = 0;
+        for (int i = 0; i < 10; ++i)
+            allowed += sampled.allow();
+        CHECK(allowed == 3);
+        CHECK(sampled.take_suppressed() == 7);
+    }
+
+    SECTION("logger") {
+        std::vector<std::string> out;
+        int                      formatted = 0;
+        {
+            util::logger log{false};
+            log.add_handler("capture", core::box<util::log_handler_base>(core::boxed<capture_handler>(out)));
+            out.clear();
+
+            for (int i = 0; i < 100; ++i)
+                TBC_LOG_LIMITED(log, warn, 0, 10, "storm {}"_ctstr, counted{formatted});
+
+            CHECK(formatted == 10);
+            REQUIRE(out.size() == 19);
+            CHECK(out[0] == "storm c");
+            CHECK(out[2].ends_with(": 9 records suppressed *******"));
+
+            /* Tail of the storm is reported by flush_limits() */
+            log.flush_limits();
+            REQUIRE(out.size() == 20);
+            CHECK(out[19].ends_with(": 9 records suppressed *******"));
+
+            out.clear();
+            util::log_limiter quiet{{.per_second = 1}};
+            log.log_limited(quiet, util::log_level::warn, "quiet"_ctstr);
+            log.log_limited(quiet, util::log_level::warn, "quiet"_ctstr);
+            log.flush_limits();
+            REQUIRE(out.size() == 2);
+            CHECK(out[1].ends_with(": 1 records suppressed *******"));
+            log.take_handler("capture");
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <util/log/log_handler_ring.hpp>
+
+#include <string>
+
+TEST_CASE("log_handler_ring") {
+    auto msg_for = [](util::u64 i) {
+        return std::string(i % 300, char('a' + i % 26)) + std::to_string(i);
+    };
+
+    SECTION("write and read") {
+        util::log_handler_ring ring{4096};
+        ring.write(util::log_level::info, "[00:00:00.000]", "first", 1);
+        ring.write(util::log_level::warn, "[00:00:00.001]", "first", 1);
+        ring.write_update(3, util::log_level::info, "[00:00:00.002]", "progress");
+
+        auto records = ring.records(0);
+        REQUIRE(records.size() == 3);
+        CHECK(records[0].seq == 0);
+        CHECK(records[0].time == "[00:00:00.000]");
+        CHECK(records[0].msg == "first");
+        CHECK(records[1].wt == util::log_handler_base::write_type::write_same);
+        CHECK(records[1].times == 2);
+        CHECK(records[1].lvl == util::log_level::warn);
+        CHECK(records[2].msg == "progress");
+
+        CHECK(ring.records(2).size() == 1);
+        CHECK(ring.records(0, 2).size() == 2);
+    }
+
+    SECTION("overwrite") {
+        util::log_handler_ring ring{4096};
+        for (util::u64 i = 0; i < 1000; ++i)
+            ring.write(util::log_level::info, "[t]", msg_for(i), i);
+
+        CHECK(ring.next_seq() == 1000);
+        CHECK(ring.first_seq() > 900);
+        CHECK(ring.size() == ring.next_seq() - ring.first_seq());
+
+        util::u64 expected = ring.first_seq();
+        auto      result   = ring.read(10, [&](const util::log_ring_view& v) {
+            CHECK(v.seq == expected);
+            CHECK(v.msg == msg_for(expected));
+            ++expected;
+        });
+        CHECK_FALSE(result.torn);
+        CHECK(result.next == 1000);
+        CHECK(result.lost == ring.first_seq() - 10);
+
+        ring.clear();
+        CHECK(ring.size() == 0);
+        CHECK(ring.records(0).empty());
+        ring.write(util::log_level::info, "[t]", "after clear", 0);
+        CHECK(ring.records(0).front().seq == 1000);
+    }
+}
@@ -0,0 +1,155 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <core/io/file.hpp>
+#include <core/io/in.hpp>
+#include <core/io/lz4.hpp>
+#include <core/io/out.hpp>
+#include <core/lz4.hpp>
+#include <sys/lseek.hpp>
+
+using namespace core;
+
+namespace {
+std::vector<char> sample_data(size_t size) {
+    std::mt19937      rng{1337};
+    std::vector<char> data(size);
+    for (size_t i = 0; i < size; ++i)
+        data[i] = i % 7 == 0 ? char(rng() % 4) : char('a' + (i / 64) % 26);
+    return data;
+}
+
+/* lz4 -BD -B4 -9 of linked_data(): two linked blocks, the second one starts with a match into the first one */
+constexpr unsigned char linked_frame[] = {
+    0x04, 0x22, 0x4d, 0x18, 0x44, 0x40, 0x5e, 0x4b, 0x01, 0x00, 0x00, 0xff, 0x31, 0xc6, 0x7e, 0x81,
+    0x6b, 0x4b, 0xfb, 0xe2, 0xfb, 0x54, 0xf6, 0xbd, 0xdf, 0x7c, 0x1c, 0xe1, 0x87, 0x01, 0xbf, 0x31,
+    0xde, 0x56, 0x72, 0x0f, 0x47, 0x67, 0x66, 0x87, 0x59, 0xaa, 0x88, 0x3c, 0x59, 0xea, 0x56, 0x13,
+    0x7b, 0xd2, 0x85, 0xa1, 0xd8, 0x3c, 0x54, 0x55, 0x2f, 0x37, 0xae, 0x65, 0x5b, 0xda, 0x02, 0x79,
+    0x98, 0xcc, 0xe3, 0x1a, 0x76, 0x8e, 0x5f, 0xd9, 0x99, 0x8f, 0x1f, 0x3f, 0x36, 0x40, 0x00, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xa8,
+    0x50, 0x99, 0x8f, 0x1f, 0x3f, 0x36, 0x1c, 0x00, 0x00, 0x00, 0x0f, 0x40, 0x00, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfa,
+    0x50, 0x99, 0x8f, 0x1f, 0x3f, 0x36, 0x00, 0x00, 0x00, 0x00, 0xbd, 0x25, 0x43, 0x4c,
+};
+
+/* 64 pseudo-random bytes repeated 1100 times */
+std::vector<char> linked_data() {
+    char pattern[64];
+    u32  x = 1;
+    for (auto& c : pattern) {
+        x = (x * 1103515245 + 12345) & 0x7FFFFFFF;
+        c = char(x >> 16);
+    }
+
+    std::vector<char> data;
+    for (int i = 0; i < 1100; ++i)
+        data.insert(data.end(), pattern, pattern + sizeof(pattern));
+    return data;
+}
+} // namespace
+
+TEST_CASE("lz4") {
+    SECTION("block") {
+        for (auto size : {size_t(0), size_t(1), size_t(13), size_t(4096), size_t(100000)}) {
+            auto              data = sample_data(size);
+            std::vector<char> compressed(lz4::compress_bound(size));
+            auto              csize = lz4::compress_block(data.data(), size, compressed.data(), compressed.size());
+            REQUIRE((csize != 0 || size == 0));
+            if (size > 4096)
+                REQUIRE(csize < size / 2);
+
+            std::vector<char> decompressed(size + 1);
+            auto              res = lz4::decompress_block(compressed.data(), csize, decompressed.data(), decompressed.size());
+            REQUIRE(res);
+            REQUIRE(*res == size);
+            decompressed.resize(size);
+            REQUIRE(decompressed == data);
+        }
+    }
+
+    SECTION("block_malformed") {
+        auto              data = sample_data(4096);
+        std::vector<char> compressed(lz4::compress_bound(data.size()));
+        auto              csize = lz4::compress_block(data.data(), data.size(), compressed.data(), compressed.size());
+
+        std::vector<char> out(data.size());
+        REQUIRE(!lz4::decompress_block(compressed.data(), csize, out.data(), out.size() - 1));
+        REQUIRE(!lz4::decompress_block(compressed.data(), csize - 3, out.data(), out.size()));
+    }
+
+    SECTION("frame") {
+        auto data       = sample_data(300000);
+        auto compressed = lz4::compress_frame(data, 65536);
+        REQUIRE(compressed.size() < data.size() / 2);
+
+        auto decompressed = lz4::decompress_frame(compressed);
+        REQUIRE(decompressed);
+        REQUIRE(*decompressed == data);
+
+        compressed[5] ^= 1;
+        REQUIRE(!lz4::decompress_frame(compressed));
+
+        /* Reserved FLG bit */
+        compressed    = lz4::compress_frame(data, 65536);
+        compressed[4] |= 0x02;
+        REQUIRE(!lz4::decompress_frame(compressed));
+    }
+
+    SECTION("linked_blocks") {
+        auto data         = linked_data();
+        auto decompressed = lz4::decompress_frame(std::span{linked_frame});
+        REQUIRE(decompressed);
+        REQUIRE(*decompressed == data);
+
+        auto f = io::file::memfd("lz4");
+        io::out{f}.write(std::span{linked_frame});
+        sys::lseek(f.fd(), 0, sys::seek_whence::set).throw_if_error();
+
+        /* Small reads, so the history is moved while the second block is only partially consumed */
+        io::in            in{io::lz4_frame{f}, size_c<1000>};
+        std::vector<char> result(data.size());
+        REQUIRE(in.read(std::span{result}) == data.size());
+        REQUIRE(result == data);
+
+        char c;
+        REQUIRE(in.read(std::span{&c, 1}) == 0);
+    }
+
+    SECTION("stream") {
+        auto data = sample_data(200000);
+        auto f    = io::file::memfd("lz4");
+        {
+            io::out out{io::lz4_frame{f}, size_c<65536>};
+            out.write(std::span{data}.subspan(0, 1000));
+            out.write(std::span{data}.subspan(1000));
+        }
+        REQUIRE(sys::lseek(f.fd(), 0, sys::seek_whence::cur).get() < off_t(data.size() / 2));
+        sys::lseek(f.fd(), 0, sys::seek_whence::set).throw_if_error();
+
+        io::in            in{io::lz4_frame{f}};
+        std::vector<char> result(data.size());
+        REQUIRE(in.read(std::span{result}) == data.size());
+        REQUIRE(result == data);
+
+        char c;
+        REQUIRE(in.read(std::span{&c, 1}) == 0);
+    }
+}
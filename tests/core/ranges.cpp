@@ -1,6 +1,8 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include <list>
+#include <string>
+#include <vector>
 
 #include <core/ranges/zip.hpp>
 
@@ -59,3 +61,57 @@ TEST_CASE("subst") {
     CHECK(sbst("asd${", subst_entry{"asd", "lol"}) == "asd");
     CHECK(sbst("asd$34", subst_entry{"asd", "lol"}) == "asd$34");
 }
+
+#include <core/find_delim.hpp>
+#include <core/ranges/split.hpp>
+
+namespace {
+template <size_t N>
+const char* find_delim_naive(const char* b, const char* e, const core::array<char, N>& delims) {
+    for (; b != e; ++b)
+        for (auto c : delims)
+            if (*b == c)
+                return b;
+    return e;
+}
+
+std::vector<std::string> split_to_vector(auto&& container, auto&& split) {
+    std::vector<std::string> res;
+    for (auto&& r : container | split)
+        res.emplace_back(r.begin(), r.end());
+    return res;
+}
+} // namespace
+
+TEST_CASE("find_delim") {
+    SECTION("matches naive search") {
+        std::string s;
+        for (size_t i = 0; i < 300; ++i)
+            s += i % 37 == 0 ? ',' : i % 53 == 0 ? '\n' : char('a' + i % 26);
+
+        core::array<char, 1> d1{','};
+        core::array<char, 3> d3{',', ';', '\n'};
+        core::array<char, 20> d20{'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '!', '@', '#', '$', '%', '^', '&', '*', '\n', ','};
+        for (size_t off = 0; off <= s.size(); ++off) {
+            auto b = s.data() + off;
+            auto e = s.data() + s.size();
+            REQUIRE(core::find_delim(b, e, d1) == find_delim_naive(b, e, d1));
+            REQUIRE(core::find_delim(b, e, d3) == find_delim_naive(b, e, d3));
+            REQUIRE(core::find_delim(b, e, d20) == find_delim_naive(b, e, d20));
+        }
+        REQUIRE(core::find_delim(s.data(), s.data(), ',') == s.data());
+    }
+
+    SECTION("split contiguous and non-contiguous") {
+        std::string s = ",a,,bcd;e;;" + std::string(100, 'x') + ";z";
+        std::list<char> l(s.begin(), s.end());
+        auto x = std::string(100, 'x');
+
+        REQUIRE(split_to_vector(s, core::views::split(',', ';')) == std::vector<std::string>{"a", "bcd", "e", x, "z"});
+        REQUIRE(split_to_vector(l, core::views::split(',', ';')) == std::vector<std::string>{"a", "bcd", "e", x, "z"});
+        REQUIRE(split_to_vector(s, core::views::split(core::views::split_mode::allow_empty, ',', ';')) ==
+                std::vector<std::string>{"", "a", "", "bcd", "e", "", x, "z"});
+        REQUIRE(split_to_vector(l, core::views::split(core::views::split_mode::allow_empty, ',', ';')) ==
+                std::vector<std::string>{"", "a", "", "bcd", "e", "", x, "z"});
+    }
+}
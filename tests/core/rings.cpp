@@ -0,0 +1,92 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <core/mpmc_ring.hpp>
+#include <core/spsc_ring.hpp>
+
+using namespace core;
+
+TEST_CASE("spsc_ring") {
+    SECTION("single thread") {
+        spsc_ring<std::string> r{3};
+        CHECK(r.capacity() == 4);
+        for (int i = 0; i < 5; ++i)
+            r.try_push(std::to_string(i));
+        CHECK(r.size() == 4);
+        CHECK(r.full());
+
+        std::string s;
+        CHECK(r.try_pop(s));
+        CHECK(s == "0");
+
+        std::string out[8];
+        CHECK(r.try_pop(out, 8) == 3);
+        CHECK(out[2] == "3");
+        CHECK(r.empty());
+
+        const std::string in[] = {"a", "b", "c", "d", "e"};
+        CHECK(r.try_push(in, 5) == 4);
+    }
+
+    SECTION("threads") {
+        static constexpr u64 count = 100000;
+
+        spsc_ring<u64, true> r{64};
+        std::thread          producer([&] {
+            for (u64 i = 0; i < count; ++i)
+                r.push(i);
+        });
+
+        bool ordered = true;
+        u64  buff[16];
+        for (u64 expected = 0; expected < count;) {
+            auto n = r.pop(buff, 16);
+            for (size_t i = 0; i < n; ++i)
+                ordered = ordered && buff[i] == expected++;
+        }
+        producer.join();
+        CHECK(ordered);
+    }
+}
+
+TEST_CASE("mpmc_ring") {
+    SECTION("single thread") {
+        mpmc_ring<std::string> r{4};
+        for (int i = 0; i < 5; ++i)
+            r.try_push(std::to_string(i));
+        CHECK(r.size() == 4);
+
+        std::string s;
+        CHECK(r.try_pop(s));
+        CHECK(s == "0");
+        CHECK(r.size() == 3);
+    }
+
+    SECTION("threads") {
+        static constexpr u64 count = 50000;
+
+        mpmc_ring<u64, true>     r{64};
+        std::atomic<u64>         sum = 0;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 2; ++t)
+            threads.emplace_back([&] {
+                for (u64 i = 1; i <= count; ++i)
+                    r.push(i);
+            });
+        for (int t = 0; t < 2; ++t)
+            threads.emplace_back([&] {
+                u64 s = 0;
+                for (u64 i = 0; i < count; ++i)
+                    s += r.pop();
+                sum += s;
+            });
+        for (auto& t : threads)
+            t.join();
+
+        CHECK(sum == count * (count + 1));
+        CHECK(r.empty());
+    }
+}
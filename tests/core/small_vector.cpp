@@ -0,0 +1,121 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+#include <core/small_string.hpp>
+#include <core/small_vector.hpp>
+
+using namespace core;
+
+TEST_CASE("small_vector") {
+    SECTION("inline") {
+        small_vector<int, 4> v{1, 2, 3};
+        CHECK(v.is_inline());
+        CHECK(v.size() == 3);
+        v.push_back(4);
+        CHECK(v.is_inline());
+        CHECK(v.back() == 4);
+    }
+
+    SECTION("spill") {
+        small_vector<int, 2> v;
+        for (int i = 0; i < 10; ++i)
+            v.push_back(i);
+        CHECK_FALSE(v.is_inline());
+        CHECK(v.size() == 10);
+        for (int i = 0; i < 10; ++i)
+            CHECK(v[size_t(i)] == i);
+    }
+
+    SECTION("non-trivial") {
+        small_vector<std::string, 2> v;
+        v.emplace_back("first string which does not fit into sso buffer");
+        v.emplace_back("second");
+        v.emplace_back("third");
+        CHECK_FALSE(v.is_inline());
+        CHECK(v[0] == "first string which does not fit into sso buffer");
+
+        auto v2 = v;
+        CHECK(v2 == v);
+
+        auto v3 = mov(v);
+        CHECK(v3 == v2);
+        CHECK(v.empty());
+
+        v3.erase(v3.begin());
+        CHECK(v3.size() == 2);
+        CHECK(v3.front() == "second");
+
+        small_vector<std::string, 2> v4{"a"};
+        auto                         v5 = mov(v4);
+        CHECK(v5.is_inline());
+        CHECK(v5[0] == "a");
+        CHECK(v4.empty());
+    }
+
+    SECTION("self-aliasing") {
+        small_vector<std::string, 2> v{"first string which does not fit into sso buffer", "second"};
+        v.push_back(v[0]);
+        v.emplace_back(v.back());
+        CHECK(v.size() == 4);
+        CHECK(v[2] == "first string which does not fit into sso buffer");
+        CHECK(v[3] == v[2]);
+
+        small_vector<int, 2> v2{1, 2};
+        v2.append(v2.data(), v2.size());
+        v2.append(v2.data(), v2.size());
+        CHECK(v2 == small_vector<int, 2>{1, 2, 1, 2, 1, 2, 1, 2});
+
+        small_vector<std::string, 2> v3{"a string which does not fit into sso buffer", "b"};
+        v3.append(v3.data(), v3.size());
+        CHECK(v3.size() == 4);
+        CHECK(v3[2] == "a string which does not fit into sso buffer");
+        CHECK(v3[3] == "b");
+    }
+
+    SECTION("resize") {
+        small_vector<int, 4> v;
+        v.resize(8);
+        CHECK(v.size() == 8);
+        CHECK(v[7] == 0);
+        v.resize(1);
+        CHECK(v.size() == 1);
+    }
+}
+
+TEST_CASE("small_string") {
+    small_string<8> s = "test";
+    CHECK(s.is_inline());
+    CHECK(s == "test");
+    CHECK(s.c_str()[4] == '\0');
+
+    s += " string which spills to heap";
+    CHECK_FALSE(s.is_inline());
+    CHECK(s == "test string which spills to heap");
+
+    auto s2 = mov(s);
+    CHECK(s.empty());
+    CHECK(s.c_str()[0] == '\0');
+    CHECK(s2.size() == 32);
+
+    s2.resize(4);
+    CHECK(s2 == "test");
+    s2.push_back('!');
+    CHECK(std::string_view(s2) == "test!");
+
+    small_string<4> s3{std::string("from std::string")};
+    CHECK(s3 == "from std::string");
+
+    small_string<8> s4 = "abcdef";
+    s4.append(s4);
+    CHECK(s4 == "abcdefabcdef");
+    s4 += std::string_view(s4).substr(0, 3);
+    CHECK(s4 == "abcdefabcdefabc");
+    s4.assign(std::string_view(s4).substr(6, 6));
+    CHECK(s4 == "abcdef");
+
+    auto& self = s4;
+    s4         = mov(self);
+    CHECK(s4 == "abcdef");
+    CHECK(s4.size() == 6);
+}
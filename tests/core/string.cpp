@@ -1,8 +1,12 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include <vector>
+
+#include <core/parse_many.hpp>
 #include <core/string/path.hpp>
 
 using namespace core;
+using namespace std::string_view_literals;
 
 TEST_CASE("path") {
     CHECK(is_relative_to("/home/test", "/home/test/lol/mda"));
@@ -13,3 +17,26 @@ TEST_CASE("path") {
     CHECK(is_relative_to("/home/test", "/home/test"));
     CHECK_FALSE(is_relative_to("/home/test", "/home"));
 }
+
+TEST_CASE("parse_many") {
+    std::string_view ints = "1,-2,,  12345678901234567\n x,4,99999999999\n";
+    std::vector<i64> v;
+    auto             res = parse_many<i64>(ints, std::back_inserter(v));
+    CHECK(v == std::vector<i64>{1, -2, 12345678901234567, 4, 99999999999});
+    CHECK(res.count == 5);
+    REQUIRE(res.errors.size() == 1);
+    CHECK(res.errors[0].pos == 27);
+    CHECK(res.errors[0].ec == std::errc::invalid_argument);
+
+    std::vector<u8> bytes;
+    res = parse_many<u8>("255;256;-1"sv, std::back_inserter(bytes), array{';'});
+    CHECK(bytes == std::vector<u8>{255});
+    REQUIRE(res.errors.size() == 2);
+    CHECK(res.errors[0].ec == std::errc::result_out_of_range);
+    CHECK(res.errors[1].pos == 8);
+
+    std::vector<double> d;
+    res = parse_many<double>("0.5 1e3 -1.25e-2 3.14159 1e400 .5e"sv, std::back_inserter(d));
+    CHECK(d == std::vector<double>{0.5, 1e3, -1.25e-2, 3.14159});
+    CHECK(res.errors.size() == 2);
+}
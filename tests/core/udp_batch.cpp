@@ -0,0 +1,74 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <memory>
+#include <string_view>
+
+#include <net/udp_socket.hpp>
+
+using namespace core;
+using namespace std::string_view_literals;
+
+namespace {
+/* The sockets are bound to ephemeral ports, address() has port 0 */
+net::full_addr_any bound_address(const net::udp_socket& sock) {
+    sockaddr_storage addr;
+    socklen_t        len = sizeof(addr);
+    REQUIRE(::getsockname(sock.native(), reinterpret_cast<sockaddr*>(&addr), &len) == 0);
+    return {addr};
+}
+} // namespace
+
+TEST_CASE("udp_batch") {
+    auto            loopback = net::full_addr_v4{net::ip_addr_v4{"127.0.0.1"}, 0};
+    net::udp_socket sender{loopback, true};
+    net::udp_socket receiver{loopback, false};
+    auto            src = bound_address(sender);
+    auto            dst = bound_address(receiver);
+
+    SECTION("push_full") {
+        net::udp_batch<2> batch;
+        char              buff[4];
+        REQUIRE(batch.push(dst, "a"sv));
+        REQUIRE(batch.push(buff, sizeof(buff)));
+        REQUIRE(batch.full());
+        REQUIRE(!batch.push(dst, "b"sv));
+        REQUIRE(!batch.push(buff, sizeof(buff)));
+        REQUIRE(batch.size() == 2);
+
+        batch.clear();
+        REQUIRE(batch.empty());
+        REQUIRE(batch.push(dst, "c"sv));
+    }
+
+    SECTION("send_recv") {
+        std::string_view  msgs[] = {"first", "second", "third"};
+        net::udp_batch<3> out;
+        for (auto msg : msgs)
+            REQUIRE(out.push(dst, msg));
+        REQUIRE(sender.send_batch(out) == 3);
+
+        char              buffs[4][16];
+        net::udp_batch<4> in;
+        for (auto& b : buffs)
+            REQUIRE(in.push(b, sizeof(b)));
+        REQUIRE(receiver.recv_batch(in) == 3);
+        for (size_t i = 0; i < 3; ++i) {
+            REQUIRE(in.received(i) == msgs[i].size());
+            REQUIRE(in.segment_size(i) == msgs[i].size());
+            REQUIRE(std::string_view(in.data(i).data(), in.data(i).size()) == msgs[i]);
+            REQUIRE(in.source(i).to_string() == src.to_string());
+        }
+
+        /* Nothing is left and the receiver is nonblocking */
+        REQUIRE(receiver.recv_batch(in) == -1);
+    }
+
+    SECTION("send_resume") {
+        /* sendmmsg sends at most UIO_MAXIOV (1024) messages per call, the rest is sent by the next calls */
+        constexpr size_t count = 1100;
+        auto             out   = std::make_unique<net::udp_batch<count>>();
+        while (!out->full())
+            out->push(dst, "x"sv);
+        REQUIRE(sender.send_batch(*out) == int(count));
+    }
+}
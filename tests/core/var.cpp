@@ -1,6 +1,11 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <core/var.hpp>
 
+#include <utility>
+#include <variant>
+#include <vector>
+
 using core::none;
 using core::none_t;
 using core::overloaded;
@@ -12,6 +17,25 @@ using core::var;
 using core::visit;
 using core::is_same;
 
+template <int N>
+struct many_alt {
+    int value;
+};
+
+template <typename Seq>
+struct many_alts;
+
+template <int... Ns>
+struct many_alts<std::integer_sequence<int, Ns...>> {
+    using core_var = var<many_alt<Ns>...>;
+    using std_var  = std::variant<many_alt<Ns>...>;
+};
+
+template <typename V, size_t S>
+V make_many_alt(size_t i) {
+    return core::idx_dispatch<S>(i, [](auto idx) { return V{many_alt<int(idx)>{int(idx)}}; });
+}
+
 struct nontriv_dtor {
     bool& called;
     nontriv_dtor(bool& icalled): called(icalled) {
@@ -275,6 +299,21 @@ TEST_CASE("var") {
         static_assert(r2);
     }
 
+    SECTION("visit_many") {
+        using v40 = many_alts<std::make_integer_sequence<int, 40>>::core_var;
+        using v90 = many_alts<std::make_integer_sequence<int, 90>>::core_var;
+
+        for (size_t i = 0; i < 40; ++i)
+            REQUIRE(visit(make_many_alt<v40, 40>(i), [](auto v) { return v.value; }) == int(i));
+        for (size_t i = 0; i < 90; ++i)
+            REQUIRE(visit(make_many_alt<v90, 90>(i), [](auto v) { return v.value; }) == int(i));
+
+        auto r = visit(make_many_alt<v40, 40>(17), var<u32, u64>{u64(3)}, make_many_alt<v90, 90>(81), [](auto a, auto b, auto c) {
+            return a.value * 10000 + int(b) * 100 + c.value + (is_same<decltype(b), u64> ? 1000000 : 0);
+        });
+        REQUIRE(r == 1000000 + 170000 + 300 + 81);
+    }
+
     SECTION("default_null_ctor") {
         static_assert(!core::default_ctor<var<int, float>>);
         static_assert(core::default_ctor<var<core::null_t, int, float>>);
@@ -285,3 +324,53 @@ TEST_CASE("var") {
         static_assert(core::ctor<var<int, float>, test_anycast>);
     }
 }
+
+TEST_CASE("var visit benchmark", "[.benchmark]") {
+    using seq  = std::make_integer_sequence<int, 24>;
+    using cvar = many_alts<seq>::core_var;
+    using svar = many_alts<seq>::std_var;
+
+    std::vector<cvar> cvars;
+    std::vector<svar> svars;
+    for (size_t i = 0; i < 4096; ++i) {
+        auto idx = (i * 7919) % 24;
+        cvars.push_back(make_many_alt<cvar, 24>(idx));
+        svars.push_back(make_many_alt<svar, 24>(idx));
+    }
+
+    auto handler = [](auto v) {
+        return v.value;
+    };
+
+    BENCHMARK("core::visit 24") {
+        int sum = 0;
+        for (auto& v : cvars)
+            sum += visit(v, handler);
+        return sum;
+    };
+
+    BENCHMARK("std::visit 24") {
+        int sum = 0;
+        for (auto& v : svars)
+            sum += std::visit(handler, v);
+        return sum;
+    };
+
+    auto handler2 = [](auto a, auto b) {
+        return a.value ^ b.value;
+    };
+
+    BENCHMARK("core::visit 24x24") {
+        int sum = 0;
+        for (size_t i = 1; i < cvars.size(); ++i)
+            sum += visit(cvars[i - 1], cvars[i], handler2);
+        return sum;
+    };
+
+    BENCHMARK("std::visit 24x24") {
+        int sum = 0;
+        for (size_t i = 1; i < svars.size(); ++i)
+            sum += std::visit(handler2, svars[i - 1], svars[i]);
+        return sum;
+    };
+}